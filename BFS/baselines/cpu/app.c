@@ -9,11 +9,140 @@
 #include <omp.h>
 
 #include "../../support/common.h"
-#include "../../support/graph.h"
+#include "graph.h"
 #include "../../support/params.h"
 #include "../../support/timer.h"
 #include "../../support/utils.h"
 
+// Nodes discovered by one thread in a top-down step, padded to a cache line to avoid false sharing
+struct ThreadFrontier {
+    uint32_t* nodes;
+    uint32_t size;
+    uint32_t capacity;
+    uint64_t edges;
+    uint32_t offset;
+    uint8_t padding[36];
+};
+
+static void appendNode(struct ThreadFrontier* local, uint32_t node) {
+    if(local->size == local->capacity) {
+        local->capacity *= 2;
+        local->nodes = (uint32_t*) realloc(local->nodes, local->capacity*sizeof(uint32_t));
+    }
+    local->nodes[local->size++] = node;
+}
+
+// Top-down step: claim the unvisited neighbors of the frontier list with a CAS on their level, each thread appending the
+// nodes it claims to its own buffer, then concatenate the buffers at offsets given by a prefix sum of their sizes.
+// Returns the size of the next frontier and the sum of its degrees in nextFrontierEdges.
+static uint32_t topDownStep(struct CSRGraph csrGraph, uint32_t* nodeLevel, uint32_t level, const uint32_t* frontier,
+        uint32_t frontierSize, uint32_t* nextFrontier, struct ThreadFrontier* locals, uint64_t* nextFrontierEdges) {
+    uint32_t nextFrontierSize = 0;
+    uint64_t edges = 0;
+    #pragma omp parallel
+    {
+        struct ThreadFrontier* local = &locals[omp_get_thread_num()];
+        local->size = 0;
+        local->edges = 0;
+        #pragma omp for schedule(dynamic, 64)
+        for(uint32_t i = 0; i < frontierSize; ++i) {
+            uint32_t node = frontier[i];
+            for(uint32_t edge = csrGraph.nodePtrs[node]; edge < csrGraph.nodePtrs[node + 1]; ++edge) {
+                uint32_t neighbor = csrGraph.neighborIdxs[edge];
+                if(nodeLevel[neighbor] == UINT32_MAX && __sync_bool_compare_and_swap(&nodeLevel[neighbor], UINT32_MAX, level)) {
+                    appendNode(local, neighbor);
+                    local->edges += csrGraph.nodePtrs[neighbor + 1] - csrGraph.nodePtrs[neighbor];
+                }
+            }
+        }
+        #pragma omp single
+        {
+            for(int t = 0; t < omp_get_num_threads(); ++t) {
+                locals[t].offset = nextFrontierSize;
+                nextFrontierSize += locals[t].size;
+                edges += locals[t].edges;
+            }
+        }
+        memcpy(nextFrontier + local->offset, local->nodes, local->size*sizeof(uint32_t));
+    }
+    *nextFrontierEdges = edges;
+    return nextFrontierSize;
+}
+
+// Bottom-up step: every unvisited node looks for a neighbor in the frontier bit vector and stops at the first one.
+// Threads own whole tiles of the next bit vector, so they write it without synchronization.
+static uint32_t bottomUpStep(struct CSRGraph csrGraph, uint32_t* nodeLevel, uint32_t level, const uint64_t* frontier,
+        uint64_t* nextFrontier, uint64_t* nextFrontierEdges) {
+    uint32_t nextFrontierSize = 0;
+    uint64_t edges = 0;
+    #pragma omp parallel for schedule(dynamic, 64) reduction(+:nextFrontierSize, edges)
+    for(uint32_t tileIdx = 0; tileIdx < csrGraph.numNodes/64; ++tileIdx) {
+        uint64_t nextFrontierTile = 0;
+        for(uint32_t node = tileIdx*64; node < (tileIdx + 1)*64; ++node) {
+            if(nodeLevel[node] == UINT32_MAX) {
+                for(uint32_t edge = csrGraph.nodePtrs[node]; edge < csrGraph.nodePtrs[node + 1]; ++edge) {
+                    uint32_t neighbor = csrGraph.neighborIdxs[edge];
+                    if(isSet(frontier[neighbor/64], neighbor%64)) {
+                        nodeLevel[node] = level;
+                        setBit(nextFrontierTile, node%64);
+                        ++nextFrontierSize;
+                        edges += csrGraph.nodePtrs[node + 1] - csrGraph.nodePtrs[node];
+                        break;
+                    }
+                }
+            }
+        }
+        nextFrontier[tileIdx] = nextFrontierTile;
+    }
+    *nextFrontierEdges = edges;
+    return nextFrontierSize;
+}
+
+static void listToBitmap(const uint32_t* list, uint32_t size, uint64_t* bitmap, uint32_t numNodes) {
+    #pragma omp parallel
+    {
+        #pragma omp for
+        for(uint32_t i = 0; i < numNodes/64; ++i) {
+            bitmap[i] = 0;
+        }
+        #pragma omp for
+        for(uint32_t i = 0; i < size; ++i) {
+            __atomic_fetch_or(&bitmap[list[i]/64], 1ULL << (list[i]%64), __ATOMIC_RELAXED);
+        }
+    }
+}
+
+// Each thread lists the nodes of its range of tiles at an offset given by a prefix sum of the ranges' node counts
+static void bitmapToList(const uint64_t* bitmap, uint32_t numNodes, uint32_t* list, struct ThreadFrontier* locals) {
+    uint32_t numTiles = numNodes/64;
+    #pragma omp parallel
+    {
+        int t = omp_get_thread_num(), numThreads = omp_get_num_threads();
+        uint32_t tilesStart = (uint32_t)((uint64_t)numTiles*t/numThreads);
+        uint32_t tilesEnd = (uint32_t)((uint64_t)numTiles*(t + 1)/numThreads);
+        uint32_t count = 0;
+        for(uint32_t i = tilesStart; i < tilesEnd; ++i) {
+            count += __builtin_popcountll(bitmap[i]);
+        }
+        locals[t].size = count;
+        #pragma omp barrier
+        #pragma omp single
+        {
+            uint32_t offset = 0;
+            for(int k = 0; k < numThreads; ++k) {
+                locals[k].offset = offset;
+                offset += locals[k].size;
+            }
+        }
+        uint32_t listIdx = locals[t].offset;
+        for(uint32_t i = tilesStart; i < tilesEnd; ++i) {
+            for(uint64_t tile = bitmap[i]; tile; tile &= tile - 1) {
+                list[listIdx++] = i*64 + __builtin_ctzll(tile);
+            }
+        }
+    }
+}
+
 int main(int argc, char** argv) {
 
     // Process parameters
@@ -24,6 +153,10 @@ int main(int argc, char** argv) {
     struct COOGraph cooGraph = readCOOGraph(p.fileName);
     PRINT_INFO(p.verbosity >= 1, "    Graph has %d nodes and %d edges", cooGraph.numNodes, cooGraph.numEdges);
     struct CSRGraph csrGraph = coo2csr(cooGraph);
+    if(p.directionOptimizing && !isSymmetric(csrGraph)) {
+        PRINT_WARNING("    Graph is not symmetric, so bottom-up levels would miss in-edges: traversing top-down only");
+        p.directionOptimizing = 0;
+    }
     uint32_t* nodeLevel = (uint32_t*) malloc(csrGraph.numNodes*sizeof(uint32_t));
     uint32_t* nodeLevelRef = (uint32_t*) malloc(csrGraph.numNodes*sizeof(uint32_t));
     for(uint32_t i = 0; i < csrGraph.numNodes; ++i) {
@@ -32,54 +165,68 @@ int main(int argc, char** argv) {
     }
     uint32_t srcNode = 0;
 
-    // Initialize frontier double buffers
+    // Initialize frontier double buffers, as lists for top-down levels and bit vectors for bottom-up levels
     uint32_t* buffer1 = (uint32_t*) malloc(csrGraph.numNodes*sizeof(uint32_t));
     uint32_t* buffer2 = (uint32_t*) malloc(csrGraph.numNodes*sizeof(uint32_t));
     uint32_t* prevFrontier = buffer1;
     uint32_t* currFrontier = buffer2;
+    uint64_t* prevFrontierBitmap = (uint64_t*) malloc(csrGraph.numNodes/64*sizeof(uint64_t));
+    uint64_t* currFrontierBitmap = (uint64_t*) malloc(csrGraph.numNodes/64*sizeof(uint64_t));
+    if(p.numThreads > 0) {
+        omp_set_num_threads(p.numThreads);
+    }
+    int numThreads = omp_get_max_threads();
+    struct ThreadFrontier* locals = (struct ThreadFrontier*) calloc(numThreads, sizeof(struct ThreadFrontier));
+    for(int t = 0; t < numThreads; ++t) {
+        locals[t].capacity = 1024;
+        locals[t].nodes = (uint32_t*) malloc(locals[t].capacity*sizeof(uint32_t));
+    }
 
     // Calculating result on CPU
-    PRINT_INFO(p.verbosity >= 1, "Calculating result on CPU (OpenMP)");
-    omp_set_num_threads(4);
+    // The direction of each level follows Beamer et al.'s heuristic: go bottom-up once the frontier's edges exceed
+    // 1/alpha of the edges of unvisited nodes, and back top-down once the frontier has fewer than 1/beta of the nodes.
+    // Frontiers below the beta threshold stay top-down, or the small tail levels, whose unexplored edges are few, would
+    // scan every unvisited node
+    PRINT_INFO(p.verbosity >= 1, "Calculating result on CPU (OpenMP, %d threads)", numThreads);
     Timer timer;
     startTimer(&timer);
     nodeLevel[srcNode] = 0;
     prevFrontier[0] = srcNode;
     uint32_t numPrevFrontier = 1;
+    uint64_t prevFrontierEdges = csrGraph.nodePtrs[srcNode + 1] - csrGraph.nodePtrs[srcNode];
+    uint64_t unexploredEdges = csrGraph.numEdges - prevFrontierEdges;
+    uint32_t bottomUp = 0;
     for(uint32_t level = 1; numPrevFrontier > 0; ++level) {
 
-        uint32_t numCurrFrontier = 0;
-
-        // Visit nodes in the previous frontier
-        #pragma omp parallel for
-        for(uint32_t i = 0; i < numPrevFrontier; ++i) {
-            uint32_t node = prevFrontier[i];
-            for(uint32_t edge = csrGraph.nodePtrs[node]; edge < csrGraph.nodePtrs[node + 1]; ++edge) {
-                uint32_t neighbor = csrGraph.neighborIdxs[edge];
-                uint32_t justVisited = 0;
-                #pragma omp critical
-                {
-                    if(nodeLevel[neighbor] == UINT32_MAX) { // Node not previously visited
-                        nodeLevel[neighbor] = level;
-                        justVisited = 1;
-                    }
-                }
-                if(justVisited) {
-                    uint32_t currFrontierIdx;
-                    #pragma omp critical
-                    {
-                        currFrontierIdx = numCurrFrontier++;
-                    }
-                    currFrontier[currFrontierIdx] = neighbor;
-                }
+        // Pick the direction of the level, converting the frontier when it changes
+        if(p.directionOptimizing) {
+            if(!bottomUp && prevFrontierEdges > unexploredEdges/p.alpha && numPrevFrontier >= csrGraph.numNodes/p.beta) {
+                bottomUp = 1;
+                listToBitmap(prevFrontier, numPrevFrontier, prevFrontierBitmap, csrGraph.numNodes);
+            } else if(bottomUp && numPrevFrontier < csrGraph.numNodes/p.beta) {
+                bottomUp = 0;
+                bitmapToList(prevFrontierBitmap, csrGraph.numNodes, prevFrontier, locals);
             }
         }
 
-        // Swap buffers
-        uint32_t* tmp = prevFrontier;
-        prevFrontier = currFrontier;
-        currFrontier = tmp;
+        // Visit nodes in the previous frontier
+        uint32_t numCurrFrontier;
+        uint64_t currFrontierEdges;
+        if(bottomUp) {
+            numCurrFrontier = bottomUpStep(csrGraph, nodeLevel, level, prevFrontierBitmap, currFrontierBitmap, &currFrontierEdges);
+            uint64_t* tmp = prevFrontierBitmap;
+            prevFrontierBitmap = currFrontierBitmap;
+            currFrontierBitmap = tmp;
+        } else {
+            numCurrFrontier = topDownStep(csrGraph, nodeLevel, level, prevFrontier, numPrevFrontier, currFrontier, locals, &currFrontierEdges);
+            uint32_t* tmp = prevFrontier;
+            prevFrontier = currFrontier;
+            currFrontier = tmp;
+        }
+        PRINT_INFO(p.verbosity >= 2, "    Level %u (%s): %u nodes", level, bottomUp?"bottom-up":"top-down", numCurrFrontier);
         numPrevFrontier = numCurrFrontier;
+        prevFrontierEdges = currFrontierEdges;
+        unexploredEdges -= currFrontierEdges;
 
     }
     stopTimer(&timer);
@@ -138,8 +285,15 @@ int main(int argc, char** argv) {
     freeCOOGraph(cooGraph);
     freeCSRGraph(csrGraph);
     free(nodeLevel);
+    free(nodeLevelRef);
     free(buffer1);
     free(buffer2);
+    free(prevFrontierBitmap);
+    free(currFrontierBitmap);
+    for(int t = 0; t < numThreads; ++t) {
+        free(locals[t].nodes);
+    }
+    free(locals);
 
     return 0;
 
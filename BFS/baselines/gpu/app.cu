@@ -7,7 +7,7 @@
 #include <stdint.h>
 
 #include "../../support/common.h"
-#include "../../support/graph.h"
+#include "graph.h"
 #include "../../support/params.h"
 #include "../../support/timer.h"
 #include "../../support/utils.h"
@@ -9,21 +9,202 @@
 #include <defs.h>
 #include <mram.h>
 #include <mutex.h>
+#include <mutex_pool.h>
 #include <perfcounter.h>
 
 #include "dpu-utils.h"
+#include "graph-access.h"
 #include "../support/common.h"
 
+// Number of entries appended to the next frontier list (or multi-source delta list), which are written while the list has room
+// (each node added to the next frontier is listed once, or twice when it pads a tasklet's buffer to an even size)
+__host uint32_t NEXT_FRONTIER_SIZE;
+
 BARRIER_INIT(my_barrier, NR_TASKLETS);
 
 BARRIER_INIT(bfsBarrier, NR_TASKLETS);
-MUTEX_INIT(nextFrontierMutex);
+MUTEX_POOL_INIT(nextFrontierMutexPool, NR_FRONTIER_LOCKS);
+MUTEX_INIT(nextFrontierListMutex);
+
+// Per-tasklet WRAM buffer of nodes waiting to be appended to the next frontier list
+struct FrontierListBuffer {
+    uint32_t* nodes_w;
+    uint32_t size;
+    uint32_t list_m;
+    uint32_t capacity;
+};
+
+// Read the tiles [tileIdx, min(tileIdx + FRONTIER_BLOCK_SIZE, tilesEnd)) of a bitmap in MRAM into block_w and return how many
+static uint32_t loadTileBlock(uint32_t bitmap_m, uint32_t tileIdx, uint32_t tilesEnd, uint64_t* block_w) {
+    uint32_t numTiles = (tileIdx + FRONTIER_BLOCK_SIZE > tilesEnd)?(tilesEnd - tileIdx):FRONTIER_BLOCK_SIZE;
+    mram_read((__mram_ptr void const*)(bitmap_m + tileIdx*sizeof(uint64_t)), block_w, numTiles*sizeof(uint64_t));
+    return numTiles;
+}
+
+// Index of the first entry of the sorted list [0, size) in MRAM that is not less than node
+static uint32_t lowerBound(uint32_t list_m, uint32_t size, uint32_t node, uint64_t* cache_w) {
+    uint32_t lo = 0, hi = size;
+    while(lo < hi) {
+        uint32_t mid = lo + (hi - lo)/2;
+        if(load4B(list_m, mid, cache_w) < node) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+// Index where the tasklet's chunk of a sorted node list starts, moved forward so that no tile is split between tasklets
+static uint32_t tileAlignedChunkStart(uint32_t list_m, uint32_t size, uint32_t tasklet, uint64_t* cache_w) {
+    uint32_t idx = (uint32_t)((uint64_t)size*tasklet/NR_TASKLETS);
+    if(idx > 0 && idx < size) {
+        uint32_t prevTileIdx = load4B(list_m, idx - 1, cache_w)/64;
+        while(idx < size && load4B(list_m, idx, cache_w)/64 == prevTileIdx) {
+            ++idx;
+        }
+    }
+    return idx;
+}
+
+static void initFrontierListBuffer(struct FrontierListBuffer* buffer, uint32_t list_m, uint32_t capacity) {
+    buffer->nodes_w = mem_alloc(FRONTIER_BUFFER_SIZE*sizeof(uint32_t));
+    buffer->size = 0;
+    buffer->list_m = list_m;
+    buffer->capacity = capacity;
+}
+
+// Reserve room for the buffered nodes in the next frontier list and write them with a single MRAM write.
+// Odd sizes are padded with a copy of the last node so that every reservation stays 8B-aligned.
+static void flushFrontierListBuffer(struct FrontierListBuffer* buffer) {
+    if(buffer->size == 0) {
+        return;
+    }
+    if(buffer->size%2 != 0) {
+        buffer->nodes_w[buffer->size] = buffer->nodes_w[buffer->size - 1];
+        ++buffer->size;
+    }
+    mutex_id_t mutexID = MUTEX_GET(nextFrontierListMutex);
+    mutex_lock(mutexID);
+    uint32_t listIdx = NEXT_FRONTIER_SIZE;
+    NEXT_FRONTIER_SIZE += buffer->size;
+    mutex_unlock(mutexID);
+    if(listIdx + buffer->size <= buffer->capacity) {
+        mram_write(buffer->nodes_w, (__mram_ptr void*)(buffer->list_m + listIdx*sizeof(uint32_t)), buffer->size*sizeof(uint32_t));
+    }
+    buffer->size = 0;
+}
+
+static void bufferFrontierNode(struct FrontierListBuffer* buffer, uint32_t node) {
+    buffer->nodes_w[buffer->size++] = node;
+    if(buffer->size == FRONTIER_BUFFER_SIZE) {
+        flushFrontierListBuffer(buffer);
+    }
+}
+
+// Zero size bytes (a multiple of 8) of MRAM, the tasklets writing interleaved blocks of zeros_w (FRONTIER_BLOCK_SIZE zero tiles)
+static void clearMRAM(uint32_t ptr_m, uint32_t size, uint64_t* zeros_w) {
+    uint32_t blockSize = FRONTIER_BLOCK_SIZE*sizeof(uint64_t);
+    for(uint32_t offset = me()*blockSize; offset < size; offset += NR_TASKLETS*blockSize) {
+        mram_write(zeros_w, (__mram_ptr void*)(ptr_m + offset), (offset + blockSize > size)?(size - offset):blockSize);
+    }
+}
+
+// Add the unvisited neighbors of a frontier node to the next frontier and the next frontier list
+static void visitNeighbors(uint32_t node, struct NodePtrReader* nodePtrReader, struct NeighborReader* neighborReader,
+        uint32_t visited_m, uint32_t nextFrontier_m, struct FrontierListBuffer* listBuffer, uint64_t* cache_w) {
+    uint32_t nodePtr, nextNodePtr;
+    getNodePtrs(nodePtrReader, node, &nodePtr, &nextNodePtr);
+    for(seekNeighbors(neighborReader, nodePtr, nextNodePtr); neighborReader->idx < nextNodePtr; ++neighborReader->idx) {
+        uint32_t neighbor = getNeighbor(neighborReader);
+        uint32_t neighborTileIdx = neighbor/64;
+        uint64_t visitedTile = load8B(visited_m, neighborTileIdx, cache_w);
+        if(!isSet(visitedTile, neighbor%64)) { // Neighbor not previously visited
+            // Add neighbor to next frontier, locking only the mutex of its tile
+            mutex_pool_lock(&nextFrontierMutexPool, neighborTileIdx);
+            uint64_t nextFrontierTile = load8B(nextFrontier_m, neighborTileIdx, cache_w);
+            uint32_t added = !isSet(nextFrontierTile, neighbor%64);
+            if(added) {
+                setBit(nextFrontierTile, neighbor%64);
+                store8B(nextFrontierTile, nextFrontier_m, neighborTileIdx, cache_w);
+            }
+            mutex_pool_unlock(&nextFrontierMutexPool, neighborTileIdx);
+            if(added) {
+                bufferFrontierNode(listBuffer, neighbor);
+            }
+        }
+    }
+}
+
+// One level of up to 64 concurrent traversals: OR the traversal mask of every frontier node of the DPU into the masks
+// of its neighbors. The host drops the traversals that already reached a node, so the DPU keeps no visited masks.
+// Nodes of other DPUs whose mask goes from empty to set are listed, with their final masks, for the host to read back.
+static void multiSourceLevel(struct DPUParams* params_w, struct NodePtrReader* nodePtrReader, struct NeighborReader* neighborReader,
+        struct FrontierListBuffer* deltaBuffer, uint64_t* block_w, uint64_t* cache_w) {
+    uint32_t numGlobalNodes = params_w->numNodes;
+    uint32_t startNodeIdx = params_w->dpuStartNodeIdx;
+    uint32_t numNodes = params_w->dpuNumNodes;
+    uint32_t multiFrontier_m = params_w->dpuMultiFrontier_m;
+    uint32_t multiNext_m = params_w->dpuMultiNext_m;
+    uint32_t deltaNodes_m = params_w->dpuMultiDeltaNodes_m;
+    uint32_t deltaMasks_m = params_w->dpuMultiDeltaMasks_m;
+    uint32_t deltaCapacity = MULTI_SOURCE_DELTA_CAPACITY(numGlobalNodes);
+    uint32_t prevDeltaSize = params_w->prevNextFrontierSize;
+
+    // Clear the next masks: own nodes' and the listed ones if the previous level's delta list held all it set, else all
+    if(prevDeltaSize <= deltaCapacity) {
+        clearMRAM(multiNext_m + startNodeIdx*sizeof(uint64_t), numNodes*sizeof(uint64_t), block_w);
+        for(uint32_t i = me(); i < prevDeltaSize; i += NR_TASKLETS) {
+            store8B(0, multiNext_m, load4B(deltaNodes_m, i, cache_w), cache_w);
+        }
+    } else {
+        clearMRAM(multiNext_m, numGlobalNodes*sizeof(uint64_t), block_w);
+    }
+    barrier_wait(&bfsBarrier);
+
+    // Scan the tasklet's nodes' masks a block at a time, skipping nodes in no traversal's frontier
+    uint32_t taskletNodesStart = (uint32_t)((uint64_t)numNodes*me()/NR_TASKLETS);
+    uint32_t taskletNodesEnd = (uint32_t)((uint64_t)numNodes*(me() + 1)/NR_TASKLETS);
+    for(uint32_t blockIdx = taskletNodesStart; blockIdx < taskletNodesEnd; blockIdx += FRONTIER_BLOCK_SIZE) {
+        uint32_t numBlockNodes = loadTileBlock(multiFrontier_m, blockIdx, taskletNodesEnd, block_w);
+        for(uint32_t i = 0; i < numBlockNodes; ++i) {
+            uint64_t mask = block_w[i];
+            if(mask) {
+                uint32_t nodePtr, nextNodePtr;
+                getNodePtrs(nodePtrReader, blockIdx + i, &nodePtr, &nextNodePtr);
+                for(seekNeighbors(neighborReader, nodePtr, nextNodePtr); neighborReader->idx < nextNodePtr; ++neighborReader->idx) {
+                    uint32_t neighbor = getNeighbor(neighborReader);
+                    mutex_pool_lock(&nextFrontierMutexPool, neighbor);
+                    uint64_t nextMask = load8B(multiNext_m, neighbor, cache_w);
+                    if((nextMask & mask) != mask) {
+                        store8B(nextMask | mask, multiNext_m, neighbor, cache_w);
+                    }
+                    mutex_pool_unlock(&nextFrontierMutexPool, neighbor);
+                    if(nextMask == 0 && (neighbor < startNodeIdx || neighbor >= startNodeIdx + numNodes)) {
+                        bufferFrontierNode(deltaBuffer, neighbor);
+                    }
+                }
+            }
+        }
+    }
+    flushFrontierListBuffer(deltaBuffer);
+    barrier_wait(&bfsBarrier);
+
+    // Copy the final masks of the listed nodes next to the list
+    uint32_t deltaSize = NEXT_FRONTIER_SIZE;
+    if(deltaSize <= deltaCapacity) {
+        for(uint32_t i = me(); i < deltaSize; i += NR_TASKLETS) {
+            store8B(load8B(multiNext_m, load4B(deltaNodes_m, i, cache_w), cache_w), deltaMasks_m, i, cache_w);
+        }
+    }
+}
 
 // main
 int main() {
 
     if(me() == 0) {
         mem_reset(); // Reset the heap
+        NEXT_FRONTIER_SIZE = 0;
     }
     // Barrier
     barrier_wait(&my_barrier);
@@ -45,6 +226,12 @@ int main() {
     uint32_t visited_m = params_w->dpuVisited_m;
     uint32_t currentFrontier_m = params_w->dpuCurrentFrontier_m;
     uint32_t nextFrontier_m = params_w->dpuNextFrontier_m;
+    uint32_t frontierFormat = params_w->frontierFormat;
+    uint32_t frontierSize = params_w->frontierSize;
+    uint32_t prevNextFrontierSize = params_w->prevNextFrontierSize;
+    uint32_t frontierList_m = params_w->dpuFrontierList_m;
+    uint32_t nextFrontierList_m = params_w->dpuNextFrontierList_m;
+    uint32_t listCapacity = FRONTIER_LIST_CAPACITY(numGlobalNodes);
 
     if(numNodes > 0) {
 
@@ -58,41 +245,115 @@ int main() {
             }
         }
 
-        // Allocate WRAM cache for each tasklet to use throughout
+        // Allocate WRAM cache and graph readers for each tasklet to use throughout
         uint64_t* cache_w = mem_alloc(sizeof(uint64_t));
+        struct NodePtrReader nodePtrReader;
+        struct NeighborReader neighborReader, frontierReader;
+        initNodePtrReader(&nodePtrReader, nodePtrs_m, nodePtrsOffset, numNodes + 1);
+        initNeighborReader(&neighborReader, neighborIdxs_m);
+        initNeighborReader(&frontierReader, frontierList_m); // The reader works on any array of node indexes
+        struct FrontierListBuffer listBuffer;
+        initFrontierListBuffer(&listBuffer, nextFrontierList_m, listCapacity);
+        uint64_t* block_w = mem_alloc(FRONTIER_BLOCK_SIZE*sizeof(uint64_t)); // Frontier bitmaps are scanned a block of tiles at a time
+        for(uint32_t i = 0; i < FRONTIER_BLOCK_SIZE; ++i) {
+            block_w[i] = 0;
+        }
 
-        // Update current frontier and visited list based on the next frontier from the previous iteration
-        for(uint32_t nodeTileIdx = me(); nodeTileIdx < numGlobalNodes/64; nodeTileIdx += NR_TASKLETS) {
+        // Multi-source BFS keeps its own state
+        if(frontierFormat == FRONTIER_MULTI_SOURCE) {
+            listBuffer.list_m = params_w->dpuMultiDeltaNodes_m;
+            listBuffer.capacity = MULTI_SOURCE_DELTA_CAPACITY(numGlobalNodes);
+            multiSourceLevel(params_w, &nodePtrReader, &neighborReader, &listBuffer, block_w, cache_w);
+            return 0;
+        }
 
-            // Get the next frontier tile from MRAM
-            uint64_t nextFrontierTile = load8B(nextFrontier_m, nodeTileIdx, cache_w);
+        // Tiles of the DPU's nodes handled by the tasklet when scanning bitmaps
+        uint32_t numTiles = numNodes/64;
+        uint32_t taskletTilesStart = (uint32_t)((uint64_t)numTiles*me()/NR_TASKLETS);
+        uint32_t taskletTilesEnd = (uint32_t)((uint64_t)numTiles*(me() + 1)/NR_TASKLETS);
 
-            // Process next frontier tile if it is not empty 
-            if(nextFrontierTile) {
+        // Clear the next frontier: only the tiles listed by the previous level if the list held all of them
+        if(prevNextFrontierSize <= listCapacity) {
+            for(uint32_t i = me(); i < prevNextFrontierSize; i += NR_TASKLETS) {
+                store8B(0, nextFrontier_m, load4B(nextFrontierList_m, i, cache_w)/64, cache_w);
+            }
+        } else {
+            clearMRAM(nextFrontier_m, numGlobalNodes/64*sizeof(uint64_t), block_w);
+        }
 
-                // Mark everything that was previously added to the next frontier as visited
-                uint64_t visitedTile = load8B(visited_m, nodeTileIdx, cache_w);
-                visitedTile |= nextFrontierTile;
-                store8B(visitedTile, visited_m, nodeTileIdx, cache_w);
+        // The first level of a traversal forgets the visited nodes and levels of the previous one,
+        // so that the graph stays on the DPUs across traversals
+        if(level == 1) {
+            clearMRAM(visited_m, numGlobalNodes/64*sizeof(uint64_t), block_w);
+            clearMRAM(nodeLevel_m, numNodes*sizeof(uint32_t), block_w);
+            barrier_wait(&bfsBarrier);
+        }
 
-                // Clear the next frontier
-                store8B(0, nextFrontier_m, nodeTileIdx, cache_w);
+        // Mark the current frontier as visited and update node levels
+        uint32_t ownListStart = 0, ownListEnd = 0;
+        if(frontierFormat == FRONTIER_SPARSE) {
 
+            // The list holds the whole frontier sorted by node, split among tasklets at tile boundaries
+            uint32_t chunkStart = tileAlignedChunkStart(frontierList_m, frontierSize, me(), cache_w);
+            uint32_t chunkEnd = tileAlignedChunkStart(frontierList_m, frontierSize, me() + 1, cache_w);
+            uint32_t tileIdx = 0;
+            uint64_t tileBits = 0;
+            for(seekNeighbors(&frontierReader, chunkStart, chunkEnd); frontierReader.idx < chunkEnd; ++frontierReader.idx) {
+                uint32_t node = getNeighbor(&frontierReader);
+                if(node/64 != tileIdx && tileBits) {
+                    store8B(load8B(visited_m, tileIdx, cache_w) | tileBits, visited_m, tileIdx, cache_w);
+                    tileBits = 0;
+                }
+                tileIdx = node/64;
+                setBit(tileBits, node%64);
+                if(node - startNodeIdx < numNodes) {
+                    store4B(level, nodeLevel_m, node - startNodeIdx, cache_w); // No false sharing so no need for locks
+                }
             }
+            if(tileBits) {
+                store8B(load8B(visited_m, tileIdx, cache_w) | tileBits, visited_m, tileIdx, cache_w);
+            }
+
+            // Find the range of the list with the DPU's own nodes
+            ownListStart = lowerBound(frontierList_m, frontierSize, startNodeIdx, cache_w);
+            ownListEnd = lowerBound(frontierList_m, frontierSize, startNodeIdx + numNodes, cache_w);
 
-            // Extract the current frontier from the previous next frontier and update node levels
-            uint32_t startTileIdx = startNodeIdx/64;
-            uint32_t numTiles = numNodes/64;
-            if(startTileIdx <= nodeTileIdx && nodeTileIdx < startTileIdx + numTiles) {
+        } else if(frontierFormat == FRONTIER_BITMAP) {
 
-                // Update current frontier
-                store8B(nextFrontierTile, currentFrontier_m, nodeTileIdx - startTileIdx, cache_w);
+            // The host wrote the whole frontier bitmap into the frontier list buffer
+            uint32_t globalTilesStart = (uint32_t)((uint64_t)(numGlobalNodes/64)*me()/NR_TASKLETS);
+            uint32_t globalTilesEnd = (uint32_t)((uint64_t)(numGlobalNodes/64)*(me() + 1)/NR_TASKLETS);
+            for(uint32_t blockIdx = globalTilesStart; blockIdx < globalTilesEnd; blockIdx += FRONTIER_BLOCK_SIZE) {
+                uint32_t numBlockTiles = loadTileBlock(frontierList_m, blockIdx, globalTilesEnd, block_w);
+                for(uint32_t i = 0; i < numBlockTiles; ++i) {
+                    uint64_t frontierTile = block_w[i];
+                    if(frontierTile) {
+                        uint32_t tileIdx = blockIdx + i;
+                        store8B(load8B(visited_m, tileIdx, cache_w) | frontierTile, visited_m, tileIdx, cache_w);
+                        if(tileIdx*64 - startNodeIdx < numNodes) {
+                            for(; frontierTile; frontierTile &= frontierTile - 1) {
+                                uint32_t node = tileIdx*64 + __builtin_ctzll(frontierTile);
+                                store4B(level, nodeLevel_m, node - startNodeIdx, cache_w); // No false sharing so no need for locks
+                            }
+                        }
+                    }
+                }
+            }
+
+        } else {
 
-                // Update node levels
-                if(nextFrontierTile) {
-                    for(uint32_t node = nodeTileIdx*64; node < (nodeTileIdx + 1)*64; ++node) {
-                        if(isSet(nextFrontierTile, node%64)) {
-                            store4B(level, nodeLevel_m, node - startNodeIdx, cache_w); // No false sharing so no need for locks
+            // The host wrote only the DPU's own slice of the frontier, into the current frontier
+            for(uint32_t blockIdx = taskletTilesStart; blockIdx < taskletTilesEnd; blockIdx += FRONTIER_BLOCK_SIZE) {
+                uint32_t numBlockTiles = loadTileBlock(currentFrontier_m, blockIdx, taskletTilesEnd, block_w);
+                for(uint32_t i = 0; i < numBlockTiles; ++i) {
+                    uint64_t currentFrontierTile = block_w[i];
+                    if(currentFrontierTile) {
+                        uint32_t tileIdx = blockIdx + i;
+                        uint32_t globalTileIdx = startNodeIdx/64 + tileIdx;
+                        store8B(load8B(visited_m, globalTileIdx, cache_w) | currentFrontierTile, visited_m, globalTileIdx, cache_w);
+                        for(; currentFrontierTile; currentFrontierTile &= currentFrontierTile - 1) {
+                            uint32_t node = tileIdx*64 + __builtin_ctzll(currentFrontierTile);
+                            store4B(level, nodeLevel_m, node, cache_w); // No false sharing so no need for locks
                         }
                     }
                 }
@@ -100,46 +361,67 @@ int main() {
 
         }
 
-        // Wait until all tasklets have updated the current frontier
+        // Wait until all tasklets have cleared the next frontier and updated the visited nodes
         barrier_wait(&bfsBarrier);
 
-        // Identify tasklet's nodes
-        uint32_t numNodesPerTasklet = (numNodes + NR_TASKLETS - 1)/NR_TASKLETS;
-        uint32_t taskletNodesStart = me()*numNodesPerTasklet;
-        uint32_t taskletNumNodes;
-        if(taskletNodesStart > numNodes) {
-            taskletNumNodes = 0;
-        } else if(taskletNodesStart + numNodesPerTasklet > numNodes) {
-            taskletNumNodes = numNodes - taskletNodesStart;
+        // Visit neighbors of the current frontier
+        if(frontierFormat == FRONTIER_SPARSE) {
+
+            // Split the DPU's own part of the list evenly among tasklets
+            uint32_t ownListSize = ownListEnd - ownListStart;
+            uint32_t chunkStart = ownListStart + (uint32_t)((uint64_t)ownListSize*me()/NR_TASKLETS);
+            uint32_t chunkEnd = ownListStart + (uint32_t)((uint64_t)ownListSize*(me() + 1)/NR_TASKLETS);
+            for(seekNeighbors(&frontierReader, chunkStart, chunkEnd); frontierReader.idx < chunkEnd; ++frontierReader.idx) {
+                uint32_t node = getNeighbor(&frontierReader) - startNodeIdx;
+                visitNeighbors(node, &nodePtrReader, &neighborReader, visited_m, nextFrontier_m, &listBuffer, cache_w);
+            }
+
+        } else if(frontierFormat == FRONTIER_BITMAP) {
+
+            // Bottom-up: every unvisited node of the DPU looks for a neighbor in the frontier and stops at the first one.
+            // Tasklets own whole tiles, so they write their block of the next frontier without locks.
+            for(uint32_t blockIdx = taskletTilesStart; blockIdx < taskletTilesEnd; blockIdx += FRONTIER_BLOCK_SIZE) {
+                uint32_t numBlockTiles = loadTileBlock(visited_m, startNodeIdx/64 + blockIdx, startNodeIdx/64 + taskletTilesEnd, block_w);
+                for(uint32_t i = 0; i < numBlockTiles; ++i) {
+                    uint32_t tileIdx = blockIdx + i;
+                    uint64_t nextFrontierTile = 0;
+                    for(uint64_t unvisitedTile = ~block_w[i]; unvisitedTile; unvisitedTile &= unvisitedTile - 1) {
+                        uint32_t node = tileIdx*64 + __builtin_ctzll(unvisitedTile);
+                        uint32_t nodePtr, nextNodePtr;
+                        getNodePtrs(&nodePtrReader, node, &nodePtr, &nextNodePtr);
+                        for(seekNeighbors(&neighborReader, nodePtr, nextNodePtr); neighborReader.idx < nextNodePtr; ++neighborReader.idx) {
+                            uint32_t neighbor = getNeighbor(&neighborReader);
+                            if(isSet(load8B(frontierList_m, neighbor/64, cache_w), neighbor%64)) { // Neighbor in the current frontier
+                                setBit(nextFrontierTile, node%64);
+                                bufferFrontierNode(&listBuffer, startNodeIdx + node);
+                                break;
+                            }
+                        }
+                    }
+                    block_w[i] = nextFrontierTile;
+                }
+                mram_write(block_w, (__mram_ptr void*)(nextFrontier_m + (startNodeIdx/64 + blockIdx)*sizeof(uint64_t)), numBlockTiles*sizeof(uint64_t));
+            }
+
         } else {
-            taskletNumNodes = numNodesPerTasklet;
-        }
 
-        // Visit neighbors of the current frontier
-        mutex_id_t mutexID = MUTEX_GET(nextFrontierMutex);
-        for(uint32_t node = taskletNodesStart; node < taskletNodesStart + taskletNumNodes; ++node) {
-            uint32_t nodeTileIdx = node/64;
-            uint64_t currentFrontierTile = load8B(currentFrontier_m, nodeTileIdx, cache_w); // TODO: Optimize: load tile then loop over nodes in the tile
-            if(isSet(currentFrontierTile, node%64)) { // If the node is in the current frontier
-                // Visit its neighbors
-                uint32_t nodePtr = load4B(nodePtrs_m, node, cache_w) - nodePtrsOffset;
-                uint32_t nextNodePtr = load4B(nodePtrs_m, node + 1, cache_w) - nodePtrsOffset; // TODO: Optimize: might be in the same 8B as nodePtr
-                for(uint32_t i = nodePtr; i < nextNodePtr; ++i) {
-                    uint32_t neighbor = load4B(neighborIdxs_m, i, cache_w); // TODO: Optimize: sequential access to neighbors can use sequential reader
-                    uint32_t neighborTileIdx = neighbor/64;
-                    uint64_t visitedTile = load8B(visited_m, neighborTileIdx, cache_w);
-                    if(!isSet(visitedTile, neighbor%64)) { // Neighbor not previously visited
-                        // Add neighbor to next frontier
-                        mutex_lock(mutexID); // TODO: Optimize: use more locks to reduce contention
-                        uint64_t nextFrontierTile = load8B(nextFrontier_m, neighborTileIdx, cache_w);
-                        setBit(nextFrontierTile, neighbor%64);
-                        store8B(nextFrontierTile, nextFrontier_m, neighborTileIdx, cache_w);
-                        mutex_unlock(mutexID);
+            // Scan the tasklet's tiles of the current frontier a block at a time, skipping empty tiles
+            // and visiting the nodes of the others in order of their set bits
+            for(uint32_t blockIdx = taskletTilesStart; blockIdx < taskletTilesEnd; blockIdx += FRONTIER_BLOCK_SIZE) {
+                uint32_t numBlockTiles = loadTileBlock(currentFrontier_m, blockIdx, taskletTilesEnd, block_w);
+                for(uint32_t i = 0; i < numBlockTiles; ++i) {
+                    for(uint64_t currentFrontierTile = block_w[i]; currentFrontierTile; currentFrontierTile &= currentFrontierTile - 1) {
+                        uint32_t node = (blockIdx + i)*64 + __builtin_ctzll(currentFrontierTile);
+                        visitNeighbors(node, &nodePtrReader, &neighborReader, visited_m, nextFrontier_m, &listBuffer, cache_w);
                     }
                 }
             }
+
         }
 
+        // List the nodes still buffered
+        flushFrontierListBuffer(&listBuffer);
+
     }
 
     return 0;
@@ -13,9 +13,16 @@
 #include <string.h>
 #include <unistd.h>
 
+#include <omp.h>
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
 #include "mram-management.h"
+#include "partition.h"
+#include "staging.h"
 #include "../support/common.h"
-#include "../support/graph.h"
+#include "graph.h"
 #include "../support/params.h"
 #include "../support/timer.h"
 #include "../support/utils.h"
@@ -29,6 +36,175 @@
 
 #define DPU_BINARY "./bin/dpu_code"
 
+// Number of bit vector tiles each host thread ORs across all DPUs at a time when computing the frontier union
+#define UNION_BLOCK_SIZE 512
+
+// OR n tiles of src into dst
+static void orTiles(uint64_t* dst, const uint64_t* src, uint32_t n) {
+    uint32_t i = 0;
+#if defined(__AVX512F__)
+    for(; i + 8 <= n; i += 8) {
+        __m512i d = _mm512_loadu_si512((const void*)(dst + i));
+        __m512i s = _mm512_loadu_si512((const void*)(src + i));
+        _mm512_storeu_si512((void*)(dst + i), _mm512_or_si512(d, s));
+    }
+#elif defined(__AVX2__)
+    for(; i + 4 <= n; i += 4) {
+        __m256i d = _mm256_loadu_si256((const __m256i*)(dst + i));
+        __m256i s = _mm256_loadu_si256((const __m256i*)(src + i));
+        _mm256_storeu_si256((__m256i*)(dst + i), _mm256_or_si256(d, s));
+    }
+#endif
+    for(; i < n; ++i) {
+        dst[i] |= src[i];
+    }
+}
+
+// Union of the next frontiers copied back from the DPUs into frontier, without the nodes visited in earlier levels
+// (a DPU only knows about the visited nodes the host has sent it), which are then marked as visited. The next frontier
+// of DPU d is a list of dpuNextFrontierSizes[d] nodes, or a bit vector if the list overflowed, at dpuNextFrontiers + d*numNodes/64.
+// Lists are scattered with atomic ORs, then every thread ORs the bit vectors of all DPUs over its blocks of tiles and
+// filters, counts and sums the edges of the resulting frontier nodes in the same pass. Returns the frontier size.
+static uint32_t unionFrontiers(struct CSRGraph csrGraph, uint64_t* frontier, uint64_t* visited, uint64_t* dpuNextFrontiers,
+        const uint32_t* dpuNextFrontierSizes, uint32_t numDPUs, uint32_t listCapacity, uint64_t* frontierEdges) {
+    uint32_t numTiles = csrGraph.numNodes/64;
+    uint32_t* nodePtrs = csrGraph.nodePtrs;
+    uint32_t frontierSize = 0;
+    uint64_t edges = 0;
+    #pragma omp parallel
+    {
+        #pragma omp for
+        for(uint32_t i = 0; i < numTiles; ++i) {
+            frontier[i] = 0;
+        }
+        #pragma omp for schedule(dynamic)
+        for(uint32_t d = 0; d < numDPUs; ++d) {
+            if(dpuNextFrontierSizes[d] <= listCapacity) {
+                uint32_t* list = (uint32_t*)(dpuNextFrontiers + (uint64_t)d*numTiles);
+                for(uint32_t i = 0; i < dpuNextFrontierSizes[d]; ++i) {
+                    __atomic_fetch_or(&frontier[list[i]/64], 1ULL << (list[i]%64), __ATOMIC_RELAXED);
+                }
+            }
+        }
+        #pragma omp for schedule(dynamic) reduction(+:frontierSize, edges)
+        for(uint32_t blockIdx = 0; blockIdx < numTiles; blockIdx += UNION_BLOCK_SIZE) {
+            uint32_t numBlockTiles = (blockIdx + UNION_BLOCK_SIZE > numTiles)?(numTiles - blockIdx):UNION_BLOCK_SIZE;
+            for(uint32_t d = 0; d < numDPUs; ++d) {
+                if(dpuNextFrontierSizes[d] > listCapacity) {
+                    orTiles(frontier + blockIdx, dpuNextFrontiers + (uint64_t)d*numTiles + blockIdx, numBlockTiles);
+                }
+            }
+            for(uint32_t i = blockIdx; i < blockIdx + numBlockTiles; ++i) {
+                uint64_t tile = frontier[i] & ~visited[i];
+                frontier[i] = tile;
+                visited[i] |= tile;
+                frontierSize += __builtin_popcountll(tile);
+                for(; tile; tile &= tile - 1) {
+                    uint32_t node = i*64 + __builtin_ctzll(tile);
+                    edges += nodePtrs[node + 1] - nodePtrs[node];
+                }
+            }
+        }
+    }
+    *frontierEdges = edges;
+    return frontierSize;
+}
+
+// Sources of the traversals: read from a file (one node per line), or node 0 followed by random nodes with edges
+static uint32_t* getSources(struct Params p, struct CSRGraph csrGraph, uint32_t* numSources) {
+    uint32_t* sources;
+    if(p.sourceFileName != NULL) {
+        FILE* fp = fopen(p.sourceFileName, "r");
+        if(fp == NULL) {
+            PRINT_ERROR("Cannot open source file %s", p.sourceFileName);
+            exit(1);
+        }
+        uint32_t capacity = 64;
+        sources = malloc(capacity*sizeof(uint32_t));
+        *numSources = 0;
+        uint32_t source;
+        while(fscanf(fp, "%u", &source) == 1) {
+            if(source >= csrGraph.numNodes) {
+                PRINT_ERROR("Source %u is not a node of the graph", source);
+                exit(1);
+            }
+            if(*numSources == capacity) {
+                capacity *= 2;
+                sources = realloc(sources, capacity*sizeof(uint32_t));
+            }
+            sources[(*numSources)++] = source;
+        }
+        fclose(fp);
+        assert(*numSources > 0 && "Empty source file!");
+    } else {
+        *numSources = p.numSources;
+        sources = malloc(*numSources*sizeof(uint32_t));
+        sources[0] = 0;
+        srand(0);
+        for(uint32_t i = 1; i < *numSources; ++i) {
+            uint32_t source;
+            do {
+                source = rand()%csrGraph.numNodes;
+            } while(csrGraph.numEdges > 0 && csrGraph.nodePtrs[source + 1] == csrGraph.nodePtrs[source]);
+            sources[i] = source;
+        }
+    }
+    return sources;
+}
+
+// BFS from source on the CPU, writing the level of every node (1 for the source, 0 if not reachable)
+static void bfsReference(struct CSRGraph csrGraph, uint32_t source, uint32_t* nodeLevelReference,
+        uint64_t* visited, uint64_t* currentFrontier, uint64_t* nextFrontier) {
+    uint32_t numNodes = csrGraph.numNodes;
+    uint32_t* nodePtrs = csrGraph.nodePtrs;
+    uint32_t* neighborIdxs = csrGraph.neighborIdxs;
+    memset(nodeLevelReference, 0, numNodes*sizeof(uint32_t));
+    memset(visited, 0, numNodes/64*sizeof(uint64_t));
+    memset(nextFrontier, 0, numNodes/64*sizeof(uint64_t));
+    setBit(nextFrontier[source/64], source%64); // Initialize frontier to the source
+    uint32_t nextFrontierEmpty = 0;
+    uint32_t level = 1;
+    while(!nextFrontierEmpty) {
+        // Update current frontier and visited list based on the next frontier from the previous iteration
+        for(uint32_t nodeTileIdx = 0; nodeTileIdx < numNodes/64; ++nodeTileIdx) {
+            uint64_t nextFrontierTile = nextFrontier[nodeTileIdx];
+            currentFrontier[nodeTileIdx] = nextFrontierTile;
+            if(nextFrontierTile) {
+                visited[nodeTileIdx] |= nextFrontierTile;
+                nextFrontier[nodeTileIdx] = 0;
+                for(uint32_t node = nodeTileIdx*64; node < (nodeTileIdx + 1)*64; ++node) {
+                    if(isSet(nextFrontierTile, node%64)) {
+                        nodeLevelReference[node] = level;
+                    }
+                }
+            }
+        }
+        // Visit neighbors of the current frontier
+        nextFrontierEmpty = 1;
+        for(uint32_t nodeTileIdx = 0; nodeTileIdx < numNodes/64; ++nodeTileIdx) {
+            uint64_t currentFrontierTile = currentFrontier[nodeTileIdx];
+            if(currentFrontierTile) {
+                for(uint32_t node = nodeTileIdx*64; node < (nodeTileIdx + 1)*64; ++node) {
+                    if(isSet(currentFrontierTile, node%64)) { // If the node is in the current frontier
+                        // Visit its neighbors
+                        uint32_t nodePtr = nodePtrs[node];
+                        uint32_t nextNodePtr = nodePtrs[node + 1];
+                        for(uint32_t i = nodePtr; i < nextNodePtr; ++i) {
+                            uint32_t neighbor = neighborIdxs[i];
+                            if(!isSet(visited[neighbor/64], neighbor%64)) { // Neighbor not previously visited
+                                // Add neighbor to next frontier
+                                setBit(nextFrontier[neighbor/64], neighbor%64);
+                                nextFrontierEmpty = 0;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+        ++level;
+    }
+}
+
 // Main of the Host Application
 int main(int argc, char** argv) {
 
@@ -37,7 +213,8 @@ int main(int argc, char** argv) {
 
     // Timer and profiling
     Timer timer;
-    float loadTime = 0.0f, dpuTime = 0.0f, hostTime = 0.0f, retrieveTime = 0.0f;
+    Timer unionTimer;
+    float loadTime = 0.0f, dpuTime = 0.0f, hostTime = 0.0f, unionTime = 0.0f, retrieveTime = 0.0f;
     #if ENERGY
     struct dpu_probe_t probe;
     DPU_ASSERT(dpu_probe_init("energy_probe", &probe));
@@ -57,248 +234,510 @@ int main(int argc, char** argv) {
     struct COOGraph cooGraph = readCOOGraph(p.fileName);
     PRINT_INFO(p.verbosity >= 1, "    Graph has %d nodes and %d edges", cooGraph.numNodes, cooGraph.numEdges);
     struct CSRGraph csrGraph = coo2csr(cooGraph);
+    if(p.directionOptimizing && !isSymmetric(csrGraph)) {
+        PRINT_WARNING("    Graph is not symmetric, so bottom-up levels would miss in-edges: traversing top-down only");
+        p.directionOptimizing = 0;
+    }
     uint32_t numNodes = csrGraph.numNodes;
     uint32_t* nodePtrs = csrGraph.nodePtrs;
-    uint32_t* neighborIdxs = csrGraph.neighborIdxs;
+    uint32_t numSources;
+    uint32_t* sources = getSources(p, csrGraph, &numSources);
+    PRINT_INFO(p.verbosity >= 1, "    Running %u traversal(s)%s", numSources, p.multiSource?" in batches of 64 concurrent traversals":"");
     uint32_t* nodeLevel = calloc(numNodes, sizeof(uint32_t)); // Node's BFS level (initially all 0 meaning not reachable)
     uint64_t* visited = calloc(numNodes/64, sizeof(uint64_t)); // Bit vector with one bit per node
     uint64_t* currentFrontier = calloc(numNodes/64, sizeof(uint64_t)); // Bit vector with one bit per node
     uint64_t* nextFrontier = calloc(numNodes/64, sizeof(uint64_t)); // Bit vector with one bit per node
-    setBit(nextFrontier[0], 0); // Initialize frontier to first node
-    uint32_t level = 1;
+    uint32_t frontierListCapacity = FRONTIER_LIST_CAPACITY(numNodes);
+    uint32_t* frontierList = malloc(frontierListCapacity*sizeof(uint32_t)); // Frontier as a sorted list of nodes when it is sparse
+    uint32_t* nodeLevelReference = calloc(numNodes, sizeof(uint32_t));
+    PRINT_INFO(p.verbosity >= 1, "    Using %d host thread(s)", omp_get_max_threads());
+
+    // Partition data structure across DPUs in ranges of whole tiles, balancing either the node or the edge count
+    uint32_t dpuNodeBounds[numDPUs + 1];
+    if(p.edgeBalanced) {
+        uint64_t* workPrefix = degreeWorkPrefix(nodePtrs, numNodes);
+        partitionByWork(workPrefix, 0, numNodes, numDPUs, 64, dpuNodeBounds);
+        free(workPrefix);
+        PRINT_INFO(p.verbosity >= 1, "Assigning about %u edges per DPU", csrGraph.numEdges/numDPUs);
+    } else {
+        partitionEvenly(0, numNodes, numDPUs, 64, dpuNodeBounds);
+        PRINT_INFO(p.verbosity >= 1, "Assigning %u nodes per DPU", dpuNodeBounds[1] - dpuNodeBounds[0]);
+    }
 
-    // Partition data structure across DPUs
-    uint32_t numNodesPerDPU = ROUND_UP_TO_MULTIPLE_OF_64((numNodes - 1)/numDPUs + 1);
-    PRINT_INFO(p.verbosity >= 1, "Assigning %u nodes per DPU", numNodesPerDPU);
-    struct DPUParams dpuParams[numDPUs];
-    uint32_t dpuParams_m[numDPUs];
-    unsigned int dpuIdx = 0;
-    DPU_FOREACH (dpu_set, dpu) {
-
-        // Allocate parameters
-        struct mram_heap_allocator_t allocator;
-        init_allocator(&allocator);
-        dpuParams_m[dpuIdx] = mram_heap_alloc(&allocator, sizeof(struct DPUParams));
-
-        // Find DPU's nodes
-        uint32_t dpuStartNodeIdx = dpuIdx*numNodesPerDPU;
-        uint32_t dpuNumNodes;
-        if(dpuStartNodeIdx > numNodes) {
-            dpuNumNodes = 0;
-        } else if(dpuStartNodeIdx + numNodesPerDPU > numNodes) {
-            dpuNumNodes = numNodes - dpuStartNodeIdx;
-        } else {
-            dpuNumNodes = numNodesPerDPU;
+    uint32_t maxDPUNumNodes = 0, maxDPUNumNeighbors = 0, numActiveDPUs = 0;
+    for(uint32_t d = 0; d < numDPUs; ++d) {
+        uint32_t dpuNumNodes = dpuNodeBounds[d + 1] - dpuNodeBounds[d];
+        uint32_t dpuNumNeighbors = nodePtrs[dpuNodeBounds[d + 1]] - nodePtrs[dpuNodeBounds[d]];
+        maxDPUNumNodes = (dpuNumNodes > maxDPUNumNodes)?dpuNumNodes:maxDPUNumNodes;
+        maxDPUNumNeighbors = (dpuNumNeighbors > maxDPUNumNeighbors)?dpuNumNeighbors:maxDPUNumNeighbors;
+        numActiveDPUs += (dpuNumNodes > 0);
+    }
+
+    // Allocate MRAM at the same offsets on all DPUs, sized for the largest partition, so that the graph is sent with
+    // parallel transfers. Everything is allocated before any transfer, so that a graph that does not fit fails up front,
+    // multi-source BFS adding 64-bit traversal masks for every node of the graph and their delta list
+    struct mram_heap_allocator_t allocator;
+    init_allocator(&allocator);
+    uint32_t dpuParams_m = mram_heap_alloc(&allocator, sizeof(struct DPUParams));
+    uint32_t dpuNodePtrs_m = mram_heap_alloc(&allocator, (maxDPUNumNodes + 1)*sizeof(uint32_t));
+    uint32_t dpuNeighborIdxs_m = mram_heap_alloc(&allocator, (uint64_t)maxDPUNumNeighbors*sizeof(uint32_t));
+    uint32_t dpuNodeLevel_m = mram_heap_alloc(&allocator, maxDPUNumNodes*sizeof(uint32_t));
+    uint32_t dpuVisited_m = mram_heap_alloc(&allocator, numNodes/64*sizeof(uint64_t));
+    uint32_t dpuCurrentFrontier_m = mram_heap_alloc(&allocator, maxDPUNumNodes/64*sizeof(uint64_t));
+    uint32_t dpuNextFrontier_m = mram_heap_alloc(&allocator, numNodes/64*sizeof(uint64_t));
+    uint32_t dpuFrontierList_m = mram_heap_alloc(&allocator, frontierListCapacity*sizeof(uint32_t));
+    uint32_t dpuNextFrontierList_m = mram_heap_alloc(&allocator, frontierListCapacity*sizeof(uint32_t));
+    uint32_t multiDeltaCapacity = MULTI_SOURCE_DELTA_CAPACITY(numNodes);
+    uint32_t dpuMultiFrontier_m = 0, dpuMultiNext_m = 0, dpuMultiDeltaNodes_m = 0, dpuMultiDeltaMasks_m = 0;
+    if(p.multiSource) {
+        uint64_t multiSourceBytes = (uint64_t)(maxDPUNumNodes + numNodes)*sizeof(uint64_t) + (uint64_t)multiDeltaCapacity*(sizeof(uint32_t) + sizeof(uint64_t));
+        if(allocator.totalAllocated + multiSourceBytes > DPU_CAPACITY) {
+            PRINT_ERROR("Multi-source BFS needs %lu bytes of MRAM per DPU for the traversal masks of %u nodes on top of %lu bytes for the graph, which exceeds the DPU capacity (%d bytes)!",
+                    (unsigned long)multiSourceBytes, numNodes, (unsigned long)allocator.totalAllocated, DPU_CAPACITY);
+            exit(0);
         }
-        dpuParams[dpuIdx].dpuNumNodes = dpuNumNodes;
+        dpuMultiFrontier_m = mram_heap_alloc(&allocator, maxDPUNumNodes*sizeof(uint64_t));
+        dpuMultiNext_m = mram_heap_alloc(&allocator, (uint64_t)numNodes*sizeof(uint64_t));
+        dpuMultiDeltaNodes_m = mram_heap_alloc(&allocator, multiDeltaCapacity*sizeof(uint32_t));
+        dpuMultiDeltaMasks_m = mram_heap_alloc(&allocator, (uint64_t)multiDeltaCapacity*sizeof(uint64_t));
+    }
+    PRINT_INFO(p.verbosity >= 2, "    Total memory allocated is %lu bytes", (unsigned long)allocator.totalAllocated);
+
+    // Set up DPU parameters and find every DPU's CSR graph partition
+    struct DPUParams dpuParams[numDPUs];
+    memset(dpuParams, 0, sizeof(dpuParams));
+    uint8_t* dpuNodePtrs_h[numDPUs];
+    uint8_t* dpuNeighborIdxs_h[numDPUs];
+    uint64_t dpuNodePtrsSizes[numDPUs], dpuNeighborIdxsSizes[numDPUs], dpuParamsSizes[numDPUs];
+    uint8_t* dpuParams_h[numDPUs];
+    unsigned int dpuIdx;
+    for(dpuIdx = 0; dpuIdx < numDPUs; ++dpuIdx) {
+        uint32_t dpuStartNodeIdx = dpuNodeBounds[dpuIdx];
+        uint32_t dpuNumNodes = dpuNodeBounds[dpuIdx + 1] - dpuStartNodeIdx;
+        uint32_t dpuNodePtrsOffset = nodePtrs[dpuStartNodeIdx];
+        uint32_t dpuNumNeighbors = nodePtrs[dpuStartNodeIdx + dpuNumNodes] - dpuNodePtrsOffset;
         PRINT_INFO(p.verbosity >= 2, "    DPU %u:", dpuIdx);
         PRINT_INFO(p.verbosity >= 2, "        Receives %u nodes", dpuNumNodes);
-
-        // Partition edges and copy data
+        dpuParams[dpuIdx].dpuNumNodes = dpuNumNodes;
+        dpuParams[dpuIdx].dpuStartNodeIdx = dpuStartNodeIdx;
         if(dpuNumNodes > 0) {
-
-            // Find DPU's CSR graph partition
-            uint32_t* dpuNodePtrs_h = &nodePtrs[dpuStartNodeIdx];
-            uint32_t dpuNodePtrsOffset = dpuNodePtrs_h[0];
-            uint32_t* dpuNeighborIdxs_h = neighborIdxs + dpuNodePtrsOffset;
-            uint32_t dpuNumNeighbors = dpuNodePtrs_h[dpuNumNodes] - dpuNodePtrsOffset;
-            uint32_t* dpuNodeLevel_h = &nodeLevel[dpuStartNodeIdx];
-
-            // Allocate MRAM
-            uint32_t dpuNodePtrs_m = mram_heap_alloc(&allocator, (dpuNumNodes + 1)*sizeof(uint32_t));
-            uint32_t dpuNeighborIdxs_m = mram_heap_alloc(&allocator, dpuNumNeighbors*sizeof(uint32_t));
-            uint32_t dpuNodeLevel_m = mram_heap_alloc(&allocator, dpuNumNodes*sizeof(uint32_t));
-            uint32_t dpuVisited_m = mram_heap_alloc(&allocator, numNodes/64*sizeof(uint64_t));
-            uint32_t dpuCurrentFrontier_m = mram_heap_alloc(&allocator, dpuNumNodes/64*sizeof(uint64_t));
-            uint32_t dpuNextFrontier_m = mram_heap_alloc(&allocator, numNodes/64*sizeof(uint64_t));
-            PRINT_INFO(p.verbosity >= 2, "        Total memory allocated is %d bytes", allocator.totalAllocated);
-
-            // Set up DPU parameters
             dpuParams[dpuIdx].numNodes = numNodes;
-            dpuParams[dpuIdx].dpuStartNodeIdx = dpuStartNodeIdx;
             dpuParams[dpuIdx].dpuNodePtrsOffset = dpuNodePtrsOffset;
-            dpuParams[dpuIdx].level = level;
             dpuParams[dpuIdx].dpuNodePtrs_m = dpuNodePtrs_m;
             dpuParams[dpuIdx].dpuNeighborIdxs_m = dpuNeighborIdxs_m;
             dpuParams[dpuIdx].dpuNodeLevel_m = dpuNodeLevel_m;
             dpuParams[dpuIdx].dpuVisited_m = dpuVisited_m;
             dpuParams[dpuIdx].dpuCurrentFrontier_m = dpuCurrentFrontier_m;
             dpuParams[dpuIdx].dpuNextFrontier_m = dpuNextFrontier_m;
-
-            // Send data to DPU
-            PRINT_INFO(p.verbosity >= 2, "        Copying data to DPU");
-            startTimer(&timer);
-            copyToDPU(dpu, (uint8_t*)dpuNodePtrs_h, dpuNodePtrs_m, (dpuNumNodes + 1)*sizeof(uint32_t));
-            copyToDPU(dpu, (uint8_t*)dpuNeighborIdxs_h, dpuNeighborIdxs_m, dpuNumNeighbors*sizeof(uint32_t));
-            copyToDPU(dpu, (uint8_t*)dpuNodeLevel_h, dpuNodeLevel_m, dpuNumNodes*sizeof(uint32_t));
-            copyToDPU(dpu, (uint8_t*)visited, dpuVisited_m, numNodes/64*sizeof(uint64_t));
-            copyToDPU(dpu, (uint8_t*)nextFrontier, dpuNextFrontier_m, numNodes/64*sizeof(uint64_t));
-            // NOTE: No need to copy current frontier because it is written before being read
-            stopTimer(&timer);
-            loadTime += getElapsedTime(timer);
-
+            dpuParams[dpuIdx].prevNextFrontierSize = UINT32_MAX; // Nothing to go by, so the DPU clears the whole next frontier
+            dpuParams[dpuIdx].dpuFrontierList_m = dpuFrontierList_m;
+            dpuParams[dpuIdx].dpuNextFrontierList_m = dpuNextFrontierList_m;
+            dpuParams[dpuIdx].dpuMultiFrontier_m = dpuMultiFrontier_m;
+            dpuParams[dpuIdx].dpuMultiNext_m = dpuMultiNext_m;
+            dpuParams[dpuIdx].dpuMultiDeltaNodes_m = dpuMultiDeltaNodes_m;
+            dpuParams[dpuIdx].dpuMultiDeltaMasks_m = dpuMultiDeltaMasks_m;
         }
-
-        // Send parameters to DPU
-        PRINT_INFO(p.verbosity >= 2, "        Copying parameters to DPU");
-        startTimer(&timer);
-        copyToDPU(dpu, (uint8_t*)&dpuParams[dpuIdx], dpuParams_m[dpuIdx], sizeof(struct DPUParams));
-        stopTimer(&timer);
-        loadTime += getElapsedTime(timer);
-
-        ++dpuIdx;
-
+        dpuNodePtrs_h[dpuIdx] = (dpuNumNodes > 0)?(uint8_t*)&nodePtrs[dpuStartNodeIdx]:NULL;
+        dpuNodePtrsSizes[dpuIdx] = (dpuNumNodes + 1)*sizeof(uint32_t);
+        dpuNeighborIdxs_h[dpuIdx] = (dpuNumNodes > 0)?(uint8_t*)&csrGraph.neighborIdxs[dpuNodePtrsOffset]:NULL;
+        dpuNeighborIdxsSizes[dpuIdx] = (uint64_t)dpuNumNeighbors*sizeof(uint32_t);
+        dpuParams_h[dpuIdx] = (uint8_t*)&dpuParams[dpuIdx];
+        dpuParamsSizes[dpuIdx] = sizeof(struct DPUParams);
     }
-    PRINT_INFO(p.verbosity >= 1, "    CPU-DPU Time: %f ms", loadTime*1e3);
 
-    // Iterate until next frontier is empty
-    uint32_t nextFrontierEmpty = 0;
-    while(!nextFrontierEmpty) {
-
-        PRINT_INFO(p.verbosity >= 1, "Processing current frontier for level %u", level);
-
-	#if ENERGY
-	DPU_ASSERT(dpu_probe_start(&probe));
-	#endif
-        // Run all DPUs
-        PRINT_INFO(p.verbosity >= 1, "    Booting DPUs");
-        startTimer(&timer);
-        DPU_ASSERT(dpu_launch(dpu_set, DPU_SYNCHRONOUS));
-        stopTimer(&timer);
-        dpuTime += getElapsedTime(timer);
-        PRINT_INFO(p.verbosity >= 2, "    Level DPU Time: %f ms", getElapsedTime(timer)*1e3);
-	#if ENERGY
-    	DPU_ASSERT(dpu_probe_stop(&probe));
-    	double energy;
-    	DPU_ASSERT(dpu_probe_get(&probe, DPU_ENERGY, DPU_AVERAGE, &energy));
-	tenergy += energy;
-	#endif
-
-
-
-        // Copy back next frontier from all DPUs and compute their union as the current frontier
-        startTimer(&timer);
-        dpuIdx = 0;
-        DPU_FOREACH (dpu_set, dpu) {
-            uint32_t dpuNumNodes = dpuParams[dpuIdx].dpuNumNodes;
-            if(dpuNumNodes > 0) {
-                if(dpuIdx == 0) {
-                    copyFromDPU(dpu, dpuParams[dpuIdx].dpuNextFrontier_m, (uint8_t*)currentFrontier, numNodes/64*sizeof(uint64_t));
-                } else {
-                    copyFromDPU(dpu, dpuParams[dpuIdx].dpuNextFrontier_m, (uint8_t*)nextFrontier, numNodes/64*sizeof(uint64_t));
-                    for(uint32_t i = 0; i < numNodes/64; ++i) {
-                        currentFrontier[i] |= nextFrontier[i];
-                    }
-                }
-                ++dpuIdx;
-            }
-        }
+    // Send the graph to the DPUs, where it stays for all traversals, and the parameters
+    // NOTE: No need to copy the node levels, visited nodes and frontiers because the DPU resets them at the
+    // first level of every traversal, or they are written before being read
+    PRINT_INFO(p.verbosity >= 2, "    Copying data to DPUs");
+    startTimer(&timer);
+    pushSlicesToDPUs(dpu_set, numDPUs, dpuNodePtrs_m, dpuNodePtrs_h, dpuNodePtrsSizes, (uint8_t*)&nodePtrs[ROUND_UP_TO_MULTIPLE_OF_2(numNodes + 1)]);
+    pushSlicesToDPUs(dpu_set, numDPUs, dpuNeighborIdxs_m, dpuNeighborIdxs_h, dpuNeighborIdxsSizes,
+            (uint8_t*)csrGraph.neighborIdxs + ROUND_UP_TO_MULTIPLE_OF_8((uint64_t)csrGraph.numEdges*sizeof(uint32_t)));
+    pushSlicesToDPUs(dpu_set, numDPUs, dpuParams_m, dpuParams_h, dpuParamsSizes, (uint8_t*)&dpuParams[numDPUs]);
+    stopTimer(&timer);
+    loadTime += getElapsedTime(timer);
+    PRINT_INFO(p.verbosity >= 1, "    CPU-DPU Time: %f ms", loadTime*1e3);
 
-        // Check if the next frontier is empty, and copy data to DPU if not empty
-        nextFrontierEmpty = 1;
-        for(uint32_t i = 0; i < numNodes/64; ++i) {
-            if(currentFrontier[i]) {
-                nextFrontierEmpty = 0;
-                break;
+    // Next frontiers of the DPUs, each as a list or a bit vector of the same number of bytes
+    uint64_t* dpuNextFrontiers = p.multiSource?NULL:malloc((uint64_t)numDPUs*numNodes/64*sizeof(uint64_t));
+    uint32_t* dpuNextFrontierSizes = calloc(numDPUs, sizeof(uint32_t));
+
+    // Per-level output is shown at verbosity 1 for a single traversal and at verbosity 2 for many
+    uint32_t levelVerbosity = (numSources == 1)?1:2;
+    uint64_t bytesFromDPUs = 0, bytesToDPUs = 0;
+    uint64_t totalLevels = 0;
+    uint64_t traversedEdges = 0; // Edges of the nodes reached by each traversal, summed over traversals
+
+    if(p.multiSource) {
+
+        // Multi-source BFS: every node carries a 64-bit mask of the traversals of the batch whose frontier holds it
+        uint64_t* multiSeen = malloc(numNodes*sizeof(uint64_t));
+        uint64_t* multiFrontier = malloc(numNodes*sizeof(uint64_t));
+        uint64_t* multiNext = malloc(numNodes*sizeof(uint64_t));
+        uint64_t* dpuMultiNext = malloc(numNodes*sizeof(uint64_t));
+        uint32_t* dpuDeltaNodes = malloc(multiDeltaCapacity*sizeof(uint32_t));
+        uint64_t* dpuDeltaMasks = malloc(multiDeltaCapacity*sizeof(uint64_t));
+        for(uint32_t batchStart = 0; batchStart < numSources; batchStart += MULTI_SOURCE_BATCH_SIZE) {
+            uint32_t batchSize = (batchStart + MULTI_SOURCE_BATCH_SIZE > numSources)?(numSources - batchStart):MULTI_SOURCE_BATCH_SIZE;
+            PRINT_INFO(p.verbosity >= 1, "Processing sources %u to %u", batchStart, batchStart + batchSize - 1);
+
+            // Start the traversals of the batch from their sources, counting the nodes each one reaches,
+            // the sum of their levels and the edges it traverses
+            uint32_t numReached[MULTI_SOURCE_BATCH_SIZE];
+            uint64_t levelSum[MULTI_SOURCE_BATCH_SIZE], edgeSum[MULTI_SOURCE_BATCH_SIZE];
+            memset(multiSeen, 0, numNodes*sizeof(uint64_t));
+            memset(multiFrontier, 0, numNodes*sizeof(uint64_t));
+            for(uint32_t k = 0; k < batchSize; ++k) {
+                uint32_t source = sources[batchStart + k];
+                setBit(multiSeen[source], k);
+                setBit(multiFrontier[source], k);
+                numReached[k] = 1;
+                levelSum[k] = 1;
+                edgeSum[k] = nodePtrs[source + 1] - nodePtrs[source];
             }
-        }
-        if(!nextFrontierEmpty) {
-            ++level;
+            uint32_t level = 1;
+            uint32_t frontierEmpty = 0;
+            startTimer(&timer);
             dpuIdx = 0;
             DPU_FOREACH (dpu_set, dpu) {
                 uint32_t dpuNumNodes = dpuParams[dpuIdx].dpuNumNodes;
                 if(dpuNumNodes > 0) {
-                    // Copy current frontier to all DPUs (place in next frontier and DPU will update visited and copy to current frontier)
-                    copyToDPU(dpu, (uint8_t*)currentFrontier, dpuParams[dpuIdx].dpuNextFrontier_m, numNodes/64*sizeof(uint64_t));
-                    // Copy new level to DPU
+                    copyToDPU(dpu, (uint8_t*)(multiFrontier + dpuParams[dpuIdx].dpuStartNodeIdx), dpuParams[dpuIdx].dpuMultiFrontier_m, dpuNumNodes*sizeof(uint64_t));
                     dpuParams[dpuIdx].level = level;
-                    copyToDPU(dpu, (uint8_t*)&dpuParams[dpuIdx], dpuParams_m[dpuIdx], sizeof(struct DPUParams));
-                    ++dpuIdx;
+                    dpuParams[dpuIdx].frontierFormat = FRONTIER_MULTI_SOURCE;
+                    copyToDPU(dpu, (uint8_t*)&dpuParams[dpuIdx], dpuParams_m, sizeof(struct DPUParams));
+                    bytesToDPUs += dpuNumNodes*sizeof(uint64_t) + ROUND_UP_TO_MULTIPLE_OF_8(sizeof(struct DPUParams));
                 }
+                ++dpuIdx;
             }
-        }
-        stopTimer(&timer);
-        hostTime += getElapsedTime(timer);
-        PRINT_INFO(p.verbosity >= 2, "    Level Inter-DPU Time: %f ms", getElapsedTime(timer)*1e3);
+            stopTimer(&timer);
+            hostTime += getElapsedTime(timer);
+
+            // Iterate until no traversal of the batch has a frontier
+            while(!frontierEmpty) {
+
+                PRINT_INFO(p.verbosity >= 2, "    Processing current frontiers for level %u", level);
+
+                #if ENERGY
+                DPU_ASSERT(dpu_probe_start(&probe));
+                #endif
+                startTimer(&timer);
+                DPU_ASSERT(dpu_launch(dpu_set, DPU_SYNCHRONOUS));
+                stopTimer(&timer);
+                dpuTime += getElapsedTime(timer);
+                #if ENERGY
+                DPU_ASSERT(dpu_probe_stop(&probe));
+                double energy;
+                DPU_ASSERT(dpu_probe_get(&probe, DPU_ENERGY, DPU_AVERAGE, &energy));
+                tenergy += energy;
+                #endif
+
+                // OR the next masks of all DPUs, each sending those of its own nodes and the delta list of the other
+                // nodes it reached (all next masks if the list overflowed), drop the traversals that already reached
+                // each node and send every DPU the masks of its own nodes
+                startTimer(&timer);
+                memset(multiNext, 0, numNodes*sizeof(uint64_t));
+                dpuIdx = 0;
+                DPU_FOREACH (dpu_set, dpu) {
+                    uint32_t dpuStartNodeIdx = dpuParams[dpuIdx].dpuStartNodeIdx;
+                    uint32_t dpuNumNodes = dpuParams[dpuIdx].dpuNumNodes;
+                    if(dpuNumNodes > 0) {
+                        uint32_t dpuDeltaSize;
+                        DPU_ASSERT(dpu_copy_from(dpu, "NEXT_FRONTIER_SIZE", 0, &dpuDeltaSize, sizeof(uint32_t)));
+                        bytesFromDPUs += sizeof(uint32_t);
+                        startTimer(&unionTimer);
+                        if(dpuDeltaSize <= multiDeltaCapacity) {
+                            copyFromDPU(dpu, dpuParams[dpuIdx].dpuMultiNext_m + dpuStartNodeIdx*sizeof(uint64_t), (uint8_t*)dpuMultiNext, dpuNumNodes*sizeof(uint64_t));
+                            bytesFromDPUs += dpuNumNodes*sizeof(uint64_t);
+                            orTiles(multiNext + dpuStartNodeIdx, dpuMultiNext, dpuNumNodes);
+                            if(dpuDeltaSize > 0) {
+                                copyFromDPU(dpu, dpuParams[dpuIdx].dpuMultiDeltaNodes_m, (uint8_t*)dpuDeltaNodes, dpuDeltaSize*sizeof(uint32_t));
+                                copyFromDPU(dpu, dpuParams[dpuIdx].dpuMultiDeltaMasks_m, (uint8_t*)dpuDeltaMasks, dpuDeltaSize*sizeof(uint64_t));
+                                bytesFromDPUs += ROUND_UP_TO_MULTIPLE_OF_8(dpuDeltaSize*sizeof(uint32_t)) + dpuDeltaSize*sizeof(uint64_t);
+                                for(uint32_t i = 0; i < dpuDeltaSize; ++i) {
+                                    multiNext[dpuDeltaNodes[i]] |= dpuDeltaMasks[i];
+                                }
+                            }
+                        } else {
+                            copyFromDPU(dpu, dpuParams[dpuIdx].dpuMultiNext_m, (uint8_t*)dpuMultiNext, numNodes*sizeof(uint64_t));
+                            bytesFromDPUs += numNodes*sizeof(uint64_t);
+                            #pragma omp parallel for
+                            for(uint32_t blockIdx = 0; blockIdx < numNodes; blockIdx += UNION_BLOCK_SIZE) {
+                                uint32_t numBlockNodes = (blockIdx + UNION_BLOCK_SIZE > numNodes)?(numNodes - blockIdx):UNION_BLOCK_SIZE;
+                                orTiles(multiNext + blockIdx, dpuMultiNext + blockIdx, numBlockNodes);
+                            }
+                        }
+                        stopTimer(&unionTimer);
+                        unionTime += getElapsedTime(unionTimer);
+                        dpuParams[dpuIdx].prevNextFrontierSize = dpuDeltaSize;
+                    }
+                    ++dpuIdx;
+                }
+                ++level;
+                frontierEmpty = 1;
+                for(uint32_t node = 0; node < numNodes; ++node) {
+                    uint64_t mask = multiNext[node] & ~multiSeen[node];
+                    multiFrontier[node] = mask;
+                    if(mask) {
+                        multiSeen[node] |= mask;
+                        frontierEmpty = 0;
+                        for(; mask; mask &= mask - 1) {
+                            uint32_t k = __builtin_ctzll(mask);
+                            ++numReached[k];
+                            levelSum[k] += level;
+                            edgeSum[k] += nodePtrs[node + 1] - nodePtrs[node];
+                        }
+                    }
+                }
+                if(!frontierEmpty) {
+                    dpuIdx = 0;
+                    DPU_FOREACH (dpu_set, dpu) {
+                        uint32_t dpuNumNodes = dpuParams[dpuIdx].dpuNumNodes;
+                        if(dpuNumNodes > 0) {
+                            copyToDPU(dpu, (uint8_t*)(multiFrontier + dpuParams[dpuIdx].dpuStartNodeIdx), dpuParams[dpuIdx].dpuMultiFrontier_m, dpuNumNodes*sizeof(uint64_t));
+                            dpuParams[dpuIdx].level = level;
+                            copyToDPU(dpu, (uint8_t*)&dpuParams[dpuIdx], dpuParams_m, sizeof(struct DPUParams));
+                            bytesToDPUs += dpuNumNodes*sizeof(uint64_t) + ROUND_UP_TO_MULTIPLE_OF_8(sizeof(struct DPUParams));
+                        }
+                        ++dpuIdx;
+                    }
+                }
+                stopTimer(&timer);
+                hostTime += getElapsedTime(timer);
 
-    }
-    PRINT_INFO(p.verbosity >= 1, "DPU Kernel Time: %f ms", dpuTime*1e3);
-    PRINT_INFO(p.verbosity >= 1, "Inter-DPU Time: %f ms", hostTime*1e3);
-    #if ENERGY
-    PRINT_INFO(p.verbosity >= 1, "    DPU Energy: %f J", tenergy);
-    #endif
+            }
+            totalLevels += level - 1;
+
+            // Verify the number of nodes each traversal reached and their levels against the CPU
+            for(uint32_t k = 0; k < batchSize; ++k) {
+                uint32_t source = sources[batchStart + k];
+                bfsReference(csrGraph, source, nodeLevelReference, visited, currentFrontier, nextFrontier);
+                uint32_t numReachedReference = 0;
+                uint64_t levelSumReference = 0;
+                for(uint32_t node = 0; node < numNodes; ++node) {
+                    numReachedReference += (nodeLevelReference[node] > 0);
+                    levelSumReference += nodeLevelReference[node];
+                }
+                if(numReached[k] != numReachedReference || levelSum[k] != levelSumReference) {
+                    PRINT_ERROR("Mismatch for source %u (CPU result = %u nodes reached with level sum %lu, DPU result = %u nodes reached with level sum %lu)",
+                            source, numReachedReference, (unsigned long)levelSumReference, numReached[k], (unsigned long)levelSum[k]);
+                }
+                PRINT_INFO(p.verbosity >= 2, "    Source %u reaches %u nodes with level sum %lu", source, numReached[k], (unsigned long)levelSum[k]);
+                traversedEdges += edgeSum[k];
+            }
 
-    // Copy back node levels
-    PRINT_INFO(p.verbosity >= 1, "Copying back the result");
-    startTimer(&timer);
-    dpuIdx = 0;
-    DPU_FOREACH (dpu_set, dpu) {
-        uint32_t dpuNumNodes = dpuParams[dpuIdx].dpuNumNodes;
-        if(dpuNumNodes > 0) {
-            uint32_t dpuStartNodeIdx = dpuIdx*numNodesPerDPU;
-            copyFromDPU(dpu, dpuParams[dpuIdx].dpuNodeLevel_m, (uint8_t*)(nodeLevel + dpuStartNodeIdx), dpuNumNodes*sizeof(float));
         }
-        ++dpuIdx;
-    }
-    stopTimer(&timer);
-    retrieveTime += getElapsedTime(timer);
-    PRINT_INFO(p.verbosity >= 1, "    DPU-CPU Time: %f ms", retrieveTime*1e3);
-    if(p.verbosity == 0) PRINT("CPU-DPU Time(ms): %f    DPU Kernel Time (ms): %f    Inter-DPU Time (ms): %f    DPU-CPU Time (ms): %f", loadTime*1e3, dpuTime*1e3, hostTime*1e3, retrieveTime*1e3);
-
-    // Calculating result on CPU
-    PRINT_INFO(p.verbosity >= 1, "Calculating result on CPU");
-    uint32_t* nodeLevelReference = calloc(numNodes, sizeof(uint32_t)); // Node's BFS level (initially all 0 meaning not reachable)
-    memset(nextFrontier, 0, numNodes/64*sizeof(uint64_t));
-    setBit(nextFrontier[0], 0); // Initialize frontier to first node
-    nextFrontierEmpty = 0;
-    level = 1;
-    while(!nextFrontierEmpty) {
-        // Update current frontier and visited list based on the next frontier from the previous iteration
-        for(uint32_t nodeTileIdx = 0; nodeTileIdx < numNodes/64; ++nodeTileIdx) {
-            uint64_t nextFrontierTile = nextFrontier[nodeTileIdx];
-            currentFrontier[nodeTileIdx] = nextFrontierTile;
-            if(nextFrontierTile) {
-                visited[nodeTileIdx] |= nextFrontierTile;
-                nextFrontier[nodeTileIdx] = 0;
-                for(uint32_t node = nodeTileIdx*64; node < (nodeTileIdx + 1)*64; ++node) {
-                    if(isSet(nextFrontierTile, node%64)) {
-                        nodeLevelReference[node] = level;
-                    }
+        free(multiSeen);
+        free(multiFrontier);
+        free(multiNext);
+        free(dpuMultiNext);
+        free(dpuDeltaNodes);
+        free(dpuDeltaMasks);
+
+    } else {
+
+        // One traversal at a time
+        for(uint32_t sourceIdx = 0; sourceIdx < numSources; ++sourceIdx) {
+
+            // Start the traversal from the source: the DPUs reset their visited nodes and levels at level 1
+            uint32_t source = sources[sourceIdx];
+            PRINT_INFO(p.verbosity >= 2, "Processing source %u", source);
+            memset(visited, 0, numNodes/64*sizeof(uint64_t));
+            setBit(visited[source/64], source%64);
+            frontierList[0] = source;
+            uint32_t frontierSize = 1;
+            uint32_t level = 1;
+            startTimer(&timer);
+            dpuIdx = 0;
+            DPU_FOREACH (dpu_set, dpu) {
+                if(dpuParams[dpuIdx].dpuNumNodes > 0) {
+                    copyToDPU(dpu, (uint8_t*)frontierList, dpuParams[dpuIdx].dpuFrontierList_m, frontierSize*sizeof(uint32_t));
+                    dpuParams[dpuIdx].level = level;
+                    dpuParams[dpuIdx].frontierFormat = FRONTIER_SPARSE;
+                    dpuParams[dpuIdx].frontierSize = frontierSize;
+                    copyToDPU(dpu, (uint8_t*)&dpuParams[dpuIdx], dpuParams_m, sizeof(struct DPUParams));
+                    bytesToDPUs += ROUND_UP_TO_MULTIPLE_OF_8(frontierSize*sizeof(uint32_t)) + ROUND_UP_TO_MULTIPLE_OF_8(sizeof(struct DPUParams));
                 }
+                ++dpuIdx;
             }
-        }
-        // Visit neighbors of the current frontier
-        nextFrontierEmpty = 1;
-        for(uint32_t nodeTileIdx = 0; nodeTileIdx < numNodes/64; ++nodeTileIdx) {
-            uint64_t currentFrontierTile = currentFrontier[nodeTileIdx];
-            if(currentFrontierTile) {
-                for(uint32_t node = nodeTileIdx*64; node < (nodeTileIdx + 1)*64; ++node) {
-                    if(isSet(currentFrontierTile, node%64)) { // If the node is in the current frontier
-                        // Visit its neighbors
-                        uint32_t nodePtr = nodePtrs[node];
-                        uint32_t nextNodePtr = nodePtrs[node + 1];
-                        for(uint32_t i = nodePtr; i < nextNodePtr; ++i) {
-                            uint32_t neighbor = neighborIdxs[i];
-                            if(!isSet(visited[neighbor/64], neighbor%64)) { // Neighbor not previously visited
-                                // Add neighbor to next frontier
-                                setBit(nextFrontier[neighbor/64], neighbor%64);
-                                nextFrontierEmpty = 0;
+            stopTimer(&timer);
+            hostTime += getElapsedTime(timer);
+
+            // Iterate until next frontier is empty
+            // The direction of each level follows Beamer et al.'s heuristic: go bottom-up once the frontier's edges exceed
+            // 1/alpha of the edges of unvisited nodes, and back top-down once the frontier has fewer than 1/beta of the nodes
+            // (smaller frontiers never go bottom-up, even when few edges are left to explore)
+            uint32_t bottomUp = 0;
+            uint64_t unexploredEdges = csrGraph.numEdges - (nodePtrs[source + 1] - nodePtrs[source]);
+            while(frontierSize > 0) {
+
+                PRINT_INFO(p.verbosity >= levelVerbosity, "Processing current frontier for level %u (%s)", level, bottomUp?"bottom-up":"top-down");
+
+                #if ENERGY
+                DPU_ASSERT(dpu_probe_start(&probe));
+                #endif
+                // Run all DPUs
+                PRINT_INFO(p.verbosity >= levelVerbosity, "    Booting DPUs");
+                startTimer(&timer);
+                DPU_ASSERT(dpu_launch(dpu_set, DPU_SYNCHRONOUS));
+                stopTimer(&timer);
+                float levelDPUTime = getElapsedTime(timer);
+                dpuTime += levelDPUTime;
+                PRINT_INFO(p.verbosity >= levelVerbosity, "    Level DPU Time: %f ms", levelDPUTime*1e3);
+                #if ENERGY
+                DPU_ASSERT(dpu_probe_stop(&probe));
+                double energy;
+                DPU_ASSERT(dpu_probe_get(&probe, DPU_ENERGY, DPU_AVERAGE, &energy));
+                tenergy += energy;
+                #endif
+
+                // Copy back the next frontier from all DPUs, as a list if it fits or else as a bit vector, and compute their union
+                startTimer(&timer);
+                uint64_t levelBytesFromDPUs = 0, levelBytesToDPUs = 0;
+                dpuIdx = 0;
+                DPU_FOREACH (dpu_set, dpu) {
+                    if(dpuParams[dpuIdx].dpuNumNodes > 0) {
+                        uint32_t dpuNextFrontierSize;
+                        DPU_ASSERT(dpu_copy_from(dpu, "NEXT_FRONTIER_SIZE", 0, &dpuNextFrontierSize, sizeof(uint32_t)));
+                        levelBytesFromDPUs += sizeof(uint32_t);
+                        uint8_t* dpuNextFrontier = (uint8_t*)(dpuNextFrontiers + (uint64_t)dpuIdx*numNodes/64);
+                        if(dpuNextFrontierSize <= frontierListCapacity) {
+                            if(dpuNextFrontierSize > 0) {
+                                copyFromDPU(dpu, dpuParams[dpuIdx].dpuNextFrontierList_m, dpuNextFrontier, dpuNextFrontierSize*sizeof(uint32_t));
+                                levelBytesFromDPUs += ROUND_UP_TO_MULTIPLE_OF_8(dpuNextFrontierSize*sizeof(uint32_t));
+                            }
+                        } else {
+                            copyFromDPU(dpu, dpuParams[dpuIdx].dpuNextFrontier_m, dpuNextFrontier, numNodes/64*sizeof(uint64_t));
+                            levelBytesFromDPUs += numNodes/64*sizeof(uint64_t);
+                        }
+                        dpuNextFrontierSizes[dpuIdx] = dpuNextFrontierSize;
+                        dpuParams[dpuIdx].prevNextFrontierSize = dpuNextFrontierSize;
+                    }
+                    ++dpuIdx;
+                }
+                startTimer(&unionTimer);
+                uint64_t frontierEdges;
+                frontierSize = unionFrontiers(csrGraph, currentFrontier, visited, dpuNextFrontiers, dpuNextFrontierSizes, numDPUs, frontierListCapacity, &frontierEdges);
+                stopTimer(&unionTimer);
+                float levelUnionTime = getElapsedTime(unionTimer);
+                unionTime += levelUnionTime;
+                unexploredEdges -= frontierEdges;
+
+                // Pick the direction of the next level
+                uint32_t levelBottomUp = bottomUp;
+                if(p.directionOptimizing) {
+                    if(!bottomUp && frontierEdges > unexploredEdges/p.alpha && frontierSize >= numNodes/p.beta) {
+                        bottomUp = 1;
+                    } else if(bottomUp && frontierSize < numNodes/p.beta) {
+                        bottomUp = 0;
+                    }
+                }
+
+                // Send the frontier to the DPUs if it is not empty: bottom-up levels need the whole bit vector, top-down
+                // levels the whole frontier as a list to every DPU if that moves fewer bytes than sending each DPU its own
+                // slice of the bit vector
+                uint32_t frontierFormat = bottomUp?FRONTIER_BITMAP:FRONTIER_DENSE;
+                if(frontierSize > 0) {
+                    ++level;
+                    if(!bottomUp && (uint64_t)frontierSize*sizeof(uint32_t)*numActiveDPUs <= numNodes/64*sizeof(uint64_t)) {
+                        frontierFormat = FRONTIER_SPARSE;
+                        uint32_t listIdx = 0;
+                        for(uint32_t i = 0; i < numNodes/64; ++i) {
+                            for(uint64_t tile = currentFrontier[i]; tile; tile &= tile - 1) {
+                                frontierList[listIdx++] = i*64 + __builtin_ctzll(tile);
+                            }
+                        }
+                    }
+                    dpuIdx = 0;
+                    DPU_FOREACH (dpu_set, dpu) {
+                        uint32_t dpuNumNodes = dpuParams[dpuIdx].dpuNumNodes;
+                        if(dpuNumNodes > 0) {
+                            if(frontierFormat == FRONTIER_SPARSE) {
+                                copyToDPU(dpu, (uint8_t*)frontierList, dpuParams[dpuIdx].dpuFrontierList_m, frontierSize*sizeof(uint32_t));
+                                levelBytesToDPUs += ROUND_UP_TO_MULTIPLE_OF_8(frontierSize*sizeof(uint32_t));
+                            } else if(frontierFormat == FRONTIER_BITMAP) {
+                                copyToDPU(dpu, (uint8_t*)currentFrontier, dpuParams[dpuIdx].dpuFrontierList_m, numNodes/64*sizeof(uint64_t));
+                                levelBytesToDPUs += numNodes/64*sizeof(uint64_t);
+                            } else {
+                                uint32_t dpuStartNodeIdx = dpuParams[dpuIdx].dpuStartNodeIdx;
+                                copyToDPU(dpu, (uint8_t*)(currentFrontier + dpuStartNodeIdx/64), dpuParams[dpuIdx].dpuCurrentFrontier_m, dpuNumNodes/64*sizeof(uint64_t));
+                                levelBytesToDPUs += dpuNumNodes/64*sizeof(uint64_t);
                             }
+                            // Copy new level and frontier format to DPU
+                            dpuParams[dpuIdx].level = level;
+                            dpuParams[dpuIdx].frontierFormat = frontierFormat;
+                            dpuParams[dpuIdx].frontierSize = frontierSize;
+                            copyToDPU(dpu, (uint8_t*)&dpuParams[dpuIdx], dpuParams_m, sizeof(struct DPUParams));
+                            levelBytesToDPUs += ROUND_UP_TO_MULTIPLE_OF_8(sizeof(struct DPUParams));
                         }
+                        ++dpuIdx;
                     }
                 }
+                stopTimer(&timer);
+                hostTime += getElapsedTime(timer);
+                bytesFromDPUs += levelBytesFromDPUs;
+                bytesToDPUs += levelBytesToDPUs;
+                PRINT_INFO(p.verbosity >= 2, "    Level Inter-DPU Time: %f ms (frontier union: %f ms)", getElapsedTime(timer)*1e3, levelUnionTime*1e3);
+                PRINT_INFO(p.verbosity >= 2, "    Level frontier exchange: %u nodes sent as %s, %lu bytes DPU-CPU, %lu bytes CPU-DPU",
+                        frontierSize, (frontierSize == 0)?"-":(frontierFormat == FRONTIER_SPARSE)?"list":"bit vector", (unsigned long)levelBytesFromDPUs, (unsigned long)levelBytesToDPUs);
+                if(p.verbosity == 0 && numSources == 1) PRINT("Level %u %s DPU Time (ms): %f    Inter-DPU Time (ms): %f    Union Time (ms): %f", level - (frontierSize > 0), levelBottomUp?"bottom-up":"top-down", levelDPUTime*1e3, getElapsedTime(timer)*1e3, levelUnionTime*1e3);
+
+            }
+            totalLevels += level;
+
+            // Copy back node levels
+            PRINT_INFO(p.verbosity >= levelVerbosity, "Copying back the result");
+            startTimer(&timer);
+            dpuIdx = 0;
+            DPU_FOREACH (dpu_set, dpu) {
+                uint32_t dpuNumNodes = dpuParams[dpuIdx].dpuNumNodes;
+                if(dpuNumNodes > 0) {
+                    uint32_t dpuStartNodeIdx = dpuParams[dpuIdx].dpuStartNodeIdx;
+                    copyFromDPU(dpu, dpuParams[dpuIdx].dpuNodeLevel_m, (uint8_t*)(nodeLevel + dpuStartNodeIdx), dpuNumNodes*sizeof(uint32_t));
+                }
+                ++dpuIdx;
             }
+            stopTimer(&timer);
+            retrieveTime += getElapsedTime(timer);
+
+            // Calculating result on CPU and verifying the result
+            PRINT_INFO(p.verbosity >= levelVerbosity, "Calculating result on CPU");
+            bfsReference(csrGraph, source, nodeLevelReference, visited, currentFrontier, nextFrontier);
+            PRINT_INFO(p.verbosity >= levelVerbosity, "Verifying the result");
+            for(uint32_t nodeIdx = 0; nodeIdx < numNodes; ++nodeIdx) {
+                if(nodeLevel[nodeIdx] != nodeLevelReference[nodeIdx]) {
+                    PRINT_ERROR("Mismatch for source %u at node %u (CPU result = level %u, DPU result = level %u)", source, nodeIdx, nodeLevelReference[nodeIdx], nodeLevel[nodeIdx]);
+                }
+                if(nodeLevel[nodeIdx] > 0) {
+                    traversedEdges += nodePtrs[nodeIdx + 1] - nodePtrs[nodeIdx];
+                }
+            }
+
         }
-        ++level;
+
     }
 
-    // Verify the result
-    PRINT_INFO(p.verbosity >= 1, "Verifying the result");
-    for(uint32_t nodeIdx = 0; nodeIdx < numNodes; ++nodeIdx) {
-        if(nodeLevel[nodeIdx] != nodeLevelReference[nodeIdx]) {
-            PRINT_ERROR("Mismatch at node %u (CPU result = level %u, DPU result = level %u)", nodeIdx, nodeLevelReference[nodeIdx], nodeLevel[nodeIdx]);
-        }
+    PRINT_INFO(p.verbosity >= 1, "DPU Kernel Time: %f ms", dpuTime*1e3);
+    PRINT_INFO(p.verbosity >= 1, "Inter-DPU Time: %f ms", hostTime*1e3);
+    PRINT_INFO(p.verbosity >= 1, "    Frontier union Time: %f ms", unionTime*1e3);
+    if(p.multiSource) {
+        PRINT_INFO(p.verbosity >= 1, "    Frontier exchange: %lu bytes DPU-CPU, %lu bytes CPU-DPU", (unsigned long)bytesFromDPUs, (unsigned long)bytesToDPUs);
+    } else {
+        PRINT_INFO(p.verbosity >= 1, "    Frontier exchange: %lu bytes DPU-CPU, %lu bytes CPU-DPU (full bit vector exchange: %lu bytes each way)",
+                (unsigned long)bytesFromDPUs, (unsigned long)bytesToDPUs, (unsigned long)totalLevels*numActiveDPUs*(numNodes/64*sizeof(uint64_t)));
+        PRINT_INFO(p.verbosity >= 1, "DPU-CPU Time: %f ms", retrieveTime*1e3);
     }
+    #if ENERGY
+    PRINT_INFO(p.verbosity >= 1, "    DPU Energy: %f J", tenergy);
+    #endif
+
+    // Throughput of the traversals, once the graph is on the DPUs
+    float traversalTime = dpuTime + hostTime;
+    PRINT_INFO(p.verbosity >= 1, "Traversals: %u, %lu edges traversed", numSources, (unsigned long)traversedEdges);
+    PRINT_INFO(p.verbosity >= 1, "    Traversals/sec: %f", numSources/traversalTime);
+    PRINT_INFO(p.verbosity >= 1, "    TEPS: %f", traversedEdges/traversalTime);
+    if(p.verbosity == 0) PRINT("CPU-DPU Time(ms): %f    DPU Kernel Time (ms): %f    Inter-DPU Time (ms): %f    Union Time (ms): %f    DPU-CPU Time (ms): %f", loadTime*1e3, dpuTime*1e3, hostTime*1e3, unionTime*1e3, retrieveTime*1e3);
+    if(p.verbosity == 0) PRINT("Traversals: %u    Traversals/sec: %f    TEPS: %f", numSources, numSources/traversalTime, traversedEdges/traversalTime);
 
     // Display DPU Logs
     if(p.verbosity >= 2) {
@@ -314,13 +753,16 @@ int main(int argc, char** argv) {
     // Deallocate data structures
     freeCOOGraph(cooGraph);
     freeCSRGraph(csrGraph);
+    free(sources);
     free(nodeLevel);
     free(visited);
     free(currentFrontier);
     free(nextFrontier);
+    free(frontierList);
     free(nodeLevelReference);
+    free(dpuNextFrontiers);
+    free(dpuNextFrontierSizes);
 
     return 0;
 
 }
-
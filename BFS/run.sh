@@ -0,0 +1,28 @@
+#!/bin/bash
+
+# Tasklet scaling of the DPU kernel with a single next frontier lock and with lock striping
+mkdir -p profile
+for i in 1
+do
+	for l in 1 8
+	do
+		for k in 1 2 4 8 16
+		do
+			NR_DPUS=$i NR_TASKLETS=$k NR_FRONTIER_LOCKS=$l make all
+			wait
+			./bin/host_code -v 0 -f data/loc-gowalla_edges.txt > profile/BFS_locks${l}_tl${k}_dpu${i}.txt
+			wait
+			make clean
+			wait
+		done
+	done
+done
+
+# Summary: DPU kernel time per configuration
+for l in 1 8
+do
+	for k in 1 2 4 8 16
+	do
+		echo "NR_FRONTIER_LOCKS=$l NR_TASKLETS=$k $(grep -o 'DPU Kernel Time (ms): [0-9.]*' profile/BFS_locks${l}_tl${k}_dpu1.txt)"
+	done
+done
@@ -5,21 +5,76 @@
 #define ROUND_UP_TO_MULTIPLE_OF_8(x)    ((((x) + 7)/8)*8)
 #define ROUND_UP_TO_MULTIPLE_OF_64(x)   ((((x) + 63)/64)*64)
 
-#define setBit(val, idx) (val) |= (1 << (idx))
-#define isSet(val, idx)  ((val) & (1 << (idx)))
+// Number of neighbor indexes (even) and node pointers (even, at least 4) fetched per MRAM read by the DPU kernel
+#ifndef NEIGHBOR_BLOCK_SIZE
+#define NEIGHBOR_BLOCK_SIZE 64
+#endif
+#ifndef NODE_PTR_BLOCK_SIZE
+#define NODE_PTR_BLOCK_SIZE 32
+#endif
+
+// Number of frontier bitmap tiles (64 nodes each) the DPU kernel reads or writes per MRAM access when scanning bitmaps
+// or clearing MRAM (at most 256)
+#ifndef FRONTIER_BLOCK_SIZE
+#define FRONTIER_BLOCK_SIZE 32
+#endif
+
+// Number of mutexes guarding the next frontier tiles in the DPU kernel (tiles are striped across them)
+#ifndef NR_FRONTIER_LOCKS
+#define NR_FRONTIER_LOCKS 8
+#endif
+
+// Number of discovered nodes each tasklet buffers in WRAM before appending them to the next frontier list (even)
+#ifndef FRONTIER_BUFFER_SIZE
+#define FRONTIER_BUFFER_SIZE 16
+#endif
+
+#define setBit(val, idx) (val) |= (1ULL << (idx))
+#define isSet(val, idx)  ((val) & (1ULL << (idx)))
+
+// Frontier formats sent by the host each level: a sorted list of nodes, or each DPU's slice of the bitmap for
+// top-down levels, and the whole bitmap (in the frontier list buffer, which has the same size) for bottom-up levels
+#define FRONTIER_SPARSE 0
+#define FRONTIER_DENSE  1
+#define FRONTIER_BITMAP 2
+// Multi-source BFS: a 64-bit mask per node of the concurrent traversals whose frontier holds it, own nodes' masks in
+// dpuMultiFrontier_m, and the DPU ORs each frontier node's mask into its neighbors' masks in dpuMultiNext_m.
+// The host reads back the next masks of the DPU's own nodes and, for the other nodes, the delta list of those
+// whose mask the level set (dpuMultiDeltaNodes_m, their masks in dpuMultiDeltaMasks_m)
+#define FRONTIER_MULTI_SOURCE 3
+
+// Number of traversals run concurrently by multi-source BFS (one bit of a uint64_t mask each)
+#define MULTI_SOURCE_BATCH_SIZE 64
+
+// Delta lists hold at most an eighth of the nodes, beyond which the host reads back all the next masks
+#define MULTI_SOURCE_DELTA_CAPACITY(numNodes) ((numNodes)/8)
+
+// Frontier lists hold at most as many nodes as fit in the bytes of the bitmap, beyond which the bitmap is smaller
+#define FRONTIER_LIST_CAPACITY(numNodes) ((numNodes)/32)
 
 struct DPUParams {
     uint32_t dpuNumNodes; /* The number of nodes assigned to this DPU */
     uint32_t numNodes; /* Total number of nodes in the graph  */
     uint32_t dpuStartNodeIdx; /* The index of the first node assigned to this DPU  */
     uint32_t dpuNodePtrsOffset; /* Offset of the node pointers */
-    uint32_t level; /* The current BFS level */
+    uint32_t level; /* The current BFS level, a new traversal starts at level 1 */
     uint32_t dpuNodePtrs_m;
     uint32_t dpuNeighborIdxs_m;
     uint32_t dpuNodeLevel_m;
     uint32_t dpuVisited_m;
     uint32_t dpuCurrentFrontier_m;
     uint32_t dpuNextFrontier_m;
+    uint32_t frontierFormat; /* FRONTIER_SPARSE: list in dpuFrontierList_m, FRONTIER_DENSE: own nodes' bitmap in dpuCurrentFrontier_m,
+                                FRONTIER_BITMAP: whole bitmap in dpuFrontierList_m, expanded bottom-up,
+                                FRONTIER_MULTI_SOURCE: own nodes' traversal masks in dpuMultiFrontier_m */
+    uint32_t frontierSize; /* Number of nodes in the frontier list */
+    uint32_t prevNextFrontierSize; /* Next frontier (or delta list) size of the previous level, to clear only what it wrote */
+    uint32_t dpuFrontierList_m;
+    uint32_t dpuNextFrontierList_m;
+    uint32_t dpuMultiFrontier_m;
+    uint32_t dpuMultiNext_m;
+    uint32_t dpuMultiDeltaNodes_m;
+    uint32_t dpuMultiDeltaMasks_m;
 };
 
 #endif
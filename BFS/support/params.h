@@ -10,6 +10,14 @@ static void usage() {
             "\n"
             "\nBenchmark-specific options:"
             "\n    -f <F>    input matrix file name (default=data/roadNet-CA.txt)"
+            "\n    -d <D>    direction: 0=top-down only, 1=direction-optimizing, for undirected graphs, top-down only on directed ones (default=0)"
+            "\n    -a <A>    switch to bottom-up when the frontier has more than 1/A of the unexplored edges (default=14)"
+            "\n    -b <B>    switch back to top-down when the frontier has fewer than 1/B of the nodes (default=24)"
+            "\n    -s <S>    file with the source nodes, one per line (default=none)"
+            "\n    -n <N>    number of sources without a source file: node 0, then random nodes with edges (default=1)"
+            "\n    -m <M>    0=one traversal at a time, 1=batches of 64 concurrent traversals (multi-source BFS) (default=0)"
+            "\n    -p <P>    partitioning across DPUs: 0=equal node counts, 1=balanced edge counts (default=0)"
+            "\n    -t <T>    number of threads of the CPU baseline (default=0, meaning OMP_NUM_THREADS or all cores)"
             "\n"
             "\nGeneral options:"
             "\n    -v <V>    verbosity"
@@ -19,17 +27,41 @@ static void usage() {
 
 typedef struct Params {
   const char* fileName;
+  unsigned int directionOptimizing;
+  unsigned int alpha;
+  unsigned int beta;
+  const char* sourceFileName;
+  unsigned int numSources;
+  unsigned int multiSource;
+  unsigned int edgeBalanced;
+  unsigned int numThreads;
   unsigned int verbosity;
 } Params;
 
 static struct Params input_params(int argc, char **argv) {
     struct Params p;
     p.fileName      = "data/roadNet-CA.txt";
+    p.directionOptimizing = 0;
+    p.alpha         = 14;
+    p.beta          = 24;
+    p.sourceFileName = NULL;
+    p.numSources    = 1;
+    p.multiSource   = 0;
+    p.edgeBalanced  = 0;
+    p.numThreads    = 0;
     p.verbosity     = 1;
     int opt;
-    while((opt = getopt(argc, argv, "f:v:h")) >= 0) {
+    while((opt = getopt(argc, argv, "f:d:a:b:s:n:m:p:t:v:h")) >= 0) {
         switch(opt) {
             case 'f': p.fileName    = optarg;       break;
+            case 'd': p.directionOptimizing = atoi(optarg); break;
+            case 'a': p.alpha       = atoi(optarg); break;
+            case 'b': p.beta        = atoi(optarg); break;
+            case 's': p.sourceFileName = optarg;    break;
+            case 'n': p.numSources  = atoi(optarg); break;
+            case 'm': p.multiSource = atoi(optarg); break;
+            case 'p': p.edgeBalanced = atoi(optarg); break;
+            case 't': p.numThreads  = atoi(optarg); break;
             case 'v': p.verbosity   = atoi(optarg); break;
             case 'h': usage(); exit(0);
             default:
@@ -39,6 +71,9 @@ static struct Params input_params(int argc, char **argv) {
         }
     }
 
+    assert(p.alpha > 0 && p.beta > 0 && "Invalid direction switching thresholds!");
+    assert(p.numSources > 0 && "Invalid # of sources!");
+
     return p;
 }
 
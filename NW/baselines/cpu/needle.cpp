@@ -4,6 +4,7 @@
 #include <stdio.h>
 #include <string.h>
 #include <math.h>
+#include <stdint.h>
 #include <sys/time.h>
 #include <omp.h>
 #define OPENMP
@@ -93,10 +94,11 @@ main( int argc, char** argv)
 
 void usage(int argc, char **argv)
 {
-    fprintf(stderr, "Usage: %s <max_rows/max_cols> <penalty> <num_threads>\n", argv[0]);
-    fprintf(stderr, "\t<dimension>      - x and y dimensions\n");
+    fprintf(stderr, "Usage: %s <max_rows/max_cols> <penalty> <num_threads> [<pairs>]\n", argv[0]);
+    fprintf(stderr, "\t<dimension>      - x and y dimensions (maximum sequence length of the batch version)\n");
     fprintf(stderr, "\t<penalty>        - penalty(positive integer)\n");
     fprintf(stderr, "\t<num_threads>    - no. of threads\n");
+    fprintf(stderr, "\t<pairs>          - no. of sequence pairs (batch version, score only)\n");
     exit(1);
 }
 
@@ -231,6 +233,238 @@ void nw_optimized(int *input_itemsets, int *output_itemsets, int *referrence,
 
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// Batch version: many short pairs, score only
+////////////////////////////////////////////////////////////////////////////////
+
+// Largest BLOSUM62 score
+#define BLOSUM62_MAX 11
+// 16-bit lanes of the striped version (a 256-bit vector)
+#define STRIPED_LANES 16
+
+// Batch version: pairs of similar sequences, generated as in the DPU batch mode (B is A with random substitutions,
+// insertions and deletions). Pair k has sequence A at seqs[2*k*max_len] and sequence B max_len bytes later
+void generate_pairs(unsigned char *seqs, int *lengths, int n_pairs, int max_len)
+{
+    srand(7);
+    for (int k = 0; k < n_pairs; k++)
+    {
+        unsigned char *seq_a = seqs + (long long) k * 2 * max_len;
+        unsigned char *seq_b = seq_a + max_len;
+        int len_a = max_len / 2 + rand() % (max_len - max_len / 2 + 1);
+        int len_b = 0;
+        for (int i = 0; i < len_a; i++)
+            seq_a[i] = rand() % 10 + 1;
+        for (int i = 0; i < len_a && len_b < max_len; i++)
+        {
+            int r = rand() % 100;
+            if (r < 3) // Deletion
+                continue;
+            if (r < 6 && len_b < max_len - 1) // Insertion
+                seq_b[len_b++] = rand() % 10 + 1;
+            seq_b[len_b++] = (r >= 6 && r < 10) ? rand() % 10 + 1 : seq_a[i]; // Substitution or copy
+        }
+        lengths[2*k] = len_a;
+        lengths[2*k + 1] = len_b;
+    }
+}
+
+// Batch version: score of the global alignment of a pair, a row at a time with 32-bit scores
+int nw_pair_scalar(const unsigned char *seq_a, int len_a, const unsigned char *seq_b, int len_b, int penalty, int *row)
+{
+    for (int j = 0; j <= len_b; j++)
+        row[j] = -j * penalty;
+    for (int i = 1; i <= len_a; i++)
+    {
+        int diag = row[0];
+        int *sub = blosum62[seq_a[i - 1]];
+        row[0] = -i * penalty;
+        for (int j = 1; j <= len_b; j++)
+        {
+            int up = row[j];
+            row[j] = maximum(diag + sub[seq_b[j - 1]], row[j - 1] - penalty, up - penalty);
+            diag = up;
+        }
+    }
+    return row[len_b];
+}
+
+// Batch version: score of the global alignment of a pair with striped SIMD and 16-bit lanes. Sequence B lies along
+// the lanes, column j + 1 of the matrix at [(j % segments)*STRIPED_LANES + j / segments] of a row, so a query profile
+// gives the substitution scores of a row without gathers. The left neighbours are resolved by a scan, as in Farrar's
+// striped method without its data-dependent lazy-F loop: within the lanes, then from each lane to the next, then
+// within the lanes again. Scores are kept relative to the middle of their range; returns false if the range does not
+// fit 16 bits. profile holds 24 rows and rows 2 rows of segments * STRIPED_LANES values
+bool nw_pair_striped(const unsigned char *seq_a, int len_a, const unsigned char *seq_b, int len_b, int penalty,
+        int16_t *profile, int16_t *rows, int *score)
+{
+    if (len_a == 0 || len_b == 0)
+    {
+        *score = -(len_a + len_b) * penalty;
+        return true;
+    }
+    int segments = (len_b + STRIPED_LANES - 1) / STRIPED_LANES;
+    int width = segments * STRIPED_LANES;
+
+    // Scores are at least -(i + j)*penalty (all gaps) and at most BLOSUM62_MAX * min(i, j)
+    long long lowest = -(long long) (len_a + width) * penalty;
+    long long highest = (long long) BLOSUM62_MAX * ((len_a < width) ? len_a : width);
+    if (highest - lowest + 4 * (penalty + BLOSUM62_MAX) > INT16_MAX - INT16_MIN)
+        return false;
+    int bias = (int) ((lowest + highest) / 2);
+    const int16_t minus_inf = INT16_MIN + penalty;
+
+    // Query profile: the score of each residue of A against the columns, in striped order (padding columns mismatch)
+    bool used[24] = {false};
+    for (int i = 0; i < len_a; i++)
+        used[seq_a[i]] = true;
+    for (int c = 0; c < 24; c++)
+    {
+        if (!used[c])
+            continue;
+        for (int s = 0; s < segments; s++)
+            for (int k = 0; k < STRIPED_LANES; k++)
+            {
+                int j = k * segments + s;
+                profile[c * width + s * STRIPED_LANES + k] = (j < len_b) ? blosum62[c][seq_b[j]] : -BLOSUM62_MAX;
+            }
+    }
+
+    int16_t *previous = rows;
+    int16_t *current = rows + width;
+    for (int s = 0; s < segments; s++)
+        for (int k = 0; k < STRIPED_LANES; k++)
+            previous[s * STRIPED_LANES + k] = -(k * segments + s + 1) * penalty - bias;
+
+    for (int i = 1; i <= len_a; i++)
+    {
+        const int16_t *profile_row = profile + seq_a[i - 1] * width;
+        int16_t diag[STRIPED_LANES] __attribute__ ((aligned (32)));
+        int16_t f[STRIPED_LANES] __attribute__ ((aligned (32)));
+
+        // Up and diagonal neighbours. The first segment takes its diagonal neighbours from the last segment of the
+        // previous row shifted by a lane, lane 0 from the first column. f gathers the gaps leaving the end of each lane
+        diag[0] = -(i - 1) * penalty - bias;
+        f[0] = minus_inf;
+        for (int k = 1; k < STRIPED_LANES; k++)
+        {
+            diag[k] = previous[(segments - 1) * STRIPED_LANES + k - 1];
+            f[k] = minus_inf;
+        }
+        for (int s = 0; s < segments; s++)
+        {
+            const int16_t *up_s = previous + s * STRIPED_LANES;
+            const int16_t *profile_s = profile_row + s * STRIPED_LANES;
+            int16_t *h_s = current + s * STRIPED_LANES;
+#pragma omp simd aligned(diag, f : 32)
+            for (int k = 0; k < STRIPED_LANES; k++)
+            {
+                int16_t match = diag[k] + profile_s[k];
+                int16_t up = up_s[k] - penalty;
+                int16_t h = (match > up) ? match : up;
+                diag[k] = up_s[k];
+                h_s[k] = h;
+                f[k] = ((f[k] > h) ? f[k] : h) - penalty;
+            }
+        }
+
+        // Left neighbours entering each lane: from the first column and the ends of the previous lanes
+        int16_t entering = -i * penalty - bias - penalty;
+        for (int k = 0; k < STRIPED_LANES; k++)
+        {
+            int16_t leaving = f[k];
+            f[k] = entering;
+            entering -= segments * penalty;
+            entering = (leaving > entering) ? leaving : entering;
+        }
+
+        // Left neighbours within the lanes
+        for (int s = 0; s < segments; s++)
+        {
+            int16_t *h_s = current + s * STRIPED_LANES;
+#pragma omp simd aligned(f : 32)
+            for (int k = 0; k < STRIPED_LANES; k++)
+            {
+                int16_t h = (h_s[k] > f[k]) ? h_s[k] : f[k];
+                h_s[k] = h;
+                f[k] = h - penalty;
+            }
+        }
+
+        int16_t *rotate = previous;
+        previous = current;
+        current = rotate;
+    }
+    *score = previous[((len_b - 1) % segments) * STRIPED_LANES + (len_b - 1) / segments] + bias;
+    return true;
+}
+
+// Batch version: align n_pairs pairs of sequences of at most max_len residues, the pairs split among the threads,
+// with 32-bit rows and with the striped 16-bit version (falling back to 32-bit rows for the pairs that do not fit)
+void runBatch(int max_len, int penalty, int n_pairs)
+{
+    unsigned char *seqs = (unsigned char *) malloc((long long) n_pairs * 2 * max_len);
+    int *lengths = (int *) malloc(2 * n_pairs * sizeof(int));
+    int *scores = (int *) malloc(n_pairs * sizeof(int));
+    int *scores_simd = (int *) malloc(n_pairs * sizeof(int));
+    generate_pairs(seqs, lengths, n_pairs, max_len);
+    long long cells = 0;
+    for (int k = 0; k < n_pairs; k++)
+        cells += (long long) lengths[2*k] * lengths[2*k + 1];
+    printf("Batch of %d pairs of at most %d residues\n", n_pairs, max_len);
+
+    long long start_time = get_time();
+#pragma omp parallel
+    {
+        int *row = (int *) malloc((max_len + 1) * sizeof(int));
+#pragma omp for schedule(dynamic, 64)
+        for (int k = 0; k < n_pairs; k++)
+        {
+            const unsigned char *seq_a = seqs + (long long) k * 2 * max_len;
+            scores[k] = nw_pair_scalar(seq_a, lengths[2*k], seq_a + max_len, lengths[2*k + 1], penalty, row);
+        }
+        free(row);
+    }
+    long long end_time = get_time();
+    printf("32-bit rows: %.3f seconds, %.3f GCUPS\n", ((float) (end_time - start_time)) / (1000*1000), (double) cells / ((end_time - start_time) * 1000.0));
+
+    int fallbacks = 0;
+    start_time = get_time();
+#pragma omp parallel reduction(+:fallbacks)
+    {
+        int *row = (int *) malloc((max_len + 1) * sizeof(int));
+        int width = (max_len + STRIPED_LANES - 1) / STRIPED_LANES * STRIPED_LANES;
+        int16_t *profile = (int16_t *) malloc(24 * width * sizeof(int16_t));
+        int16_t *rows = (int16_t *) malloc(2 * width * sizeof(int16_t));
+#pragma omp for schedule(dynamic, 64)
+        for (int k = 0; k < n_pairs; k++)
+        {
+            const unsigned char *seq_a = seqs + (long long) k * 2 * max_len;
+            if (!nw_pair_striped(seq_a, lengths[2*k], seq_a + max_len, lengths[2*k + 1], penalty, profile, rows, &scores_simd[k]))
+            {
+                scores_simd[k] = nw_pair_scalar(seq_a, lengths[2*k], seq_a + max_len, lengths[2*k + 1], penalty, row);
+                fallbacks++;
+            }
+        }
+        free(row);
+        free(profile);
+        free(rows);
+    }
+    end_time = get_time();
+    printf("16-bit striped: %.3f seconds, %.3f GCUPS (%d pairs fell back to 32-bit rows)\n", ((float) (end_time - start_time)) / (1000*1000), (double) cells / ((end_time - start_time) * 1000.0), fallbacks);
+
+    int errors = 0;
+    for (int k = 0; k < n_pairs; k++)
+        errors += (scores[k] != scores_simd[k]);
+    if (errors)
+        printf("Mismatch: %d of %d scores differ\n", errors, n_pairs);
+
+    free(seqs);
+    free(lengths);
+    free(scores);
+    free(scores_simd);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 //! Run a simple test for CUDA
 ////////////////////////////////////////////////////////////////////////////////
@@ -246,7 +480,7 @@ runTest( int argc, char** argv)
 
     // the lengths of the two sequences should be able to divided by 16.
     // And at current stage  max_rows needs to equal max_cols
-    if (argc == 4)
+    if (argc == 4 || argc == 5)
     {
         max_rows = atoi(argv[1]);
         max_cols = atoi(argv[1]);
@@ -256,6 +490,14 @@ runTest( int argc, char** argv)
     else{
         usage(argc, argv);
     }
+    omp_set_num_threads(omp_num_threads);
+
+    if (argc == 5)
+    {
+        printf("Num of threads: %d\n", omp_num_threads);
+        runBatch(max_rows, penalty, atoi(argv[4]));
+        return;
+    }
 
     max_rows = max_rows + 1;
     max_cols = max_cols + 1;
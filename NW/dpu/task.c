@@ -3,6 +3,7 @@
 *
 */
 #include <stdint.h>
+#include <stdbool.h>
 #include <stdio.h>
 #include <defs.h>
 #include <mram.h>
@@ -17,6 +18,243 @@ __host dpu_arguments_t DPU_INPUT_ARGUMENTS;
 // Barrier
 BARRIER_INIT(my_barrier, NR_TASKLETS);
 
+// Batch mode: align whole independent pairs, pair k on tasklet k % NR_TASKLETS.
+// Scores are computed a row at a time in WRAM, the traceback direction of every cell is stored
+// in the tasklet's MRAM scratch matrix, and the traceback walks it back from the bottom-right cell.
+static void nw_batch(uint32_t npairs, uint32_t slots, int32_t penalty) {
+    unsigned int tasklet_id = me();
+    int32_t *row = mem_alloc((BATCH_MAX_LEN + 1) * sizeof(int32_t));
+    uint8_t *seq_a = mem_alloc(BATCH_SEQ_SLOT);
+    uint8_t *seq_b = mem_alloc(BATCH_SEQ_SLOT);
+    char *dir_row = mem_alloc(BATCH_DIR_STRIDE);
+    char *ops = mem_alloc(BATCH_TRACEBACK_SLOT);
+    uint64_t *cache = mem_alloc(sizeof(uint64_t));
+    pair_lengths_t *lengths = mem_alloc(sizeof(pair_lengths_t));
+    pair_result_t *result = mem_alloc(sizeof(pair_result_t));
+
+    uint32_t mram_base_addr_input = (uint32_t) DPU_MRAM_HEAP_POINTER;
+    uint32_t mram_base_addr_output = mram_base_addr_input + BATCH_INPUT_SIZE(slots);
+    uint32_t mram_base_addr_dirs = mram_base_addr_output + BATCH_OUTPUT_SIZE(slots) + tasklet_id * (BATCH_MAX_LEN + 1) * BATCH_DIR_STRIDE;
+
+    for (uint32_t k = tasklet_id; k < npairs; k += NR_TASKLETS) {
+        // Move the pair from MRAM to WRAM
+        mram_read((__mram_ptr void const *) (mram_base_addr_input + k * sizeof(pair_lengths_t)), lengths, sizeof(pair_lengths_t));
+        uint32_t len_a = lengths->len_a;
+        uint32_t len_b = lengths->len_b;
+        uint32_t addr_seq = mram_base_addr_input + slots * sizeof(pair_lengths_t) + k * 2 * BATCH_SEQ_SLOT;
+        mram_read((__mram_ptr void const *) addr_seq, seq_a, BATCH_SEQ_SLOT);
+        mram_read((__mram_ptr void const *) (addr_seq + BATCH_SEQ_SLOT), seq_b, BATCH_SEQ_SLOT);
+
+        // First row
+        for (uint32_t j = 0; j <= len_b; j++) {
+            row[j] = -(int32_t) j * penalty;
+            dir_row[j] = OP_DELETE;
+        }
+        mram_write(dir_row, (__mram_ptr void *) mram_base_addr_dirs, ROUND_UP_TO_MULTIPLE_OF_8(len_b + 1));
+
+        // Computation: the diagonal move wins ties, then the move up
+        for (uint32_t i = 1; i <= len_a; i++) {
+            int32_t diag = row[0];
+            int32_t *sub = blosum62[seq_a[i - 1]];
+            row[0] = -(int32_t) i * penalty;
+            dir_row[0] = OP_INSERT;
+            for (uint32_t j = 1; j <= len_b; j++) {
+                int32_t up = row[j];
+                int32_t h = diag + sub[seq_b[j - 1]];
+                char dir = OP_MATCH;
+                if (up - penalty > h) {
+                    h = up - penalty;
+                    dir = OP_INSERT;
+                }
+                if (row[j - 1] - penalty > h) {
+                    h = row[j - 1] - penalty;
+                    dir = OP_DELETE;
+                }
+                diag = up;
+                row[j] = h;
+                dir_row[j] = dir;
+            }
+            mram_write(dir_row, (__mram_ptr void *) (mram_base_addr_dirs + i * BATCH_DIR_STRIDE), ROUND_UP_TO_MULTIPLE_OF_8(len_b + 1));
+        }
+
+        // Traceback, filling ops backwards and reading directions 8 bytes at a time
+        uint32_t i = len_a, j = len_b, n = 0;
+        uint32_t cached_addr = UINT32_MAX;
+        while (i > 0 || j > 0) {
+            uint32_t addr = mram_base_addr_dirs + i * BATCH_DIR_STRIDE + j;
+            if ((addr & ~7) != cached_addr) {
+                cached_addr = addr & ~7;
+                mram_read((__mram_ptr void const *) cached_addr, cache, sizeof(uint64_t));
+            }
+            char dir = ((char *) cache)[addr & 7];
+            ops[BATCH_TRACEBACK_SLOT - 1 - n++] = dir;
+            if (dir == OP_MATCH) {
+                i--;
+                j--;
+            } else if (dir == OP_INSERT) {
+                i--;
+            } else {
+                j--;
+            }
+        }
+        for (uint32_t t = 0; t < n; t++) {
+            ops[t] = ops[BATCH_TRACEBACK_SLOT - n + t];
+        }
+
+        // Move output from WRAM to MRAM
+        result->score = row[len_b];
+        result->traceback_len = n;
+        mram_write(result, (__mram_ptr void *) (mram_base_addr_output + k * sizeof(pair_result_t)), sizeof(pair_result_t));
+        if (n > 0)
+            mram_write(ops, (__mram_ptr void *) (mram_base_addr_output + slots * sizeof(pair_result_t) + k * BATCH_TRACEBACK_SLOT), ROUND_UP_TO_MULTIPLE_OF_8(n));
+    }
+}
+
+// Boundary exchange: copy bytes (a multiple of 8) from MRAM to MRAM through WRAM, split among the tasklets in chunks
+static void mram_copy_shared(uint32_t src, uint32_t dst, uint32_t bytes, uint64_t *buffer) {
+    for (uint32_t offset = me() * BOUNDARY_CHUNK; offset < bytes; offset += NR_TASKLETS * BOUNDARY_CHUNK) {
+        uint32_t size = (bytes - offset < BOUNDARY_CHUNK) ? bytes - offset : BOUNDARY_CHUNK;
+        mram_read((__mram_ptr void const *) (src + offset), buffer, size);
+        mram_write(buffer, (__mram_ptr void *) (dst + offset), size);
+    }
+}
+
+// Boundary exchange: expand the boundaries of a block into the first row and column of its itemsets (all tasklets)
+static void unpack_boundaries(uint32_t addr_boundaries, uint32_t addr_itemsets, uint64_t *buffer) {
+    int32_t *values = (int32_t *) buffer;
+    mram_copy_shared(addr_boundaries, addr_itemsets, (BL+2) * sizeof(int32_t), buffer);
+    for (uint32_t i = 1 + me(); i <= BL; i += NR_TASKLETS) {
+        uint32_t addr = addr_boundaries + (BL + 1 + i) * sizeof(int32_t);
+        mram_read((__mram_ptr void const *) (addr & ~7), buffer, sizeof(uint64_t));
+        values[0] = values[(addr & 7) / sizeof(int32_t)];
+        mram_write(buffer, (__mram_ptr void *) (addr_itemsets + i * (BL+2) * sizeof(int32_t)), sizeof(uint64_t));
+    }
+}
+
+// Boundary exchange: gather the right column and the bottom row of a block (all tasklets)
+static void pack_boundaries(uint32_t addr_itemsets, uint32_t addr_boundaries, uint64_t *buffer) {
+    int32_t *values = (int32_t *) buffer;
+    for (uint32_t i = 1 + 2 * me(); i <= BL; i += 2 * NR_TASKLETS) {
+        mram_read((__mram_ptr void const *) (addr_itemsets + (i * (BL+2) + BL) * sizeof(int32_t)), buffer, sizeof(uint64_t));
+        int32_t right = values[0];
+        mram_read((__mram_ptr void const *) (addr_itemsets + ((i+1) * (BL+2) + BL) * sizeof(int32_t)), buffer, sizeof(uint64_t));
+        values[1] = values[0];
+        values[0] = right;
+        mram_write(buffer, (__mram_ptr void *) (addr_boundaries + (i - 1) * sizeof(int32_t)), sizeof(uint64_t));
+    }
+    mram_copy_shared(addr_itemsets + BL * (BL+2) * sizeof(int32_t), addr_boundaries + BL * sizeof(int32_t), (BL+2) * sizeof(int32_t), buffer);
+}
+
+#if BL <= WAVEFRONT_MAX_BL
+// Wavefront kernel: scores of the current block relative to its top-left corner, and its reference scores (shared by all tasklets)
+int16_t wave_block[(BL+1) * (BL+1)];
+int8_t wave_ref[BL * BL];
+
+// MRAM layouts of the values loaded into and stored from wave_block
+#define WAVE_ITEMSETS 0       // Rows of BL+2 values
+#define WAVE_BOUNDARIES_IN 1  // Corner, top row, pad, left column
+#define WAVE_BOUNDARIES_OUT 2 // Right column, then bottom row with its left value and a pad
+
+static inline int16_t saturate16(int32_t value) {
+    return (value > INT16_MAX) ? INT16_MAX : (value < INT16_MIN) ? INT16_MIN : value;
+}
+
+// Wavefront kernel: index in wave_block of value k of an MRAM layout, or -1 for padding
+static inline int32_t wave_index(uint32_t layout, uint32_t k) {
+    if (layout == WAVE_BOUNDARIES_IN) {
+        if (k <= BL)
+            return k;
+        return (k == BL + 1) ? -1 : (int32_t) (k - BL - 1) * (BL+1);
+    }
+    if (layout == WAVE_BOUNDARIES_OUT) {
+        if (k < BL)
+            return (k + 1) * (BL+1) + BL;
+        return (k == 2 * BL + 1) ? -1 : (int32_t) (BL * (BL+1) + k - BL);
+    }
+    return (k % (BL+2) == BL + 1) ? -1 : (int32_t) ((k / (BL+2)) * (BL+1) + k % (BL+2));
+}
+
+// Wavefront kernel: move bytes of an MRAM layout from or to wave_block, split among the tasklets in chunks
+static void wave_transfer(uint32_t addr, uint32_t layout, uint32_t bytes, bool load, int32_t corner, uint64_t *buffer) {
+    int32_t *values = (int32_t *) buffer;
+    for (uint32_t offset = me() * BOUNDARY_CHUNK; offset < bytes; offset += NR_TASKLETS * BOUNDARY_CHUNK) {
+        uint32_t size = (bytes - offset < BOUNDARY_CHUNK) ? bytes - offset : BOUNDARY_CHUNK;
+        uint32_t first = offset / sizeof(int32_t);
+        if (load) {
+            mram_read((__mram_ptr void const *) (addr + offset), buffer, size);
+            for (uint32_t k = 0; k < size / sizeof(int32_t); k++) {
+                int32_t index = wave_index(layout, first + k);
+                if (index >= 0)
+                    wave_block[index] = saturate16(values[k] - corner);
+            }
+        } else {
+            for (uint32_t k = 0; k < size / sizeof(int32_t); k++) {
+                int32_t index = wave_index(layout, first + k);
+                values[k] = (index >= 0) ? wave_block[index] + corner : 0;
+            }
+            mram_write(buffer, (__mram_ptr void *) (addr + offset), size);
+        }
+    }
+}
+
+// Wavefront kernel: compute a whole block in WRAM. The first row and column come from the boundaries sent (boundary
+// exchange) or from the itemsets, and the reference from the residues (seq_a != NULL) or from MRAM. The block is
+// written back to its itemsets, and with boundary exchange its boundaries to addr_boundaries_out
+static void wavefront_block(uint32_t addr_itemsets, bool boundaries, uint32_t addr_boundaries_in, uint32_t addr_boundaries_out, uint32_t addr_ref,
+        const uint8_t *seq_a, int32_t penalty, uint64_t *buffer) {
+    int32_t *values = (int32_t *) buffer;
+    mram_read((__mram_ptr void const *) (boundaries ? addr_boundaries_in : addr_itemsets), buffer, sizeof(uint64_t));
+    int32_t corner = values[0];
+
+    // First row and column
+    if (boundaries) {
+        wave_transfer(addr_boundaries_in, WAVE_BOUNDARIES_IN, BOUNDARY_SIZE, true, corner, buffer);
+    } else {
+        wave_transfer(addr_itemsets, WAVE_ITEMSETS, (BL+2) * sizeof(int32_t), true, corner, buffer);
+        for (uint32_t i = 1 + me(); i <= BL; i += NR_TASKLETS) {
+            mram_read((__mram_ptr void const *) (addr_itemsets + i * (BL+2) * sizeof(int32_t)), buffer, sizeof(uint64_t));
+            wave_block[i * (BL+1)] = saturate16(values[0] - corner);
+        }
+    }
+
+    // Reference scores, which fit 8 bits
+    if (seq_a != NULL) {
+        const uint8_t *seq_b = seq_a + BL;
+        for (uint32_t i = me(); i < BL; i += NR_TASKLETS) {
+            int32_t *sub = blosum62[seq_a[i]];
+            for (uint32_t j = 0; j < BL; j++)
+                wave_ref[i * BL + j] = sub[seq_b[j]];
+        }
+    } else {
+        for (uint32_t offset = me() * BOUNDARY_CHUNK; offset < BL * BL * sizeof(int32_t); offset += NR_TASKLETS * BOUNDARY_CHUNK) {
+            uint32_t size = (BL * BL * sizeof(int32_t) - offset < BOUNDARY_CHUNK) ? BL * BL * sizeof(int32_t) - offset : BOUNDARY_CHUNK;
+            mram_read((__mram_ptr void const *) (addr_ref + offset), buffer, size);
+            for (uint32_t k = 0; k < size / sizeof(int32_t); k++)
+                wave_ref[offset / sizeof(int32_t) + k] = values[k];
+        }
+    }
+    barrier_wait(&my_barrier);
+
+    // Computation: anti-diagonal d holds the cells with i + j = d, split among the tasklets
+    for (uint32_t d = 2; d <= 2 * BL; d++) {
+        uint32_t first_i = (d > BL) ? d - BL : 1;
+        uint32_t last_i = (d - 1 < BL) ? d - 1 : BL;
+        for (uint32_t i = first_i + me(); i <= last_i; i += NR_TASKLETS) {
+            int16_t *cell = wave_block + i * (BL+1) + (d - i);
+            *cell = saturate16(maximum(cell[-(BL+1) - 1] + wave_ref[(i-1) * BL + d - i - 1], cell[-1] - penalty, cell[-(BL+1)] - penalty));
+        }
+        barrier_wait(&my_barrier);
+    }
+
+    // Move output from WRAM to MRAM
+    wave_transfer(addr_itemsets, WAVE_ITEMSETS, (BL+1) * (BL+2) * sizeof(int32_t), false, corner, buffer);
+    if (boundaries)
+        wave_transfer(addr_boundaries_out, WAVE_BOUNDARIES_OUT, BOUNDARY_SIZE, false, corner, buffer);
+    barrier_wait(&my_barrier);
+}
+#endif
+
+
 // main
 int main() {
     unsigned int tasklet_id = me();
@@ -31,6 +269,10 @@ int main() {
 #if PRINT
     printf("tasklet_id = %d, nblocks = %d \n", tasklet_id, nblocks);
 #endif
+    if (DPU_INPUT_ARGUMENTS.mode == NW_BATCH) {
+        nw_batch(nblocks, DPU_INPUT_ARGUMENTS.batch_slots, penalty);
+        return 0;
+    }
 	
     uint32_t mram_base_addr_input_itemsets = (uint32_t) (DPU_MRAM_HEAP_POINTER);
     uint32_t mram_base_addr_ref = (uint32_t) (DPU_MRAM_HEAP_POINTER + nblocks * (BL+1) * (BL+2) * sizeof(int32_t));
@@ -39,6 +281,33 @@ int main() {
 
     int32_t *cache_input = mem_alloc((BL_IN+1) * (BL_IN+2) * sizeof(int32_t));
     int32_t *cache_ref = mem_alloc(BL_IN * BL_IN * sizeof(int32_t));
+
+    // In NW_BLOCKS_SEQ mode, the reference of a block is built from its residues: BL of sequence A (rows), then BL of sequence B (columns)
+    bool seq_mode = (DPU_INPUT_ARGUMENTS.mode == NW_BLOCKS_SEQ);
+    uint32_t ref_block_size = seq_mode ? BLOCK_SEQ_SIZE : BL * BL * sizeof(int32_t);
+    uint8_t *seq_a = NULL;
+    uint8_t *seq_b = NULL;
+    if (seq_mode) {
+        seq_a = mem_alloc(BLOCK_SEQ_SIZE);
+        seq_b = seq_a + BL;
+    }
+
+    // Boundary exchange: the itemset blocks start at work_offset, and the reference after the boundaries sent
+    bool boundaries = DPU_INPUT_ARGUMENTS.boundaries;
+    uint32_t mram_base_addr_boundaries_in = (uint32_t) DPU_MRAM_HEAP_POINTER;
+    uint32_t mram_base_addr_boundaries_out = 0;
+    uint64_t *boundary_buffer = NULL;
+    if (boundaries) {
+        mram_base_addr_ref = mram_base_addr_boundaries_in + active_blocks * BOUNDARY_SIZE;
+        mram_base_addr_boundaries_out = mram_base_addr_ref + active_blocks * ref_block_size;
+        mram_base_addr_input_itemsets = (uint32_t) DPU_MRAM_HEAP_POINTER + DPU_INPUT_ARGUMENTS.work_offset;
+    }
+    bool wavefront = false;
+#if BL <= WAVEFRONT_MAX_BL
+    wavefront = DPU_INPUT_ARGUMENTS.wavefront;
+#endif
+    if (boundaries || wavefront)
+        boundary_buffer = mem_alloc(BOUNDARY_CHUNK);
     uint32_t REP = BL/BL_IN;
     uint32_t chunks;
     uint32_t mod;
@@ -48,138 +317,173 @@ int main() {
     uint32_t cache_input_offset;
 
     for (uint32_t bl = 0; bl < nblocks; bl++) {
+        if (seq_mode)
+            mram_read((__mram_ptr void const *) mram_base_addr_ref, (void *) seq_a, BLOCK_SEQ_SIZE);
+        if (wavefront) {
+#if BL <= WAVEFRONT_MAX_BL
+            wavefront_block(mram_base_addr_input_itemsets, boundaries, mram_base_addr_boundaries_in, mram_base_addr_boundaries_out,
+                    mram_base_addr_ref, seq_a, penalty, boundary_buffer);
+#endif
+        } else {
+            if (boundaries) {
+                unpack_boundaries(mram_base_addr_boundaries_in, mram_base_addr_input_itemsets, boundary_buffer);
+                barrier_wait(&my_barrier);
+            }
 
-        // Top-left computation
-        for(uint32_t blk = 0; blk <= REP; blk++) {
+            // Top-left computation
+            for(uint32_t blk = 0; blk <= REP; blk++) {
             
-            // Partition chunks/subblocks of the diagonal to tasklets 
-            chunks = blk / NR_TASKLETS; 
-            mod = blk % NR_TASKLETS;
-            if (tasklet_id < mod)
-                chunks++;
-            if (mod > 0) {
-                if(tasklet_id < mod)
+                // Partition chunks/subblocks of the diagonal to tasklets 
+                chunks = blk / NR_TASKLETS; 
+                mod = blk % NR_TASKLETS;
+                if (tasklet_id < mod)
+                    chunks++;
+                if (mod > 0) {
+                    if(tasklet_id < mod)
+                        start = tasklet_id * chunks;
+                    else
+                        start = mod * (chunks + 1) + (tasklet_id - mod) * chunks;
+                } else
                     start = tasklet_id * chunks;
-                else
-                    start = mod * (chunks + 1) + (tasklet_id - mod) * chunks;
-            } else
-                start = tasklet_id * chunks;
             
-            // Compute all assigned chunks  
-            for (uint32_t bl_indx = 0; bl_indx < chunks; bl_indx++) {
-                int t_index_x = start + bl_indx;
-                int t_index_y = blk - 1 - t_index_x; 
+                // Compute all assigned chunks  
+                for (uint32_t bl_indx = 0; bl_indx < chunks; bl_indx++) {
+                    int t_index_x = start + bl_indx;
+                    int t_index_y = blk - 1 - t_index_x; 
                 
-                // Move input from MRAM to WRAM
-                addr_input =  mram_base_addr_input_itemsets + (t_index_x * (BL+2) * BL_IN * sizeof(int32_t)) + (t_index_y * BL_IN * sizeof(int32_t));
-                cache_input_offset = (BL_IN+2);
-                mram_read((__mram_ptr void const *) addr_input, (void *) cache_input, (BL_IN+2) * sizeof(int32_t)); 
-                addr_input += ((BL+2) * sizeof(int32_t));
-                for (int i = 1; i < BL_IN + 1; i++) {
-                    mram_read((__mram_ptr void const *) addr_input, (void *) (cache_input + cache_input_offset), (2) * sizeof(int32_t)); 
-                    cache_input_offset += (BL_IN+2); 
+                    // Move input from MRAM to WRAM
+                    addr_input =  mram_base_addr_input_itemsets + (t_index_x * (BL+2) * BL_IN * sizeof(int32_t)) + (t_index_y * BL_IN * sizeof(int32_t));
+                    cache_input_offset = (BL_IN+2);
+                    mram_read((__mram_ptr void const *) addr_input, (void *) cache_input, (BL_IN+2) * sizeof(int32_t)); 
                     addr_input += ((BL+2) * sizeof(int32_t));
-                }
+                    for (int i = 1; i < BL_IN + 1; i++) {
+                        mram_read((__mram_ptr void const *) addr_input, (void *) (cache_input + cache_input_offset), (2) * sizeof(int32_t)); 
+                        cache_input_offset += (BL_IN+2); 
+                        addr_input += ((BL+2) * sizeof(int32_t));
+                    }
 
-                addr_ref = mram_base_addr_ref + (t_index_x * BL * BL_IN * sizeof(int32_t)) +  (t_index_y * BL_IN * sizeof(int32_t));
-                cache_input_offset = 0;
-                for (int i = 0; i < BL_IN; i++) {
-                    mram_read((__mram_ptr void const *) addr_ref, (void *) (cache_ref + cache_input_offset), (BL_IN) * sizeof(int32_t)); 
-                    cache_input_offset += BL_IN; 
-                    addr_ref += (BL * sizeof(int32_t));
-                }
+                    if (seq_mode) {
+                        for (int i = 0; i < BL_IN; i++) {
+                            int32_t *sub = blosum62[seq_a[t_index_x * BL_IN + i]];
+                            for (int j = 0; j < BL_IN; j++)
+                                cache_ref[i*BL_IN + j] = sub[seq_b[t_index_y * BL_IN + j]];
+                        }
+                    } else {
+                        addr_ref = mram_base_addr_ref + (t_index_x * BL * BL_IN * sizeof(int32_t)) +  (t_index_y * BL_IN * sizeof(int32_t));
+                        cache_input_offset = 0;
+                        for (int i = 0; i < BL_IN; i++) {
+                            mram_read((__mram_ptr void const *) addr_ref, (void *) (cache_ref + cache_input_offset), (BL_IN) * sizeof(int32_t)); 
+                            cache_input_offset += BL_IN; 
+                            addr_ref += (BL * sizeof(int32_t));
+                        }
+                    }
 
-                // Computation
-                for (uint32_t i = 1; i < BL_IN + 1; i++) {
-                    for (uint32_t j = 1; j < BL_IN + 1; j++) {
-                        cache_input[i*(BL_IN+2) + j] = maximum(cache_input[(i-1)*(BL_IN+2) + j - 1] + cache_ref[(i-1)*BL_IN + j-1],
-                                                cache_input[i*(BL_IN+2) + j - 1] - penalty,
-                                                cache_input[(i-1)*(BL_IN+2) + j] - penalty);
+                    // Computation
+                    for (uint32_t i = 1; i < BL_IN + 1; i++) {
+                        for (uint32_t j = 1; j < BL_IN + 1; j++) {
+                            cache_input[i*(BL_IN+2) + j] = maximum(cache_input[(i-1)*(BL_IN+2) + j - 1] + cache_ref[(i-1)*BL_IN + j-1],
+                                                    cache_input[i*(BL_IN+2) + j - 1] - penalty,
+                                                    cache_input[(i-1)*(BL_IN+2) + j] - penalty);
+                        }
                     }
-                }
 
-                // Move output from WRAM to MRAM
-                addr_input =  mram_base_addr_input_itemsets + (t_index_x * (BL+2) * BL_IN * sizeof(int32_t)) + (t_index_y * BL_IN * sizeof(int32_t));
-                cache_input_offset = (BL_IN+2);
-                addr_input += ((BL+2) * sizeof(int32_t));
-                for (int i = 1; i < BL_IN + 1; i++) {
-                    mram_write((cache_input + cache_input_offset), (__mram_ptr void *)  addr_input, (BL_IN+2) * sizeof(int32_t)); 
-                    cache_input_offset += (BL_IN+2); 
+                    // Move output from WRAM to MRAM
+                    addr_input =  mram_base_addr_input_itemsets + (t_index_x * (BL+2) * BL_IN * sizeof(int32_t)) + (t_index_y * BL_IN * sizeof(int32_t));
+                    cache_input_offset = (BL_IN+2);
                     addr_input += ((BL+2) * sizeof(int32_t));
-                }
+                    for (int i = 1; i < BL_IN + 1; i++) {
+                        mram_write((cache_input + cache_input_offset), (__mram_ptr void *)  addr_input, (BL_IN+2) * sizeof(int32_t)); 
+                        cache_input_offset += (BL_IN+2); 
+                        addr_input += ((BL+2) * sizeof(int32_t));
+                    }
 
-            }
+                }
             
-            barrier_wait(&my_barrier);
-        }
+                barrier_wait(&my_barrier);
+            }
        
-        // Bottom-right computation
-        for(uint32_t blk = 2; blk <= REP; blk++) {
-            // Partition chunks/subblocks of the diagonal to tasklets 
-            chunks = (REP - blk + 1) / NR_TASKLETS; 
-            mod = (REP - blk + 1) % NR_TASKLETS;
-            if (tasklet_id < mod)
-                chunks++;
-            if (mod > 0){
-                if(tasklet_id < mod)
+            // Bottom-right computation
+            for(uint32_t blk = 2; blk <= REP; blk++) {
+                // Partition chunks/subblocks of the diagonal to tasklets 
+                chunks = (REP - blk + 1) / NR_TASKLETS; 
+                mod = (REP - blk + 1) % NR_TASKLETS;
+                if (tasklet_id < mod)
+                    chunks++;
+                if (mod > 0){
+                    if(tasklet_id < mod)
+                        start = tasklet_id * chunks;
+                    else
+                        start = mod * (chunks + 1) + (tasklet_id - mod) * chunks;
+                } else
                     start = tasklet_id * chunks;
-                else
-                    start = mod * (chunks + 1) + (tasklet_id - mod) * chunks;
-            } else
-                start = tasklet_id * chunks;
-
-            // Compute all assigned chunks  
-            for (uint32_t bl_indx = 0; bl_indx < chunks; bl_indx++) {
-                int t_index_x = blk - 1 + start + bl_indx;
-                int t_index_y = REP + blk - 2 - t_index_x; 
-
-                // Move input from MRAM to WRAM
-                addr_input =  mram_base_addr_input_itemsets + (t_index_x * (BL+2) * BL_IN * sizeof(int32_t)) + (t_index_y * BL_IN * sizeof(int32_t));
-                cache_input_offset = (BL_IN+2);
-                mram_read((__mram_ptr void const *) addr_input, (void *) cache_input, (BL_IN+2) * sizeof(int32_t)); 
-                addr_input += ((BL+2) * sizeof(int32_t));
-                for (int i = 1; i < BL_IN + 1; i++) {
-                    mram_read((__mram_ptr void const *) addr_input, (void *) (cache_input + cache_input_offset), (2) * sizeof(int32_t)); 
-                    cache_input_offset += (BL_IN+2); 
+
+                // Compute all assigned chunks  
+                for (uint32_t bl_indx = 0; bl_indx < chunks; bl_indx++) {
+                    int t_index_x = blk - 1 + start + bl_indx;
+                    int t_index_y = REP + blk - 2 - t_index_x; 
+
+                    // Move input from MRAM to WRAM
+                    addr_input =  mram_base_addr_input_itemsets + (t_index_x * (BL+2) * BL_IN * sizeof(int32_t)) + (t_index_y * BL_IN * sizeof(int32_t));
+                    cache_input_offset = (BL_IN+2);
+                    mram_read((__mram_ptr void const *) addr_input, (void *) cache_input, (BL_IN+2) * sizeof(int32_t)); 
                     addr_input += ((BL+2) * sizeof(int32_t));
-                }
+                    for (int i = 1; i < BL_IN + 1; i++) {
+                        mram_read((__mram_ptr void const *) addr_input, (void *) (cache_input + cache_input_offset), (2) * sizeof(int32_t)); 
+                        cache_input_offset += (BL_IN+2); 
+                        addr_input += ((BL+2) * sizeof(int32_t));
+                    }
 
-                addr_ref = mram_base_addr_ref + (t_index_x * BL * BL_IN * sizeof(int32_t)) +  (t_index_y * BL_IN * sizeof(int32_t));
-                cache_input_offset = 0;
-                for (int i = 0; i < BL_IN; i++) {
-                    mram_read((__mram_ptr void const *) addr_ref, (void *) (cache_ref + cache_input_offset), (BL_IN) * sizeof(int32_t)); 
-                    cache_input_offset += BL_IN; 
-                    addr_ref += (BL * sizeof(int32_t));
-                }
+                    if (seq_mode) {
+                        for (int i = 0; i < BL_IN; i++) {
+                            int32_t *sub = blosum62[seq_a[t_index_x * BL_IN + i]];
+                            for (int j = 0; j < BL_IN; j++)
+                                cache_ref[i*BL_IN + j] = sub[seq_b[t_index_y * BL_IN + j]];
+                        }
+                    } else {
+                        addr_ref = mram_base_addr_ref + (t_index_x * BL * BL_IN * sizeof(int32_t)) +  (t_index_y * BL_IN * sizeof(int32_t));
+                        cache_input_offset = 0;
+                        for (int i = 0; i < BL_IN; i++) {
+                            mram_read((__mram_ptr void const *) addr_ref, (void *) (cache_ref + cache_input_offset), (BL_IN) * sizeof(int32_t)); 
+                            cache_input_offset += BL_IN; 
+                            addr_ref += (BL * sizeof(int32_t));
+                        }
+                    }
 
 
-                // Computation
-                for (int i = 1; i < BL_IN + 1; i++) {
-                    for (int j = 1; j < BL_IN + 1; j++) {
-                        cache_input[i*(BL_IN+2) + j] = maximum(cache_input[(i-1)*(BL_IN+2) + j - 1] + cache_ref[(i-1)*BL_IN + j-1],
-                                                cache_input[i*(BL_IN+2) + j - 1] - penalty,
-                                                cache_input[(i-1)*(BL_IN+2) + j] - penalty);
+                    // Computation
+                    for (int i = 1; i < BL_IN + 1; i++) {
+                        for (int j = 1; j < BL_IN + 1; j++) {
+                            cache_input[i*(BL_IN+2) + j] = maximum(cache_input[(i-1)*(BL_IN+2) + j - 1] + cache_ref[(i-1)*BL_IN + j-1],
+                                                    cache_input[i*(BL_IN+2) + j - 1] - penalty,
+                                                    cache_input[(i-1)*(BL_IN+2) + j] - penalty);
+                        }
                     }
-                }
 
-                // Move output from WRAM to MRAM
-                addr_input =  mram_base_addr_input_itemsets + (t_index_x * (BL+2) * BL_IN * sizeof(int32_t)) + (t_index_y * BL_IN * sizeof(int32_t));
-                cache_input_offset = (BL_IN+2);
-                addr_input += ((BL+2) * sizeof(int32_t));
-                for (int i = 1; i < BL_IN + 1; i++) {
-                    mram_write(cache_input + cache_input_offset, (__mram_ptr void *)  addr_input, (BL_IN+2) * sizeof(int32_t)); 
-                    cache_input_offset += (BL_IN+2); 
+                    // Move output from WRAM to MRAM
+                    addr_input =  mram_base_addr_input_itemsets + (t_index_x * (BL+2) * BL_IN * sizeof(int32_t)) + (t_index_y * BL_IN * sizeof(int32_t));
+                    cache_input_offset = (BL_IN+2);
                     addr_input += ((BL+2) * sizeof(int32_t));
-                }
+                    for (int i = 1; i < BL_IN + 1; i++) {
+                        mram_write(cache_input + cache_input_offset, (__mram_ptr void *)  addr_input, (BL_IN+2) * sizeof(int32_t)); 
+                        cache_input_offset += (BL_IN+2); 
+                        addr_input += ((BL+2) * sizeof(int32_t));
+                    }
 
-            }
+                }
             
-            barrier_wait(&my_barrier);
+                barrier_wait(&my_barrier);
 
-        }
+            }
 		
+            if (boundaries)
+                pack_boundaries(mram_base_addr_input_itemsets, mram_base_addr_boundaries_out, boundary_buffer);
+        }
+        if (boundaries) {
+            mram_base_addr_boundaries_in += BOUNDARY_SIZE;
+            mram_base_addr_boundaries_out += BOUNDARY_SIZE;
+        }
         mram_base_addr_input_itemsets += ((BL+1) * (BL+2) * sizeof(int32_t));
-        mram_base_addr_ref += (BL * BL * sizeof(int32_t)); 
+        mram_base_addr_ref += ref_block_size;
     }
     return 0;
 }
@@ -95,7 +95,20 @@ static void traceback(int* traceback_output, int32_t *input_itemsets, int32_t *r
 }
 
 // Compute output in the host
-static void nw_host(int32_t *input_itemsets, int32_t *reference, uint64_t max_cols, unsigned int penalty) {
+// Banded mode: clip the diagonal whose t-th block is (x0 + t, y0 - t), with y0 >= x0, to the blocks at most band_blocks
+// block diagonals away from the main one. These form a contiguous range, which is never empty for band_blocks > 0
+static void band_clip(uint32_t *nr_of_blocks, uint32_t *x0, uint32_t *y0, uint32_t band_blocks) {
+    uint32_t offset = *y0 - *x0;
+    uint32_t first = (offset > band_blocks) ? (offset - band_blocks + 1) / 2 : 0;
+    uint32_t last = (offset + band_blocks) / 2;
+    if (last > *nr_of_blocks - 1)
+        last = *nr_of_blocks - 1;
+    *nr_of_blocks = last - first + 1;
+    *x0 += first;
+    *y0 -= first;
+}
+
+static void nw_host(int32_t *input_itemsets, int32_t *reference, uint64_t max_cols, unsigned int penalty, uint32_t band_blocks) {
 
     int32_t *input_itemsets_l = (int32_t *) malloc((BL + 1) * (BL + 1) * sizeof(int32_t));
     int32_t *reference_l = (int32_t *) malloc((BL * BL) * sizeof(int32_t));
@@ -103,7 +116,9 @@ static void nw_host(int32_t *input_itemsets, int32_t *reference, uint64_t max_co
 
     // top-left
     for (uint64_t blk = 1; blk <= (max_cols-1)/BL; blk++) {
-        for (uint64_t b_index_x = 0; b_index_x < blk; b_index_x++) {
+        uint32_t nr_of_blocks = blk, x0 = 0, y0 = blk - 1;
+        band_clip(&nr_of_blocks, &x0, &y0, band_blocks);
+        for (uint64_t b_index_x = x0; b_index_x < x0 + nr_of_blocks; b_index_x++) {
             uint64_t b_index_y = blk - 1 - b_index_x;
 
             for (uint64_t i = 0; i < BL; i++){
@@ -139,7 +154,9 @@ static void nw_host(int32_t *input_itemsets, int32_t *reference, uint64_t max_co
 
     // bottom-right 
     for (uint64_t blk = 2; blk <= (max_cols-1)/BL; blk++) {
-        for (uint64_t b_index_x = blk - 1; b_index_x < (max_cols-1)/BL; b_index_x++) {
+        uint32_t nr_of_blocks = (max_cols-1)/BL - blk + 1, x0 = blk - 1, y0 = (max_cols-1)/BL - 1;
+        band_clip(&nr_of_blocks, &x0, &y0, band_blocks);
+        for (uint64_t b_index_x = x0; b_index_x < x0 + nr_of_blocks; b_index_x++) {
             uint64_t b_index_y = (max_cols-1)/BL + blk - 2 - b_index_x;
 
             for (uint64_t i = 0; i < BL; i++){
@@ -179,7 +196,1005 @@ static void nw_host(int32_t *input_itemsets, int32_t *reference, uint64_t max_co
     return;
 }
 
+// Batch mode: generate pairs of similar sequences, B being A with random substitutions, insertions and deletions
+static void generate_pairs(uint8_t *seqs, pair_lengths_t *lengths, unsigned int n_pairs, unsigned int max_len) {
+    srand(7);
+    for (unsigned int k = 0; k < n_pairs; k++) {
+        uint8_t *seq_a = seqs + (uint64_t) k * 2 * BATCH_SEQ_SLOT;
+        uint8_t *seq_b = seq_a + BATCH_SEQ_SLOT;
+        uint32_t len_a = max_len / 2 + rand() % (max_len - max_len / 2 + 1);
+        uint32_t len_b = 0;
+        for (uint32_t i = 0; i < len_a; i++) {
+            seq_a[i] = rand() % 10 + 1;
+        }
+        for (uint32_t i = 0; i < len_a && len_b < max_len; i++) {
+            int r = rand() % 100;
+            if (r < 3) // Deletion
+                continue;
+            if (r < 6 && len_b < max_len - 1) // Insertion
+                seq_b[len_b++] = rand() % 10 + 1;
+            seq_b[len_b++] = (r >= 6 && r < 10) ? rand() % 10 + 1 : seq_a[i]; // Substitution or copy
+        }
+        lengths[k].len_a = len_a;
+        lengths[k].len_b = len_b;
+    }
+}
+
+// Batch mode: align one pair on the host with the same tie-breaking as the DPU kernel
+static int32_t nw_pair_host(const uint8_t *seq_a, uint32_t len_a, const uint8_t *seq_b, uint32_t len_b, int32_t penalty,
+        int32_t *row, char *dirs, char *ops, uint32_t *traceback_len) {
+
+    for (uint32_t j = 0; j <= len_b; j++) {
+        row[j] = -(int32_t) j * penalty;
+        dirs[j] = OP_DELETE;
+    }
+    for (uint32_t i = 1; i <= len_a; i++) {
+        int32_t diag = row[0];
+        row[0] = -(int32_t) i * penalty;
+        dirs[i * (len_b + 1)] = OP_INSERT;
+        for (uint32_t j = 1; j <= len_b; j++) {
+            int32_t up = row[j];
+            int32_t h = diag + blosum62[seq_a[i - 1]][seq_b[j - 1]];
+            char dir = OP_MATCH;
+            if (up - penalty > h) {
+                h = up - penalty;
+                dir = OP_INSERT;
+            }
+            if (row[j - 1] - penalty > h) {
+                h = row[j - 1] - penalty;
+                dir = OP_DELETE;
+            }
+            diag = up;
+            row[j] = h;
+            dirs[i * (len_b + 1) + j] = dir;
+        }
+    }
+
+    // Traceback
+    uint32_t n = 0;
+    for (uint32_t i = len_a, j = len_b; i > 0 || j > 0; n++) {
+        char dir = dirs[i * (len_b + 1) + j];
+        ops[len_a + len_b - 1 - n] = dir;
+        if (dir == OP_MATCH) {
+            i--;
+            j--;
+        } else if (dir == OP_INSERT) {
+            i--;
+        } else {
+            j--;
+        }
+    }
+    memmove(ops, ops + len_a + len_b - n, n);
+    *traceback_len = n;
+    return row[len_b];
+}
+
+// Batch mode: align p.n_pairs independent pairs, p.batch_slots pairs per DPU per launch
+static bool nw_batch(struct Params p, struct dpu_set_t dpu_set, uint32_t nr_of_dpus) {
+
+    struct dpu_set_t dpu;
+    unsigned int n_pairs = p.n_pairs;
+    unsigned int slots = p.batch_slots;
+    int32_t penalty = p.penalty;
+    uint64_t mram_size = (uint64_t) BATCH_INPUT_SIZE(slots) + BATCH_OUTPUT_SIZE(slots) + BATCH_SCRATCH_SIZE;
+    if (mram_size > DPU_CAPACITY) {
+        printf("[" ANSI_COLOR_RED "ERROR" ANSI_COLOR_RESET "] %u pairs per DPU need %lu bytes of MRAM\n", slots, (unsigned long) mram_size);
+        return false;
+    }
+    printf("Batch of %u pairs of length <= %u, %u pairs per DPU per launch\n", n_pairs, p.max_len, slots);
+
+    uint8_t *seqs = (uint8_t *) malloc((uint64_t) n_pairs * 2 * BATCH_SEQ_SLOT);
+    pair_lengths_t *lengths = (pair_lengths_t *) malloc(n_pairs * sizeof(pair_lengths_t));
+    pair_result_t *results = (pair_result_t *) malloc(n_pairs * sizeof(pair_result_t));
+    pair_result_t *results_host = (pair_result_t *) malloc(n_pairs * sizeof(pair_result_t));
+    char *tracebacks = (char *) malloc((uint64_t) n_pairs * BATCH_TRACEBACK_SLOT);
+    char *tracebacks_host = (char *) malloc((uint64_t) n_pairs * BATCH_TRACEBACK_SLOT);
+    uint8_t *input = (uint8_t *) malloc((uint64_t) nr_of_dpus * BATCH_INPUT_SIZE(slots));
+    uint8_t *output = (uint8_t *) malloc((uint64_t) nr_of_dpus * BATCH_OUTPUT_SIZE(slots));
+    dpu_arguments_t *input_args = (dpu_arguments_t *) malloc(nr_of_dpus * sizeof(dpu_arguments_t));
+    int32_t *row = (int32_t *) malloc((BATCH_MAX_LEN + 1) * sizeof(int32_t));
+    char *dirs = (char *) malloc((BATCH_MAX_LEN + 1) * (BATCH_MAX_LEN + 1));
+    memset(seqs, 0, (uint64_t) n_pairs * 2 * BATCH_SEQ_SLOT);
+    memset(input, 0, (uint64_t) nr_of_dpus * BATCH_INPUT_SIZE(slots));
+
+    generate_pairs(seqs, lengths, n_pairs, p.max_len);
+    uint64_t cells = 0;
+    for (unsigned int k = 0; k < n_pairs; k++) {
+        cells += (uint64_t) lengths[k].len_a * lengths[k].len_b;
+    }
+
+    Timer timer;
+    for (unsigned int rep = 0; rep < p.n_warmup + p.n_reps; rep++) {
+
+        // Computation on host CPU
+        if (rep >= p.n_warmup)
+            start(&timer, 0, rep - p.n_warmup);
+        for (unsigned int k = 0; k < n_pairs; k++) {
+            const uint8_t *seq_a = seqs + (uint64_t) k * 2 * BATCH_SEQ_SLOT;
+            results_host[k].score = nw_pair_host(seq_a, lengths[k].len_a, seq_a + BATCH_SEQ_SLOT, lengths[k].len_b, penalty,
+                    row, dirs, tracebacks_host + (uint64_t) k * BATCH_TRACEBACK_SLOT, &results_host[k].traceback_len);
+        }
+        if (rep >= p.n_warmup)
+            stop(&timer, 0);
+
+        // Stream the pairs through the DPUs, slots pairs per DPU per launch
+        unsigned int launch = 0;
+        for (uint64_t base = 0; base < n_pairs; base += (uint64_t) nr_of_dpus * slots, launch++) {
+
+            // Copy input arguments and the pairs of each DPU, staged in its MRAM layout, with one transfer each
+            if (rep >= p.n_warmup)
+                start(&timer, 2, rep - p.n_warmup + launch);
+            unsigned int i = 0;
+            DPU_FOREACH(dpu_set, dpu, i) {
+                uint64_t first = base + (uint64_t) i * slots;
+                unsigned int count = (first >= n_pairs) ? 0 : (n_pairs - first < slots) ? n_pairs - first : slots;
+                uint8_t *dpu_input = input + (uint64_t) i * BATCH_INPUT_SIZE(slots);
+                if (count > 0) {
+                    memcpy(dpu_input, lengths + first, count * sizeof(pair_lengths_t));
+                    memcpy(dpu_input + slots * sizeof(pair_lengths_t), seqs + first * 2 * BATCH_SEQ_SLOT, (uint64_t) count * 2 * BATCH_SEQ_SLOT);
+                }
+                input_args[i].nblocks = count;
+                input_args[i].active_blocks = count;
+                input_args[i].penalty = penalty;
+                input_args[i].mode = NW_BATCH;
+                input_args[i].batch_slots = slots;
+                DPU_ASSERT(dpu_prepare_xfer(dpu, input_args + i));
+            }
+            DPU_ASSERT(dpu_push_xfer(dpu_set, DPU_XFER_TO_DPU, "DPU_INPUT_ARGUMENTS", 0, sizeof(dpu_arguments_t), DPU_XFER_DEFAULT));
+            DPU_FOREACH(dpu_set, dpu, i) {
+                DPU_ASSERT(dpu_prepare_xfer(dpu, input + (uint64_t) i * BATCH_INPUT_SIZE(slots)));
+            }
+            DPU_ASSERT(dpu_push_xfer(dpu_set, DPU_XFER_TO_DPU, DPU_MRAM_HEAP_POINTER_NAME, 0, BATCH_INPUT_SIZE(slots), DPU_XFER_DEFAULT));
+            if (rep >= p.n_warmup)
+                stop(&timer, 2);
+
+            // Launch kernel on DPUs
+            if (rep >= p.n_warmup)
+                start(&timer, 3, rep - p.n_warmup + launch);
+            DPU_ASSERT(dpu_launch(dpu_set, DPU_SYNCHRONOUS));
+            if (rep >= p.n_warmup)
+                stop(&timer, 3);
+
+            // Retrieve scores and tracebacks with one transfer
+            if (rep >= p.n_warmup)
+                start(&timer, 4, rep - p.n_warmup + launch);
+            DPU_FOREACH(dpu_set, dpu, i) {
+                DPU_ASSERT(dpu_prepare_xfer(dpu, output + (uint64_t) i * BATCH_OUTPUT_SIZE(slots)));
+            }
+            DPU_ASSERT(dpu_push_xfer(dpu_set, DPU_XFER_FROM_DPU, DPU_MRAM_HEAP_POINTER_NAME, BATCH_INPUT_SIZE(slots), BATCH_OUTPUT_SIZE(slots), DPU_XFER_DEFAULT));
+            for (i = 0; i < nr_of_dpus; i++) {
+                uint64_t first = base + (uint64_t) i * slots;
+                unsigned int count = input_args[i].nblocks;
+                uint8_t *dpu_output = output + (uint64_t) i * BATCH_OUTPUT_SIZE(slots);
+                if (count > 0) {
+                    memcpy(results + first, dpu_output, count * sizeof(pair_result_t));
+                    memcpy(tracebacks + first * BATCH_TRACEBACK_SLOT, dpu_output + slots * sizeof(pair_result_t), (uint64_t) count * BATCH_TRACEBACK_SLOT);
+                }
+            }
+            if (rep >= p.n_warmup)
+                stop(&timer, 4);
+
+        }
+
+    }
+
+    // Print timing results
+    double dpu_time = (timer.time[2] + timer.time[3] + timer.time[4]) / (1e6 * p.n_reps);
+    double cpu_time = timer.time[0] / (1e6 * p.n_reps);
+    printf("CPU version ");
+    print(&timer, 0, p.n_reps);
+    printf("CPU-DPU ");
+    print(&timer, 2, p.n_reps);
+    printf("DPU Kernel ");
+    print(&timer, 3, p.n_reps);
+    printf("DPU-CPU ");
+    print(&timer, 4, p.n_reps);
+    printf("\n");
+    printf("Alignments: %u\tCells: %lu\n", n_pairs, (unsigned long) cells);
+    printf("CPU Alignments/sec: %f\tCPU GCUPS: %f\n", n_pairs / cpu_time, cells / cpu_time / 1e9);
+    printf("DPU Alignments/sec: %f\tDPU GCUPS: %f\n", n_pairs / dpu_time, cells / dpu_time / 1e9);
+
+    // Check output
+    bool status = true;
+    for (unsigned int k = 0; k < n_pairs; k++) {
+        if (results[k].score != results_host[k].score || results[k].traceback_len != results_host[k].traceback_len ||
+                memcmp(tracebacks + (uint64_t) k * BATCH_TRACEBACK_SLOT, tracebacks_host + (uint64_t) k * BATCH_TRACEBACK_SLOT, results_host[k].traceback_len) != 0) {
+            status = false;
+#if PRINT
+            printf("Pair %u: score %d %d, traceback length %u %u\n", k, results_host[k].score, results[k].score, results_host[k].traceback_len, results[k].traceback_len);
+#endif
+        }
+    }
+    if (status) {
+        printf("[" ANSI_COLOR_GREEN "OK" ANSI_COLOR_RESET "] Outputs are equal\n");
+    } else {
+        printf("[" ANSI_COLOR_RED "ERROR" ANSI_COLOR_RESET "] Outputs differ!\n");
+    }
+
+    free(seqs);
+    free(lengths);
+    free(results);
+    free(results_host);
+    free(tracebacks);
+    free(tracebacks_host);
+    free(input);
+    free(output);
+    free(input_args);
+    free(row);
+    free(dirs);
+    return status;
+}
+
+// Linear-memory modes: subproblems of at least this many cells are scored on the DPUs, smaller ones on the host
+#ifndef HIRSCHBERG_DPU_CELLS
+#define HIRSCHBERG_DPU_CELLS (1 << 20)
+#endif
+// Hirschberg traceback: subproblems of at most this many cells are aligned with a matrix of directions on the host
+#define HIRSCHBERG_LEAF_CELLS (1 << 16)
+// Linear-memory modes: band_blocks of an alignment that is not banded
+#define NO_BAND UINT32_MAX
+
+// Wavefront kernel: adjacent scores differ by at most the penalty plus the largest BLOSUM62 score, so the scores of a block
+// relative to its corner fit 16 bits when 2 * BL * (penalty + 11) does
+static bool use_wavefront(struct Params p) {
+    return p.wavefront && BL <= WAVEFRONT_MAX_BL && 2 * BL * (p.penalty + 11) <= INT16_MAX;
+}
+
+// CPU-DPU transfer statistics: # of dpu_push_xfer calls and bytes moved
+typedef struct {
+    uint64_t calls;
+    uint64_t bytes;
+} xfer_stats_t;
+
+static void count_xfer(xfer_stats_t *stats, uint32_t nr_of_dpus, uint64_t size) {
+    stats->calls++;
+    stats->bytes += nr_of_dpus * size;
+}
+
+// Linear-memory modes: state of the wavefront of BL x BL blocks over the DPUs
+typedef struct {
+    struct dpu_set_t dpu_set;
+    uint32_t nr_of_dpus;
+    int32_t penalty;
+    int32_t *h;                  // Bottom row of the last computed block of each block column
+    int32_t *v;                  // Top-right corner and right column of the last computed block of each block row (BL+1 each)
+    uint8_t *b_pad;              // Sequence B padded to whole blocks
+    uint8_t *blocks;             // Boundaries sent to each DPU, then the residues of each block
+    int32_t *boundaries;         // Boundaries received from each DPU
+    uint32_t work_offset;        // MRAM offset of the itemset blocks, after the exchange area of the longest diagonal
+    bool wavefront;              // Wavefront kernel
+    uint32_t band_blocks;        // Block diagonals computed on each side of the main one, NO_BAND for all of them
+    int32_t *band_boundaries;    // Banded traceback: boundaries sent for each block of the band, 2 * band_blocks + 1 per block row
+    dpu_arguments_t *input_args;
+    uint64_t host_bytes;
+    xfer_stats_t xfer_stats;
+    Timer *timer;
+    bool timed;                  // Accumulate into the timer (cleared before the first timed repetition)
+} nw_linear_t;
+
+static void timer_start(nw_linear_t *ctx, int i) {
+    if (ctx != NULL && ctx->timed)
+        start(ctx->timer, i, 1);
+}
+
+static void timer_stop(nw_linear_t *ctx, int i) {
+    if (ctx != NULL && ctx->timed)
+        stop(ctx->timer, i);
+}
+
+static void nw_linear_init(nw_linear_t *ctx, struct dpu_set_t dpu_set, uint32_t nr_of_dpus, uint32_t n, int32_t penalty, bool wavefront,
+        uint32_t band_blocks, Timer *timer) {
+    uint32_t n_blocks = (n + BL - 1) / BL;
+    uint32_t max_blocks_per_dpu = (n_blocks + nr_of_dpus - 1) / nr_of_dpus;
+    uint64_t dpu_size = (uint64_t) max_blocks_per_dpu * (BOUNDARY_SIZE + BLOCK_SEQ_SIZE);
+    uint64_t work_offset = dpu_size + (uint64_t) max_blocks_per_dpu * BOUNDARY_SIZE;
+    assert(BLOCK_SEQ_SIZE % 8 == 0 && BLOCK_SEQ_SIZE <= 2048 && "BL must be a multiple of 4 and at most 1024!");
+    assert(work_offset + (uint64_t) max_blocks_per_dpu * (BL+1) * (BL+2) * sizeof(int32_t) <= DPU_CAPACITY && "The blocks of the longest diagonal do not fit in the DPUs!");
+
+    ctx->dpu_set = dpu_set;
+    ctx->nr_of_dpus = nr_of_dpus;
+    ctx->penalty = penalty;
+    ctx->h = (int32_t *) malloc(((uint64_t) n_blocks * BL + 1) * sizeof(int32_t));
+    ctx->v = (int32_t *) malloc((uint64_t) n_blocks * (BL + 1) * sizeof(int32_t));
+    ctx->b_pad = (uint8_t *) malloc((uint64_t) n_blocks * BL);
+    ctx->blocks = (uint8_t *) calloc(nr_of_dpus, dpu_size);
+    ctx->boundaries = (int32_t *) malloc(nr_of_dpus * max_blocks_per_dpu * BOUNDARY_SIZE);
+    ctx->work_offset = work_offset;
+    ctx->wavefront = wavefront;
+    ctx->band_blocks = band_blocks;
+    ctx->band_boundaries = NULL;
+    ctx->input_args = (dpu_arguments_t *) malloc(nr_of_dpus * sizeof(dpu_arguments_t));
+    ctx->host_bytes = ((uint64_t) n_blocks * BL + 1) * sizeof(int32_t) + (uint64_t) n_blocks * (BL + 1) * sizeof(int32_t) +
+        (uint64_t) n_blocks * BL + nr_of_dpus * (dpu_size + max_blocks_per_dpu * BOUNDARY_SIZE + sizeof(dpu_arguments_t));
+    ctx->xfer_stats.calls = 0;
+    ctx->xfer_stats.bytes = 0;
+    ctx->timer = timer;
+    ctx->timed = false;
+}
+
+static void nw_linear_free(nw_linear_t *ctx) {
+    free(ctx->h);
+    free(ctx->v);
+    free(ctx->b_pad);
+    free(ctx->blocks);
+    free(ctx->boundaries);
+    free(ctx->band_boundaries);
+    free(ctx->input_args);
+}
+
+// Banded linear-memory modes: columns lo..hi of row i are within band_blocks blocks of its block row, as in the full
+// matrix, and the others are never reached (all of row 0 is)
+static void band_range(uint32_t i, uint32_t cols, uint32_t band_blocks, uint32_t *lo, uint32_t *hi) {
+    if (i == 0) {
+        *lo = 1;
+        *hi = cols;
+        return;
+    }
+    uint32_t r = (i - 1) / BL;
+    uint64_t last = ((uint64_t) r + band_blocks + 1) * BL;
+    *lo = (r > band_blocks) ? (r - band_blocks) * BL + 1 : 1;
+    *hi = (last < cols) ? (uint32_t) last : cols;
+}
+
+// Banded linear-memory modes: set the first cell of row i to its gap score, and the cells it never reaches to BAND_NEG_INF
+static void band_mask_row(int32_t *row, uint32_t i, uint32_t cols, int32_t penalty, uint32_t band_blocks) {
+    uint32_t lo, hi;
+    band_range(i, cols, band_blocks, &lo, &hi);
+    row[0] = -(int32_t) i * penalty;
+    for (uint32_t j = 1; j < lo; j++)
+        row[j] = BAND_NEG_INF;
+    for (uint32_t j = hi + 1; j <= cols; j++)
+        row[j] = BAND_NEG_INF;
+}
+
+// Linear-memory modes: advance row from the scores of row first of the alignment of a with b to those of row rows, on the
+// host. Banded, only the reachable columns of each row are computed, the columns a block row adds to the band reading
+// as unreachable from the row above, so that the rows cost O(band) each and the first cell is left to band_mask_row
+static void nw_rows_host(const uint8_t *a, uint32_t first, uint32_t rows, const uint8_t *b, uint32_t cols, int32_t penalty, uint32_t band_blocks, int32_t *row) {
+    for (uint32_t i = first + 1; i <= rows; i++) {
+        uint32_t lo, hi;
+        band_range(i, cols, band_blocks, &lo, &hi);
+        if (i == first + 1 || (i - 1) % BL == 0) {
+            uint32_t prev_lo, prev_hi;
+            band_range(i - 1, cols, band_blocks, &prev_lo, &prev_hi);
+            for (uint32_t j = prev_hi + 1; j <= hi; j++)
+                row[j] = BAND_NEG_INF;
+        }
+        int32_t diag = row[lo - 1];
+        int32_t *sub = blosum62[a[i - 1]];
+        row[lo - 1] = (lo == 1) ? -(int32_t) i * penalty : BAND_NEG_INF;
+        for (uint32_t j = lo; j <= hi; j++) {
+            int32_t up = row[j];
+            row[j] = maximum(diag + sub[b[j - 1]], row[j - 1] - penalty, up - penalty);
+            diag = up;
+        }
+    }
+}
+
+// Linear-memory modes: scores of row rows of the alignment of a with b, one row at a time on the host
+static void nw_last_row_host(const uint8_t *a, uint32_t rows, const uint8_t *b, uint32_t cols, int32_t penalty, uint32_t band_blocks, int32_t *row) {
+    for (uint32_t j = 0; j <= cols; j++)
+        row[j] = -(int32_t) j * penalty;
+    nw_rows_host(a, 0, rows, b, cols, penalty, band_blocks, row);
+    band_mask_row(row, rows, cols, penalty, band_blocks);
+}
+
+// Linear-memory modes: scores of row rows of the alignment of a (rows) with b (columns), computed by a wavefront
+// of BL x BL blocks over the DPUs with boundary exchange, so that host memory is O(rows + cols). The DPUs compute
+// the whole block rows, and the host the last rows % BL rows from the bottom row of the last block row. Banded, only
+// the blocks within ctx->band_blocks block diagonals of the main one are computed, the first block of a block row taking
+// its top-left corner from the bottom row of the block column on its left, and the boundaries of the others reading as
+// unreachable; with ctx->band_boundaries set, the boundaries sent for each block are kept there.
+static void nw_last_row_dpu(nw_linear_t *ctx, const uint8_t *a, uint32_t rows, const uint8_t *b, uint32_t cols, int32_t *last_row) {
+
+    struct dpu_set_t dpu;
+    int32_t penalty = ctx->penalty;
+    uint64_t band_blocks = ctx->band_blocks;
+    uint32_t block_rows = rows / BL;
+    uint32_t block_cols = (cols + BL - 1) / BL;
+    if (block_rows == 0 || cols == 0) {
+        timer_start(ctx, 1);
+        nw_last_row_host(a, rows, b, cols, penalty, ctx->band_blocks, last_row);
+        timer_stop(ctx, 1);
+        return;
+    }
+
+    // Boundaries of the first block row and column, and residues of B padded to whole blocks
+    timer_start(ctx, 1);
+    memcpy(ctx->b_pad, b, cols);
+    memset(ctx->b_pad + cols, 0, block_cols * BL - cols);
+    ctx->h[0] = 0;
+    for (uint32_t j = 1; j <= block_cols * BL; j++)
+        ctx->h[j] = ((j - 1) / BL <= band_blocks) ? -(int32_t) j * penalty : BAND_NEG_INF;
+    for (uint32_t by = 0; by < block_rows; by++) {
+        for (uint32_t r = 0; r <= BL; r++)
+            ctx->v[by * (BL + 1) + r] = (by <= band_blocks) ? -(int32_t) (by * BL + r) * penalty : BAND_NEG_INF;
+    }
+    timer_stop(ctx, 1);
+
+    for (uint32_t d = 0; d < block_rows + block_cols - 1; d++) {
+        uint32_t first_bx = (d < block_rows) ? 0 : d - block_rows + 1;
+        uint32_t last_bx = (d < block_cols) ? d : block_cols - 1;
+        if (d > band_blocks && (d - band_blocks + 1) / 2 > first_bx)
+            first_bx = (d - band_blocks + 1) / 2;
+        if ((d + band_blocks) / 2 < last_bx)
+            last_bx = (d + band_blocks) / 2;
+        if (first_bx > last_bx)
+            continue;
+        uint32_t nr_of_blocks = last_bx - first_bx + 1;
+        uint32_t blocks_per_dpu = (nr_of_blocks + ctx->nr_of_dpus - 1) / ctx->nr_of_dpus;
+        uint64_t dpu_size = (uint64_t) blocks_per_dpu * (BOUNDARY_SIZE + BLOCK_SEQ_SIZE);
+
+        // Stage the corner, top row and left column, then the residues, of each block in one buffer per DPU
+        timer_start(ctx, 1);
+        for (uint32_t t = 0; t < nr_of_blocks; t++) {
+            uint32_t bx = first_bx + t;
+            uint32_t by = d - bx;
+            uint8_t *dpu_buffer = ctx->blocks + (t / blocks_per_dpu) * dpu_size;
+            int32_t *boundary = (int32_t *) (dpu_buffer + (t % blocks_per_dpu) * BOUNDARY_SIZE);
+            uint8_t *residues = dpu_buffer + blocks_per_dpu * BOUNDARY_SIZE + (t % blocks_per_dpu) * BLOCK_SEQ_SIZE;
+            const int32_t *v = ctx->v + by * (BL + 1);
+            boundary[0] = (bx > 0 && bx + band_blocks == by) ? ctx->h[bx * BL] : v[0];
+            memcpy(boundary + 1, ctx->h + bx * BL + 1, BL * sizeof(int32_t));
+            boundary[BL + 1] = 0;
+            memcpy(boundary + BL + 2, v + 1, BL * sizeof(int32_t));
+            memcpy(residues, a + by * BL, BL);
+            memcpy(residues + BL, ctx->b_pad + bx * BL, BL);
+            if (ctx->band_boundaries != NULL)
+                memcpy(ctx->band_boundaries + (by * (2 * band_blocks + 1) + bx + band_blocks - by) * (2 * BL + 2), boundary, BOUNDARY_SIZE);
+        }
+        timer_stop(ctx, 1);
+
+        // Copy input arguments, then the buffer of each DPU with one transfer
+        timer_start(ctx, 2);
+        unsigned int i = 0;
+        DPU_FOREACH(ctx->dpu_set, dpu, i) {
+            uint32_t first = i * blocks_per_dpu;
+            ctx->input_args[i].nblocks = (first >= nr_of_blocks) ? 0 : (nr_of_blocks - first < blocks_per_dpu) ? nr_of_blocks - first : blocks_per_dpu;
+            ctx->input_args[i].active_blocks = blocks_per_dpu;
+            ctx->input_args[i].penalty = penalty;
+            ctx->input_args[i].mode = NW_BLOCKS_SEQ;
+            ctx->input_args[i].batch_slots = 0;
+            ctx->input_args[i].boundaries = 1;
+            ctx->input_args[i].work_offset = ctx->work_offset;
+            ctx->input_args[i].wavefront = ctx->wavefront;
+            DPU_ASSERT(dpu_prepare_xfer(dpu, ctx->input_args + i));
+        }
+        DPU_ASSERT(dpu_push_xfer(ctx->dpu_set, DPU_XFER_TO_DPU, "DPU_INPUT_ARGUMENTS", 0, sizeof(dpu_arguments_t), DPU_XFER_DEFAULT));
+        count_xfer(&ctx->xfer_stats, ctx->nr_of_dpus, sizeof(dpu_arguments_t));
+        DPU_FOREACH(ctx->dpu_set, dpu, i) {
+            DPU_ASSERT(dpu_prepare_xfer(dpu, ctx->blocks + i * dpu_size));
+        }
+        DPU_ASSERT(dpu_push_xfer(ctx->dpu_set, DPU_XFER_TO_DPU, DPU_MRAM_HEAP_POINTER_NAME, 0, dpu_size, DPU_XFER_DEFAULT));
+        count_xfer(&ctx->xfer_stats, ctx->nr_of_dpus, dpu_size);
+        timer_stop(ctx, 2);
+
+        // Launch kernel on DPUs
+        timer_start(ctx, 3);
+        DPU_ASSERT(dpu_launch(ctx->dpu_set, DPU_SYNCHRONOUS));
+        timer_stop(ctx, 3);
+
+        // Retrieve the right column and bottom row of each block with one transfer
+        timer_start(ctx, 4);
+        DPU_FOREACH(ctx->dpu_set, dpu, i) {
+            DPU_ASSERT(dpu_prepare_xfer(dpu, (uint8_t *) ctx->boundaries + i * blocks_per_dpu * BOUNDARY_SIZE));
+        }
+        DPU_ASSERT(dpu_push_xfer(ctx->dpu_set, DPU_XFER_FROM_DPU, DPU_MRAM_HEAP_POINTER_NAME, dpu_size, blocks_per_dpu * BOUNDARY_SIZE, DPU_XFER_DEFAULT));
+        count_xfer(&ctx->xfer_stats, ctx->nr_of_dpus, blocks_per_dpu * BOUNDARY_SIZE);
+        timer_stop(ctx, 4);
+
+        // Keep the boundaries of each block
+        timer_start(ctx, 1);
+        for (uint32_t t = 0; t < nr_of_blocks; t++) {
+            uint32_t bx = first_bx + t;
+            uint32_t by = d - bx;
+            const int32_t *sent = (const int32_t *) (ctx->blocks + (t / blocks_per_dpu) * dpu_size + (t % blocks_per_dpu) * BOUNDARY_SIZE);
+            const int32_t *received = ctx->boundaries + (uint64_t) t * (2 * BL + 2);
+            int32_t *v = ctx->v + by * (BL + 1);
+            v[0] = sent[BL]; // Top-right corner, the top-left corner of the next block of the row
+            memcpy(v + 1, received, BL * sizeof(int32_t));
+            memcpy(ctx->h + bx * BL + 1, received + BL + 1, BL * sizeof(int32_t));
+        }
+        timer_stop(ctx, 1);
+    }
+
+    // Last rows on the host
+    timer_start(ctx, 1);
+    memcpy(last_row, ctx->h, (cols + 1) * sizeof(int32_t));
+    band_mask_row(last_row, block_rows * BL, cols, penalty, ctx->band_blocks);
+    nw_rows_host(a, block_rows * BL, rows, b, cols, penalty, ctx->band_blocks, last_row);
+    band_mask_row(last_row, rows, cols, penalty, ctx->band_blocks);
+    timer_stop(ctx, 1);
+}
+
+// Hirschberg traceback: buffers reused across the recursion
+typedef struct {
+    int32_t *forward;  // Scores of the top half, cols + 1
+    int32_t *backward; // Scores of the reversed bottom half, cols + 1
+    char *dirs;        // Directions of a leaf subproblem
+} hirschberg_scratch_t;
+
+// Hirschberg traceback: align a (rows) with b (cols) into ops and return their number. a is split in halves and b
+// where the scores of the top half and the reversed bottom half add up to the best score; a_rev and b_rev are the
+// reversed sequences. Large halves are scored on the DPUs if ctx is set, the rest on the host.
+static uint32_t nw_hirschberg(nw_linear_t *ctx, const uint8_t *a, const uint8_t *a_rev, uint32_t rows, const uint8_t *b, const uint8_t *b_rev, uint32_t cols,
+        int32_t penalty, hirschberg_scratch_t *scratch, char *ops) {
+
+    if (rows <= 1 || (uint64_t) (rows + 1) * (cols + 1) <= HIRSCHBERG_LEAF_CELLS) {
+        uint32_t n_ops;
+        timer_start(ctx, 1);
+        nw_pair_host(a, rows, b, cols, penalty, scratch->forward, scratch->dirs, ops, &n_ops);
+        timer_stop(ctx, 1);
+        return n_ops;
+    }
+
+    uint32_t mid = rows / 2;
+    if (ctx != NULL && (uint64_t) rows * cols >= HIRSCHBERG_DPU_CELLS) {
+        nw_last_row_dpu(ctx, a, mid, b, cols, scratch->forward);
+        nw_last_row_dpu(ctx, a_rev, rows - mid, b_rev, cols, scratch->backward);
+    } else {
+        timer_start(ctx, 1);
+        nw_last_row_host(a, mid, b, cols, penalty, NO_BAND, scratch->forward);
+        nw_last_row_host(a_rev, rows - mid, b_rev, cols, penalty, NO_BAND, scratch->backward);
+        timer_stop(ctx, 1);
+    }
+    uint32_t split = 0;
+    int32_t best = INT32_MIN;
+    for (uint32_t j = 0; j <= cols; j++) {
+        if (scratch->forward[j] + scratch->backward[cols - j] > best) {
+            best = scratch->forward[j] + scratch->backward[cols - j];
+            split = j;
+        }
+    }
+
+    uint32_t n_ops = nw_hirschberg(ctx, a, a_rev + (rows - mid), mid, b, b_rev + (cols - split), split, penalty, scratch, ops);
+    n_ops += nw_hirschberg(ctx, a + mid, a_rev, rows - mid, b + split, b_rev, cols - split, penalty, scratch, ops + n_ops);
+    return n_ops;
+}
+
+// Hirschberg traceback: score of the alignment of a with b described by ops, or LIMIT if ops do not consume both sequences
+static int32_t nw_ops_score(const uint8_t *a, uint32_t rows, const uint8_t *b, uint32_t cols, int32_t penalty, const char *ops, uint32_t n_ops) {
+    int32_t score = 0;
+    uint32_t i = 0, j = 0;
+    for (uint32_t k = 0; k < n_ops; k++) {
+        if (ops[k] == OP_MATCH && i < rows && j < cols) {
+            score += blosum62[a[i++]][b[j++]];
+        } else if (ops[k] == OP_INSERT && i < rows) {
+            score -= penalty;
+            i++;
+        } else if (ops[k] == OP_DELETE && j < cols) {
+            score -= penalty;
+            j++;
+        } else {
+            return LIMIT;
+        }
+    }
+    return (i == rows && j == cols) ? score : LIMIT;
+}
+
+// Banded traceback: align a with b (n residues each) on the host with the tie-breaking of nw_pair_host, computing and
+// keeping the directions of the reachable columns of each row only, width per row
+static int32_t nw_band_host(const uint8_t *a, const uint8_t *b, uint32_t n, int32_t penalty, uint32_t band_blocks, int32_t *row,
+        char *dirs, uint64_t width, char *ops, uint32_t *traceback_len) {
+
+    for (uint32_t j = 0; j <= n; j++)
+        row[j] = -(int32_t) j * penalty;
+    for (uint32_t i = 1; i <= n; i++) {
+        uint32_t lo, hi;
+        band_range(i, n, band_blocks, &lo, &hi);
+        if ((i - 1) % BL == 0) {
+            uint32_t prev_lo, prev_hi;
+            band_range(i - 1, n, band_blocks, &prev_lo, &prev_hi);
+            for (uint32_t j = prev_hi + 1; j <= hi; j++)
+                row[j] = BAND_NEG_INF;
+        }
+        char *row_dirs = dirs + (uint64_t) i * width - lo;
+        int32_t diag = row[lo - 1];
+        row[lo - 1] = (lo == 1) ? -(int32_t) i * penalty : BAND_NEG_INF;
+        for (uint32_t j = lo; j <= hi; j++) {
+            int32_t up = row[j];
+            int32_t h = diag + blosum62[a[i - 1]][b[j - 1]];
+            char dir = OP_MATCH;
+            if (up - penalty > h) {
+                h = up - penalty;
+                dir = OP_INSERT;
+            }
+            if (row[j - 1] - penalty > h) {
+                h = row[j - 1] - penalty;
+                dir = OP_DELETE;
+            }
+            diag = up;
+            row[j] = h;
+            row_dirs[j] = dir;
+        }
+    }
+
+    // Traceback, the first row and column being gaps only
+    uint32_t count = 0, i = n, j = n;
+    while (i > 0 && j > 0) {
+        uint32_t lo, hi;
+        band_range(i, n, band_blocks, &lo, &hi);
+        char dir = dirs[(uint64_t) i * width + j - lo];
+        ops[2 * (uint64_t) n - 1 - count++] = dir;
+        i -= (dir != OP_DELETE);
+        j -= (dir != OP_INSERT);
+    }
+    for (; i > 0; i--)
+        ops[2 * (uint64_t) n - 1 - count++] = OP_INSERT;
+    for (; j > 0; j--)
+        ops[2 * (uint64_t) n - 1 - count++] = OP_DELETE;
+    memmove(ops, ops + 2 * (uint64_t) n - count, count);
+    *traceback_len = count;
+    return row[n];
+}
+
+// Banded traceback: align a with b (n residues each, n a multiple of BL) from the boundaries of the blocks of the band
+// kept by nw_last_row_dpu, following the directions back from the bottom-right corner and recomputing on the host each
+// block the path enters, so that the traceback costs O(n * BL) time and a block of memory
+static uint32_t nw_band_traceback(const int32_t *boundaries, const uint8_t *a, const uint8_t *b, uint32_t n, int32_t penalty,
+        uint32_t band_blocks, int32_t *block, char *ops) {
+
+    uint32_t count = 0, i = n, j = n;
+    while (i > 0 && j > 0) {
+
+        // Scores of the block of cell (i, j) from its corner, top row and left column
+        uint32_t by = (i - 1) / BL, bx = (j - 1) / BL;
+        const int32_t *boundary = boundaries + ((uint64_t) by * (2 * band_blocks + 1) + bx + band_blocks - by) * (2 * BL + 2);
+        memcpy(block, boundary, (BL + 1) * sizeof(int32_t));
+        for (uint32_t r = 1; r <= BL; r++) {
+            int32_t *sub = blosum62[a[by * BL + r - 1]];
+            int32_t *cell = block + r * (BL + 1);
+            const int32_t *above = cell - (BL + 1);
+            cell[0] = boundary[BL + 1 + r];
+            for (uint32_t c = 1; c <= BL; c++)
+                cell[c] = maximum(above[c - 1] + sub[b[bx * BL + c - 1]], cell[c - 1] - penalty, above[c] - penalty);
+        }
+
+        // Directions up to the top row or left column of the block, with the tie-breaking of nw_pair_host
+        while (i > by * BL && j > bx * BL) {
+            const int32_t *cell = block + (i - by * BL) * (BL + 1) + (j - bx * BL);
+            int32_t h = cell[-(BL + 1) - 1] + blosum62[a[i - 1]][b[j - 1]];
+            char dir = OP_MATCH;
+            if (cell[-(BL + 1)] - penalty > h) {
+                h = cell[-(BL + 1)] - penalty;
+                dir = OP_INSERT;
+            }
+            if (cell[-1] - penalty > h)
+                dir = OP_DELETE;
+            ops[2 * (uint64_t) n - 1 - count++] = dir;
+            i -= (dir != OP_DELETE);
+            j -= (dir != OP_INSERT);
+        }
+    }
+    for (; i > 0; i--)
+        ops[2 * (uint64_t) n - 1 - count++] = OP_INSERT;
+    for (; j > 0; j--)
+        ops[2 * (uint64_t) n - 1 - count++] = OP_DELETE;
+    memmove(ops, ops + 2 * (uint64_t) n - count, count);
+    return count;
+}
+
+// Linear-memory modes: align two sequences of length p.max_rows keeping only O(n) data on the host, either the
+// score (NW_SCORE_ONLY) or the score and the traceback (NW_HIRSCHBERG). Banded (-k), the DPUs and the host compute the
+// band only, in O(n * K) time; the score keeps O(n) memory, and the traceback the boundaries of the blocks of the band
+// instead of recursing, O(n * K) memory
+static bool nw_linear(struct Params p, struct dpu_set_t dpu_set, uint32_t nr_of_dpus) {
+
+    uint32_t n = p.max_rows;
+    int32_t penalty = p.penalty;
+    bool hirschberg = (p.memory_mode == NW_HIRSCHBERG);
+    uint32_t n_blocks = (n + BL - 1) / BL;
+    uint32_t band_blocks = (p.band && (p.band + BL - 1) / BL < n_blocks) ? (p.band + BL - 1) / BL : NO_BAND;
+    bool banded = (band_blocks != NO_BAND);
+    if (banded && hirschberg && n % BL != 0) {
+        fprintf(stderr, "Banded traceback needs a sequence length that is a multiple of BL!\n");
+        return false;
+    }
+    Timer timer;
+    memset(&timer, 0, sizeof(Timer));
+    nw_linear_t ctx;
+    nw_linear_init(&ctx, dpu_set, nr_of_dpus, n, penalty, use_wavefront(p), band_blocks, &timer);
+    printf("Max size %d, %s\n", n, hirschberg ? (banded ? "banded traceback" : "Hirschberg traceback") : "score only");
+    if (banded)
+        printf("Band: %u cells, %u block diagonals on each side of the main one\n", p.band, band_blocks);
+    printf("DPU kernel: %s\n", ctx.wavefront ? "16-bit wavefront" : "32-bit sub-blocks");
+
+    uint8_t *seq_a = (uint8_t *) malloc(n);
+    uint8_t *seq_b = (uint8_t *) malloc(n);
+    uint8_t *seq_a_rev = (uint8_t *) malloc(n);
+    uint8_t *seq_b_rev = (uint8_t *) malloc(n);
+    int32_t *row = (int32_t *) malloc((n + 1) * sizeof(int32_t));
+    int32_t *row_host = (int32_t *) malloc((n + 1) * sizeof(int32_t));
+    char *ops = (char *) malloc(2 * (uint64_t) n);
+    char *ops_host = (char *) malloc(2 * (uint64_t) n);
+    uint64_t dirs_size = (2 * ((uint64_t) n + 1) > HIRSCHBERG_LEAF_CELLS) ? 2 * ((uint64_t) n + 1) : HIRSCHBERG_LEAF_CELLS;
+    hirschberg_scratch_t scratch;
+    scratch.forward = (int32_t *) malloc((n + 1) * sizeof(int32_t));
+    scratch.backward = (int32_t *) malloc((n + 1) * sizeof(int32_t));
+    scratch.dirs = (char *) malloc(dirs_size);
+    uint64_t host_bytes = ctx.host_bytes + 4 * (uint64_t) n + 4 * ((uint64_t) n + 1) * sizeof(int32_t) + 4 * (uint64_t) n + dirs_size;
+
+    // Banded traceback: the boundaries of the blocks of the band for the DPUs, the directions of the band for the host
+    uint64_t band_width = 0;
+    char *band_dirs = NULL;
+    int32_t *band_block = NULL;
+    if (banded && hirschberg) {
+        uint64_t band_bytes = (uint64_t) n_blocks * (2 * band_blocks + 1) * BOUNDARY_SIZE;
+        band_width = ((2 * (uint64_t) band_blocks + 1) * BL < n) ? (2 * (uint64_t) band_blocks + 1) * BL : n;
+        ctx.band_boundaries = (int32_t *) malloc(band_bytes);
+        band_dirs = (char *) malloc(((uint64_t) n + 1) * band_width);
+        band_block = (int32_t *) malloc((BL + 1) * (BL + 1) * sizeof(int32_t));
+        host_bytes += band_bytes + ((uint64_t) n + 1) * band_width + (BL + 1) * (BL + 1) * sizeof(int32_t);
+    }
+
+    // Same random sequences as the full-matrix mode
+    srand(7);
+    for (uint32_t i = 0; i < n; i++)
+        seq_a[i] = rand() % 10 + 1;
+    for (uint32_t j = 0; j < n; j++)
+        seq_b[j] = rand() % 10 + 1;
+    for (uint32_t i = 0; i < n; i++) {
+        seq_a_rev[i] = seq_a[n - 1 - i];
+        seq_b_rev[i] = seq_b[n - 1 - i];
+    }
+
+    uint32_t n_ops = 0, n_ops_host = 0;
+    for (unsigned int rep = 0; rep < p.n_warmup + p.n_reps; rep++) {
+
+        // Computation on host CPU
+        if (rep >= p.n_warmup)
+            start(&timer, 0, rep - p.n_warmup);
+        if (banded && hirschberg)
+            nw_band_host(seq_a, seq_b, n, penalty, band_blocks, row_host, band_dirs, band_width, ops_host, &n_ops_host);
+        else if (hirschberg)
+            n_ops_host = nw_hirschberg(NULL, seq_a, seq_a_rev, n, seq_b, seq_b_rev, n, penalty, &scratch, ops_host);
+        else
+            nw_last_row_host(seq_a, n, seq_b, n, penalty, band_blocks, row_host);
+        if (rep >= p.n_warmup)
+            stop(&timer, 0);
+
+        // Computation on DPUs, with the host keeping the block boundaries between diagonals
+        ctx.timed = (rep >= p.n_warmup);
+        ctx.xfer_stats.calls = 0;
+        ctx.xfer_stats.bytes = 0;
+        if (banded && hirschberg) {
+            nw_last_row_dpu(&ctx, seq_a, n, seq_b, n, row);
+            timer_start(&ctx, 1);
+            n_ops = nw_band_traceback(ctx.band_boundaries, seq_a, seq_b, n, penalty, band_blocks, band_block, ops);
+            timer_stop(&ctx, 1);
+        } else if (hirschberg) {
+            n_ops = nw_hirschberg(&ctx, seq_a, seq_a_rev, n, seq_b, seq_b_rev, n, penalty, &scratch, ops);
+        } else {
+            nw_last_row_dpu(&ctx, seq_a, n, seq_b, n, row);
+        }
+
+    }
+
+    // Print timing results
+    printf("CPU version ");
+    print(&timer, 0, p.n_reps);
+    printf("CPU-DPU ");
+    print(&timer, 2, p.n_reps);
+    printf("DPU Kernel ");
+    print(&timer, 3, p.n_reps);
+    printf("Inter-DPU ");
+    print(&timer, 1, p.n_reps);
+    printf("DPU-CPU ");
+    print(&timer, 4, p.n_reps);
+    printf("\n");
+    printf("Host memory (MB): %f (full score matrix: %f)\n", host_bytes / 1e6, 3.0 * (n + 2) * (n + 2) * sizeof(int32_t) / 1e6);
+    printf("CPU-DPU transfers per alignment: %lu calls, %f MB\n", (unsigned long) ctx.xfer_stats.calls, ctx.xfer_stats.bytes / 1e6);
+
+    // Check output: the last row of scores, or the traceback and its score (the optimal score is computed on the host)
+    bool status;
+    if (hirschberg) {
+        nw_last_row_host(seq_a, n, seq_b, n, penalty, band_blocks, row_host);
+        int32_t score = nw_ops_score(seq_a, n, seq_b, n, penalty, ops, n_ops);
+        printf("Score: %d, traceback length: %u\n", score, n_ops);
+        status = (n_ops == n_ops_host && memcmp(ops, ops_host, n_ops) == 0 && score == row_host[n]);
+    } else {
+        printf("Score: %d\n", row[n]);
+        status = (memcmp(row, row_host, (n + 1) * sizeof(int32_t)) == 0);
+    }
+    if (status) {
+        printf("[" ANSI_COLOR_GREEN "OK" ANSI_COLOR_RESET "] Outputs are equal\n");
+    } else {
+        printf("[" ANSI_COLOR_RED "ERROR" ANSI_COLOR_RESET "] Outputs differ!\n");
+    }
+
+    nw_linear_free(&ctx);
+    free(seq_a);
+    free(seq_b);
+    free(seq_a_rev);
+    free(seq_b_rev);
+    free(row);
+    free(row_host);
+    free(ops);
+    free(ops_host);
+    free(scratch.forward);
+    free(scratch.backward);
+    free(scratch.dirs);
+    free(band_dirs);
+    free(band_block);
+    return status;
+}
+
 // Main of the Host Application
+// Full-matrix boundary exchange: host buffer bounding each transfer of the blocks gathered after the last diagonal
+#define GATHER_BUFFER_SIZE (64 << 20)
+
+// Full-matrix boundary exchange: the itemset blocks stay resident in the DPU that computed them, and only the
+// boundaries of each block cross the CPU-DPU link until the whole matrix is gathered after the last diagonal
+typedef struct {
+    struct dpu_set_t dpu_set;
+    uint32_t nr_of_dpus;
+    uint32_t n_blocks;           // Blocks per row and column of the matrix
+    uint32_t slots;              // Blocks per DPU on the current diagonal
+    uint32_t work_offset;        // MRAM offset of the resident itemset blocks, after the exchange area of the longest diagonal
+    uint32_t max_resident;       // Most blocks resident in a DPU
+    uint8_t *buffer;             // Boundaries and reference blocks sent to each DPU
+    int32_t *boundaries;         // Boundaries received from each DPU
+    uint32_t *resident_blocks;   // # of blocks resident in each DPU
+    uint32_t *block_dpu;         // DPU and resident slot of each block
+    uint32_t *block_slot;
+} nw_exchange_t;
+
+// Returns false if the resident blocks do not fit in MRAM
+static bool nw_exchange_init(nw_exchange_t *ex, struct dpu_set_t dpu_set, uint32_t nr_of_dpus, uint32_t n_blocks, uint32_t band_blocks) {
+    // DPU 0 gets the most blocks of every diagonal
+    uint32_t max_slots = 0;
+    uint64_t max_resident = 0;
+    for (uint32_t d = 0; d + 1 < 2 * n_blocks; d++) {
+        uint32_t nr_of_blocks = (d < n_blocks) ? d + 1 : 2 * n_blocks - 1 - d;
+        uint32_t x0 = (d < n_blocks) ? 0 : d - n_blocks + 1;
+        uint32_t y0 = (d < n_blocks) ? d : n_blocks - 1;
+        band_clip(&nr_of_blocks, &x0, &y0, band_blocks);
+        uint32_t slots = (nr_of_blocks + nr_of_dpus - 1) / nr_of_dpus;
+        max_slots = (slots > max_slots) ? slots : max_slots;
+        max_resident += slots;
+    }
+    uint64_t exchange_size = (uint64_t) max_slots * (2 * BOUNDARY_SIZE + BL * BL * sizeof(int32_t));
+    if (exchange_size + max_resident * (BL+1) * (BL+2) * sizeof(int32_t) > DPU_CAPACITY)
+        return false;
+
+    ex->dpu_set = dpu_set;
+    ex->nr_of_dpus = nr_of_dpus;
+    ex->n_blocks = n_blocks;
+    ex->slots = 0;
+    ex->work_offset = (uint32_t) exchange_size;
+    ex->max_resident = (uint32_t) max_resident;
+    ex->buffer = (uint8_t *) malloc((uint64_t) nr_of_dpus * max_slots * (BOUNDARY_SIZE + BL * BL * sizeof(int32_t)));
+    ex->boundaries = (int32_t *) malloc((uint64_t) nr_of_dpus * max_slots * BOUNDARY_SIZE);
+    ex->resident_blocks = (uint32_t *) calloc(nr_of_dpus, sizeof(uint32_t));
+    ex->block_dpu = (uint32_t *) malloc((uint64_t) n_blocks * n_blocks * sizeof(uint32_t));
+    ex->block_slot = (uint32_t *) malloc((uint64_t) n_blocks * n_blocks * sizeof(uint32_t));
+    memset(ex->block_slot, 0xff, (uint64_t) n_blocks * n_blocks * sizeof(uint32_t)); // Blocks outside the band are never resident
+    return true;
+}
+
+static void nw_exchange_free(nw_exchange_t *ex) {
+    free(ex->buffer);
+    free(ex->boundaries);
+    free(ex->resident_blocks);
+    free(ex->block_dpu);
+    free(ex->block_slot);
+}
+
+// Blocks of DPU i on a diagonal of nr_of_blocks blocks (same distribution as the row-by-row transfers)
+static void diagonal_range(uint32_t nr_of_blocks, uint32_t nr_of_dpus, uint32_t i, uint32_t *first, uint32_t *count) {
+    uint32_t chunks = nr_of_blocks / nr_of_dpus;
+    uint32_t rest_blocks = nr_of_blocks % nr_of_dpus;
+    *first = i * chunks + (i < rest_blocks ? i : rest_blocks);
+    *count = chunks + (i < rest_blocks ? 1 : 0);
+}
+
+// Stage the corner, top row and left column of each block of the diagonal whose t-th block is (x0 + t, y0 - t),
+// and record where it will stay resident
+static void stage_boundaries(nw_exchange_t *ex, const int32_t *input_itemsets, uint64_t max_cols, uint32_t nr_of_blocks, uint32_t x0, uint32_t y0) {
+    ex->slots = (nr_of_blocks + ex->nr_of_dpus - 1) / ex->nr_of_dpus;
+    uint64_t dpu_size = (uint64_t) ex->slots * (BOUNDARY_SIZE + BL * BL * sizeof(int32_t));
+    for (uint32_t i = 0; i < ex->nr_of_dpus; i++) {
+        uint32_t first, count;
+        diagonal_range(nr_of_blocks, ex->nr_of_dpus, i, &first, &count);
+        for (uint32_t s = 0; s < count; s++) {
+            uint64_t bx = x0 + first + s;
+            uint64_t by = y0 - first - s;
+            const int32_t *corner = input_itemsets + by * BL * (max_cols+1) + bx * BL;
+            int32_t *boundary = (int32_t *) (ex->buffer + i * dpu_size + s * BOUNDARY_SIZE);
+            memcpy(boundary, corner, (BL+1) * sizeof(int32_t));
+            boundary[BL+1] = 0;
+            for (unsigned int r = 1; r <= BL; r++)
+                boundary[BL+1+r] = corner[r * (max_cols+1)];
+            ex->block_dpu[by * ex->n_blocks + bx] = i;
+            ex->block_slot[by * ex->n_blocks + bx] = ex->resident_blocks[i] + s;
+        }
+    }
+}
+
+// Stage the reference block of each block of the diagonal after its boundaries, then copy the buffer of each DPU with one transfer
+static void push_blocks(nw_exchange_t *ex, const int32_t *reference, uint64_t max_cols, uint32_t nr_of_blocks, uint32_t x0, uint32_t y0, xfer_stats_t *stats) {
+    struct dpu_set_t dpu;
+    uint64_t dpu_size = (uint64_t) ex->slots * (BOUNDARY_SIZE + BL * BL * sizeof(int32_t));
+    for (uint32_t i = 0; i < ex->nr_of_dpus; i++) {
+        uint32_t first, count;
+        diagonal_range(nr_of_blocks, ex->nr_of_dpus, i, &first, &count);
+        for (uint32_t s = 0; s < count; s++) {
+            uint64_t bx = x0 + first + s;
+            uint64_t by = y0 - first - s;
+            int32_t *block = (int32_t *) (ex->buffer + i * dpu_size + ex->slots * BOUNDARY_SIZE) + (uint64_t) s * BL * BL;
+            for (unsigned int r = 0; r < BL; r++)
+                memcpy(block + r * BL, reference + (by * BL + r) * (max_cols-1) + bx * BL, BL * sizeof(int32_t));
+        }
+    }
+    unsigned int i = 0;
+    DPU_FOREACH(ex->dpu_set, dpu, i) {
+        DPU_ASSERT(dpu_prepare_xfer(dpu, ex->buffer + i * dpu_size));
+    }
+    DPU_ASSERT(dpu_push_xfer(ex->dpu_set, DPU_XFER_TO_DPU, DPU_MRAM_HEAP_POINTER_NAME, 0, dpu_size, DPU_XFER_DEFAULT));
+    count_xfer(stats, ex->nr_of_dpus, dpu_size);
+}
+
+// Retrieve the right column and bottom row of each block of the diagonal with one transfer, and write them into input_itemsets
+static void pull_boundaries(nw_exchange_t *ex, int32_t *input_itemsets, uint64_t max_cols, uint32_t nr_of_blocks, uint32_t x0, uint32_t y0, xfer_stats_t *stats) {
+    struct dpu_set_t dpu;
+    uint64_t dpu_size = (uint64_t) ex->slots * (BOUNDARY_SIZE + BL * BL * sizeof(int32_t));
+    unsigned int i = 0;
+    DPU_FOREACH(ex->dpu_set, dpu, i) {
+        DPU_ASSERT(dpu_prepare_xfer(dpu, (uint8_t *) ex->boundaries + i * ex->slots * BOUNDARY_SIZE));
+    }
+    DPU_ASSERT(dpu_push_xfer(ex->dpu_set, DPU_XFER_FROM_DPU, DPU_MRAM_HEAP_POINTER_NAME, dpu_size, ex->slots * BOUNDARY_SIZE, DPU_XFER_DEFAULT));
+    count_xfer(stats, ex->nr_of_dpus, ex->slots * BOUNDARY_SIZE);
+
+    for (i = 0; i < ex->nr_of_dpus; i++) {
+        uint32_t first, count;
+        diagonal_range(nr_of_blocks, ex->nr_of_dpus, i, &first, &count);
+        for (uint32_t s = 0; s < count; s++) {
+            uint64_t bx = x0 + first + s;
+            uint64_t by = y0 - first - s;
+            const int32_t *received = ex->boundaries + ((uint64_t) i * ex->slots + s) * (2 * BL + 2);
+            int32_t *corner = input_itemsets + by * BL * (max_cols+1) + bx * BL;
+            for (unsigned int r = 1; r <= BL; r++)
+                corner[r * (max_cols+1) + BL] = received[r - 1];
+            memcpy(corner + BL * (max_cols+1) + 1, received + BL + 1, BL * sizeof(int32_t));
+        }
+        ex->resident_blocks[i] += count;
+    }
+}
+
+// Retrieve the itemset blocks resident in the DPUs, in rounds bounded by GATHER_BUFFER_SIZE, and copy their cells into input_itemsets
+static void gather_blocks(nw_exchange_t *ex, int32_t *input_itemsets, uint64_t max_cols, xfer_stats_t *stats) {
+    struct dpu_set_t dpu;
+    uint64_t block_size = (BL+1) * (BL+2) * sizeof(int32_t);
+    uint32_t round_slots = GATHER_BUFFER_SIZE / (ex->nr_of_dpus * block_size);
+    if (round_slots == 0)
+        round_slots = 1;
+    if (round_slots > ex->max_resident)
+        round_slots = ex->max_resident;
+    int32_t *blocks = (int32_t *) malloc(ex->nr_of_dpus * round_slots * block_size);
+
+    for (uint32_t first = 0; first < ex->max_resident; first += round_slots) {
+        uint32_t slots = (ex->max_resident - first < round_slots) ? ex->max_resident - first : round_slots;
+        unsigned int i = 0;
+        DPU_FOREACH(ex->dpu_set, dpu, i) {
+            DPU_ASSERT(dpu_prepare_xfer(dpu, (uint8_t *) blocks + i * slots * block_size));
+        }
+        DPU_ASSERT(dpu_push_xfer(ex->dpu_set, DPU_XFER_FROM_DPU, DPU_MRAM_HEAP_POINTER_NAME, ex->work_offset + first * block_size, slots * block_size, DPU_XFER_DEFAULT));
+        count_xfer(stats, ex->nr_of_dpus, slots * block_size);
+
+        for (uint64_t by = 0; by < ex->n_blocks; by++) {
+            for (uint64_t bx = 0; bx < ex->n_blocks; bx++) {
+                uint32_t slot = ex->block_slot[by * ex->n_blocks + bx];
+                if (slot < first || slot >= first + slots)
+                    continue;
+                const int32_t *block = (const int32_t *) ((uint8_t *) blocks + (ex->block_dpu[by * ex->n_blocks + bx] * slots + slot - first) * block_size);
+                for (unsigned int r = 1; r <= BL; r++)
+                    memcpy(input_itemsets + (by * BL + r) * (max_cols+1) + bx * BL + 1, block + r * (BL+2) + 1, BL * sizeof(int32_t));
+            }
+        }
+    }
+    free(blocks);
+}
+
 int main(int argc, char **argv) {
 
     struct Params p = input_params(argc, argv);
@@ -197,9 +1212,21 @@ int main(int argc, char **argv) {
     DPU_ASSERT(dpu_get_nr_dpus(dpu_set, &nr_of_dpus));
     printf("Allocated %d DPU(s)\n", nr_of_dpus);
     printf("Allocated %d TASKLET(s) per DPU\n", NR_TASKLETS);
-#if DYNAMIC
     max_dpus = nr_of_dpus;
-#endif
+
+    // Batch mode: whole independent alignments per DPU and tasklet
+    if (p.n_pairs > 0) {
+        bool status = nw_batch(p, dpu_set, nr_of_dpus);
+        DPU_ASSERT(dpu_free(dpu_set));
+        return status ? 0 : -1;
+    }
+
+    // Linear-memory modes: only block boundaries on the host
+    if (p.memory_mode != NW_FULL_MATRIX) {
+        bool status = nw_linear(p, dpu_set, nr_of_dpus);
+        DPU_ASSERT(dpu_free(dpu_set));
+        return status ? 0 : -1;
+    }
 
     uint64_t max_rows = p.max_rows + 1;
     uint64_t max_cols = p.max_rows + 1;
@@ -221,9 +1248,37 @@ int main(int argc, char **argv) {
     unsigned int blocks_per_dpu;
     unsigned int mram_offset = 0;
 
+    // Boundary exchange: only the boundaries of each block are transferred between diagonals, and the blocks stay
+    // resident in MRAM until the whole matrix is gathered. Reallocation mode loses MRAM between diagonals
+    uint32_t n_blocks = (max_cols-1)/BL;
+    uint32_t band_blocks = p.band ? (p.band + BL - 1) / BL : n_blocks;
+    nw_exchange_t exchange;
+    bool exchange_on = p.boundary_exchange;
+    if (exchange_on && p.realloc_dpus) {
+        printf("Boundary exchange disabled: DPUs are reallocated between diagonals\n");
+        exchange_on = false;
+    } else if (exchange_on && !nw_exchange_init(&exchange, dpu_set, nr_of_dpus, n_blocks, band_blocks)) {
+        printf("Boundary exchange disabled: the blocks do not fit in MRAM\n");
+        exchange_on = false;
+    }
+    printf("CPU-DPU exchange: %s\n", exchange_on ? "block boundaries" : "block rows");
+    if (band_blocks < n_blocks) {
+        printf("Band: %u cells, %u block diagonals on each side of the main one\n", p.band, band_blocks);
+        if (!exchange_on) {
+            fprintf(stderr, "Banded mode needs the boundary exchange!\n");
+            DPU_ASSERT(dpu_free(dpu_set));
+            return -1;
+        }
+    }
+    bool wavefront = use_wavefront(p);
+    printf("DPU kernel: %s\n", wavefront ? "16-bit wavefront" : "32-bit sub-blocks");
+    xfer_stats_t xfer_stats;
+
     // Timer
     Timer timer; 
     Timer long_diagonal_timer; 
+    Timer alloc_timer;
+    alloc_timer.time[0] = 0.0;
 #if ENERGY
     double tacc_energy, tacc_time, tavg_time;
     double tavg_energy=0;
@@ -231,6 +1286,11 @@ int main(int argc, char **argv) {
 
     for (unsigned int rep = 0; rep < p.n_warmup + p.n_reps; rep++) {
 
+        xfer_stats.calls = 0;
+        xfer_stats.bytes = 0;
+        if (exchange_on)
+            memset(exchange.resident_blocks, 0, nr_of_dpus * sizeof(uint32_t));
+
         // Initializing inputs are needed at each iteration
         // Initialize input itemsets
         for(unsigned int i = 0; i < max_rows; i++) {
@@ -245,7 +1305,7 @@ int main(int argc, char **argv) {
             }
         }
 
-        // Define random sequences
+        // Define random sequences: sequence A down the first column, then sequence B along the first row
         srand(7);
         for (unsigned int i = 1; i < max_rows; i++) {
             input_itemsets_host[i * max_cols] = rand() % 10 + 1;
@@ -257,7 +1317,7 @@ int main(int argc, char **argv) {
 
         for (unsigned int i = 0; i < max_rows-1; i++) {
             for (unsigned int j = 0; j < max_cols-1; j++) {
-                reference[i * (max_cols-1) + j] = blosum62[input_itemsets[(i+1) * max_cols]][input_itemsets[j+1]];
+                reference[i * (max_cols-1) + j] = blosum62[input_itemsets_host[(i+1) * max_cols]][input_itemsets_host[j+1]];
             }
         }
 
@@ -271,10 +1331,23 @@ int main(int argc, char **argv) {
             input_itemsets[j] = -j * penalty;
         }
 
+        // Banded mode: the blocks outside the band are never computed
+        if (band_blocks < n_blocks) {
+            for (uint64_t i = 1; i < max_rows; i++) {
+                for (uint64_t j = 1; j < max_cols; j++) {
+                    uint64_t b_index_y = (i-1) / BL, b_index_x = (j-1) / BL;
+                    if (b_index_x > b_index_y + band_blocks || b_index_y > b_index_x + band_blocks) {
+                        input_itemsets_host[i * max_cols + j] = BAND_NEG_INF;
+                        input_itemsets[i * (max_cols+1) + j] = BAND_NEG_INF;
+                    }
+                }
+            }
+        }
+
         if (rep >= p.n_warmup)
             start(&timer, 0, rep - p.n_warmup);
         // Computation on host CPU
-        nw_host(input_itemsets_host, reference, max_cols, penalty);
+        nw_host(input_itemsets_host, reference, max_cols, penalty, band_blocks);
 
         // Print host output
 #if PRINT_FILE
@@ -288,34 +1361,44 @@ int main(int argc, char **argv) {
 
         // Top-left computation on DPUs
         for (unsigned int blk = 1; blk <= (max_cols-1)/BL; blk++) {
-#if DYNAMIC 
-            // If nr_of_blocks are lower than max_dpus,
-            // set nr_of_dpus to be equal with nr_of_blocks
-            unsigned nr_of_blocks = blk;
-            if (nr_of_blocks < max_dpus) {
-                DPU_ASSERT(dpu_free(dpu_set));
-                DPU_ASSERT(dpu_alloc(nr_of_blocks, NULL, &dpu_set));
-                DPU_ASSERT(dpu_load(dpu_set, DPU_BINARY, NULL));
-                DPU_ASSERT(dpu_get_nr_dpus(dpu_set, &nr_of_dpus));
-            } else if (nr_of_dpus == max_dpus) {
-                ;
-            } else {
-                DPU_ASSERT(dpu_free(dpu_set));
-                DPU_ASSERT(dpu_alloc(max_dpus, NULL, &dpu_set));
-                DPU_ASSERT(dpu_load(dpu_set, DPU_BINARY, NULL));
-                DPU_ASSERT(dpu_get_nr_dpus(dpu_set, &nr_of_dpus));
-            }
+            // Reallocation mode: free and reload the DPUs whenever the # of DPUs needed changes.
+            // Otherwise all DPUs stay allocated and those without blocks on this diagonal get nblocks = 0 and dummy transfers
+            if (p.realloc_dpus) {
+                if (rep >= p.n_warmup)
+                    start(&alloc_timer, 0, rep - p.n_warmup + blk - 1);
+                // If nr_of_blocks are lower than max_dpus,
+                // set nr_of_dpus to be equal with nr_of_blocks
+                unsigned nr_of_blocks = blk;
+                if (nr_of_blocks < max_dpus) {
+                    DPU_ASSERT(dpu_free(dpu_set));
+                    DPU_ASSERT(dpu_alloc(nr_of_blocks, NULL, &dpu_set));
+                    DPU_ASSERT(dpu_load(dpu_set, DPU_BINARY, NULL));
+                    DPU_ASSERT(dpu_get_nr_dpus(dpu_set, &nr_of_dpus));
+                } else if (nr_of_dpus == max_dpus) {
+                    ;
+                } else {
+                    DPU_ASSERT(dpu_free(dpu_set));
+                    DPU_ASSERT(dpu_alloc(max_dpus, NULL, &dpu_set));
+                    DPU_ASSERT(dpu_load(dpu_set, DPU_BINARY, NULL));
+                    DPU_ASSERT(dpu_get_nr_dpus(dpu_set, &nr_of_dpus));
+                }
 #if PRINT
-            printf("Allocated %d DPU(s) for %d (%d) blocks\n", nr_of_dpus, nr_of_blocks, blk);
-#endif
+                printf("Allocated %d DPU(s) for %d (%d) blocks\n", nr_of_dpus, nr_of_blocks, blk);
 #endif
+                if (rep >= p.n_warmup)
+                    stop(&alloc_timer, 0);
+            }
+
+            // Blocks of this diagonal: the t-th is (diag_x + t, diag_y - t)
+            uint32_t diag_blocks = blk, diag_x = 0, diag_y = blk - 1;
+            band_clip(&diag_blocks, &diag_x, &diag_y, band_blocks);
 
             // Copy data to DPUs
             unsigned int i=0;
             DPU_FOREACH(dpu_set, dpu, i) {
-                unsigned int blocks_per_dpu = blk / nr_of_dpus;
-                unsigned int active_blocks_per_dpu = blk / nr_of_dpus;
-                unsigned int rest_blocks = blk % nr_of_dpus;
+                unsigned int blocks_per_dpu = diag_blocks / nr_of_dpus;
+                unsigned int active_blocks_per_dpu = diag_blocks / nr_of_dpus;
+                unsigned int rest_blocks = diag_blocks % nr_of_dpus;
                 if(i < rest_blocks)
                     blocks_per_dpu++;
 
@@ -326,9 +1409,15 @@ int main(int argc, char **argv) {
                 input_args[i].nblocks = blocks_per_dpu;
                 input_args[i].active_blocks = active_blocks_per_dpu;
                 input_args[i].penalty = penalty;
+                input_args[i].mode = NW_BLOCKS;
+                input_args[i].batch_slots = 0;
+                input_args[i].boundaries = exchange_on;
+                input_args[i].work_offset = exchange_on ? exchange.work_offset + exchange.resident_blocks[i] * (BL+1) * (BL+2) * sizeof(int32_t) : 0;
+                input_args[i].wavefront = wavefront;
                 DPU_ASSERT(dpu_prepare_xfer(dpu, input_args + i));
             } 
             DPU_ASSERT(dpu_push_xfer(dpu_set, DPU_XFER_TO_DPU, "DPU_INPUT_ARGUMENTS", 0, sizeof(dpu_arguments_t), DPU_XFER_DEFAULT));
+            count_xfer(&xfer_stats, nr_of_dpus, sizeof(dpu_arguments_t));
 
             // Copy itemsets to DPUs
             blocks_per_dpu = blk / nr_of_dpus;
@@ -357,45 +1446,52 @@ int main(int argc, char **argv) {
             total_dpu_memory = (uint64_t) blocks_per_dpu * (BL+1) * (BL+2) * sizeof(int32_t) + (uint64_t) blocks_per_dpu * BL * BL * sizeof(int32_t);
             printf("Total memory allocated in each DPU %u bytes\n", total_dpu_memory);
 #endif
-            for (unsigned int bl_indx = 0; bl_indx < blocks_per_dpu; bl_indx++) {
-                for (unsigned int bl = 0; bl < BL + 1; bl++) {
-
-                    i = 0;
-                    DPU_FOREACH(dpu_set, dpu, i) {
-                        unsigned int chunks = blk / nr_of_dpus;
-                        unsigned int prev_block_index = 0;
-                        unsigned int rest_blocks = blk % nr_of_dpus;
-                        if (rest_blocks > 0) {
-                            if (i >= rest_blocks) {
-                                prev_block_index = rest_blocks * (chunks + 1) + (i - rest_blocks) * chunks;
+            if (exchange_on) {
+                stage_boundaries(&exchange, input_itemsets, max_cols, diag_blocks, diag_x, diag_y);
+            } else {
+                for (unsigned int bl_indx = 0; bl_indx < blocks_per_dpu; bl_indx++) {
+                    for (unsigned int bl = 0; bl < BL + 1; bl++) {
+
+                        i = 0;
+                        DPU_FOREACH(dpu_set, dpu, i) {
+                            unsigned int chunks = blk / nr_of_dpus;
+                            unsigned int prev_block_index = 0;
+                            unsigned int rest_blocks = blk % nr_of_dpus;
+                            if (rest_blocks > 0) {
+                                if (i >= rest_blocks) {
+                                    prev_block_index = rest_blocks * (chunks + 1) + (i - rest_blocks) * chunks;
+                                } else {
+                                    prev_block_index = i * (chunks + 1);
+                                }
                             } else {
-                                prev_block_index = i * (chunks + 1);
+                                prev_block_index = i * blocks_per_dpu; 
                             }
-                        } else {
-                            prev_block_index = i * blocks_per_dpu; 
+
+                            uint64_t input_itemsets_offset = 0;  
+                            int32_t *dpu_pointer;  
+                            if (i + bl_indx * nr_of_dpus >= blk) {
+                                dpu_pointer = dummy;
+                                input_itemsets_offset = 0;  
+                            } else {
+                                uint64_t b_index_x =  prev_block_index + bl_indx;
+                                uint64_t b_index_y = blk - 1 - b_index_x;
+                                dpu_pointer = input_itemsets;
+                                input_itemsets_offset = b_index_y * (max_cols+1) * BL + b_index_x * BL + bl * (max_cols + 1);  
+                            }
+
+                            DPU_ASSERT(dpu_prepare_xfer(dpu, dpu_pointer + input_itemsets_offset));
                         }
 
-                        uint64_t input_itemsets_offset = 0;  
-                        int32_t *dpu_pointer;  
-                        if (i + bl_indx * nr_of_dpus >= blk) {
-                            dpu_pointer = dummy;
-                            input_itemsets_offset = 0;  
+                        if (bl == 0) {
+                            DPU_ASSERT(dpu_push_xfer(dpu_set, DPU_XFER_TO_DPU, DPU_MRAM_HEAP_POINTER_NAME, mram_offset, (BL+2) * sizeof(int32_t), DPU_XFER_DEFAULT));
+                            count_xfer(&xfer_stats, nr_of_dpus, (BL+2) * sizeof(int32_t));
                         } else {
-                            uint64_t b_index_x =  prev_block_index + bl_indx;
-                            uint64_t b_index_y = blk - 1 - b_index_x;
-                            dpu_pointer = input_itemsets;
-                            input_itemsets_offset = b_index_y * (max_cols+1) * BL + b_index_x * BL + bl * (max_cols + 1);  
+                            DPU_ASSERT(dpu_push_xfer(dpu_set, DPU_XFER_TO_DPU, DPU_MRAM_HEAP_POINTER_NAME, mram_offset, 2 * sizeof(int32_t), DPU_XFER_DEFAULT));
+                            count_xfer(&xfer_stats, nr_of_dpus, 2 * sizeof(int32_t));
                         }
+                        mram_offset += ((BL+2) * sizeof(int32_t));
 
-                        DPU_ASSERT(dpu_prepare_xfer(dpu, dpu_pointer + input_itemsets_offset));
                     }
-
-                    if (bl == 0) 
-                        DPU_ASSERT(dpu_push_xfer(dpu_set, DPU_XFER_TO_DPU, DPU_MRAM_HEAP_POINTER_NAME, mram_offset, (BL+2) * sizeof(int32_t), DPU_XFER_DEFAULT));
-                    else
-                        DPU_ASSERT(dpu_push_xfer(dpu_set, DPU_XFER_TO_DPU, DPU_MRAM_HEAP_POINTER_NAME, mram_offset, 2 * sizeof(int32_t), DPU_XFER_DEFAULT));
-                    mram_offset += ((BL+2) * sizeof(int32_t));
-
                 }
             }
             if (rep >= p.n_warmup) {
@@ -422,41 +1518,46 @@ int main(int argc, char **argv) {
             }
             // Copy reference to DPUs
             mram_offset = blocks_per_dpu * (BL+1) * (BL+2) * sizeof(int32_t); 
-            for (unsigned int bl_indx = 0; bl_indx < blocks_per_dpu; bl_indx++) {
-                for (unsigned int bl = 0; bl < BL; bl++) {
-
-                    i = 0;
-                    DPU_FOREACH(dpu_set, dpu, i) {
-                        unsigned int chunks = blk / nr_of_dpus;
-                        unsigned int prev_block_index = 0;
-                        unsigned int rest_blocks = blk % nr_of_dpus;
-                        if (rest_blocks > 0) {
-                            if (i >= rest_blocks) {
-                                prev_block_index = rest_blocks * (chunks + 1) + (i - rest_blocks) * chunks;
+            if (exchange_on) {
+                push_blocks(&exchange, reference, max_cols, diag_blocks, diag_x, diag_y, &xfer_stats);
+            } else {
+                for (unsigned int bl_indx = 0; bl_indx < blocks_per_dpu; bl_indx++) {
+                    for (unsigned int bl = 0; bl < BL; bl++) {
+
+                        i = 0;
+                        DPU_FOREACH(dpu_set, dpu, i) {
+                            unsigned int chunks = blk / nr_of_dpus;
+                            unsigned int prev_block_index = 0;
+                            unsigned int rest_blocks = blk % nr_of_dpus;
+                            if (rest_blocks > 0) {
+                                if (i >= rest_blocks) {
+                                    prev_block_index = rest_blocks * (chunks + 1) + (i - rest_blocks) * chunks;
+                                } else {
+                                    prev_block_index = i * (chunks + 1);
+                                }
                             } else {
-                                prev_block_index = i * (chunks + 1);
+                                prev_block_index = i * blocks_per_dpu; 
                             }
-                        } else {
-                            prev_block_index = i * blocks_per_dpu; 
-                        }
 
-                        uint64_t reference_offset = 0;  
-                        int32_t *dpu_pointer;  
-                        if (i + bl_indx * nr_of_dpus >= blk) {
-                            dpu_pointer = dummy;
-                            reference_offset = 0;  
-                        } else {
-                            uint64_t b_index_x =  prev_block_index + bl_indx;
-                            uint64_t b_index_y = blk - 1 - b_index_x;
-                            dpu_pointer = reference;
-                            reference_offset = b_index_y * (max_cols - 1) * BL + b_index_x * BL + bl * (max_cols - 1);  
+                            uint64_t reference_offset = 0;  
+                            int32_t *dpu_pointer;  
+                            if (i + bl_indx * nr_of_dpus >= blk) {
+                                dpu_pointer = dummy;
+                                reference_offset = 0;  
+                            } else {
+                                uint64_t b_index_x =  prev_block_index + bl_indx;
+                                uint64_t b_index_y = blk - 1 - b_index_x;
+                                dpu_pointer = reference;
+                                reference_offset = b_index_y * (max_cols - 1) * BL + b_index_x * BL + bl * (max_cols - 1);  
+                            }
+
+                            DPU_ASSERT(dpu_prepare_xfer(dpu, dpu_pointer + reference_offset));
                         }
+                        DPU_ASSERT(dpu_push_xfer(dpu_set, DPU_XFER_TO_DPU, DPU_MRAM_HEAP_POINTER_NAME, mram_offset, BL * sizeof(int32_t), DPU_XFER_DEFAULT));
+                        count_xfer(&xfer_stats, nr_of_dpus, BL * sizeof(int32_t));
+                        mram_offset += BL * sizeof(int32_t);
 
-                        DPU_ASSERT(dpu_prepare_xfer(dpu, dpu_pointer + reference_offset));
                     }
-                    DPU_ASSERT(dpu_push_xfer(dpu_set, DPU_XFER_TO_DPU, DPU_MRAM_HEAP_POINTER_NAME, mram_offset, BL * sizeof(int32_t), DPU_XFER_DEFAULT));
-                    mram_offset += BL * sizeof(int32_t);
-
                 }
             }
             if (rep >= p.n_warmup) {
@@ -519,48 +1620,53 @@ int main(int argc, char **argv) {
             // Retrieve results
             // Copy output result to Host CPU
             mram_offset = 0;
-            for (unsigned int bl_indx = 0; bl_indx < blocks_per_dpu; bl_indx++) {
-                for (unsigned int bl = 0; bl < BL + 1; bl++) {
-
-                    i = 0;
-                    DPU_FOREACH(dpu_set, dpu, i) {
-                        unsigned int chunks = blk / nr_of_dpus;
-                        unsigned int prev_block_index = 0;
-                        unsigned int rest_blocks = blk % nr_of_dpus;
-                        if (rest_blocks > 0) {
-                            if (i >= rest_blocks) {
-                                prev_block_index = rest_blocks * (chunks + 1) + (i - rest_blocks) * chunks;
+            if (exchange_on) {
+                pull_boundaries(&exchange, input_itemsets, max_cols, diag_blocks, diag_x, diag_y, &xfer_stats);
+            } else {
+                for (unsigned int bl_indx = 0; bl_indx < blocks_per_dpu; bl_indx++) {
+                    for (unsigned int bl = 0; bl < BL + 1; bl++) {
+
+                        i = 0;
+                        DPU_FOREACH(dpu_set, dpu, i) {
+                            unsigned int chunks = blk / nr_of_dpus;
+                            unsigned int prev_block_index = 0;
+                            unsigned int rest_blocks = blk % nr_of_dpus;
+                            if (rest_blocks > 0) {
+                                if (i >= rest_blocks) {
+                                    prev_block_index = rest_blocks * (chunks + 1) + (i - rest_blocks) * chunks;
+                                } else {
+                                    prev_block_index = i * (chunks + 1);
+                                }
                             } else {
-                                prev_block_index = i * (chunks + 1);
+                                prev_block_index = i * blocks_per_dpu; 
                             }
-                        } else {
-                            prev_block_index = i * blocks_per_dpu; 
-                        }
 
-                        uint64_t input_itemsets_offset = 0;  
-                        int32_t *dpu_pointer;  
-                        if (i + bl_indx * nr_of_dpus >= blk) {
-                            dpu_pointer = dummy;
-                            input_itemsets_offset = 0;  
-                        } else {
-                            uint64_t b_index_x =  prev_block_index + bl_indx;
-                            uint64_t b_index_y = blk - 1 - b_index_x;
-                            dpu_pointer = input_itemsets;
-                            input_itemsets_offset = b_index_y * (max_cols+1) * BL + b_index_x * BL + bl * (max_cols + 1);  
-                        }
+                            uint64_t input_itemsets_offset = 0;  
+                            int32_t *dpu_pointer;  
+                            if (i + bl_indx * nr_of_dpus >= blk) {
+                                dpu_pointer = dummy;
+                                input_itemsets_offset = 0;  
+                            } else {
+                                uint64_t b_index_x =  prev_block_index + bl_indx;
+                                uint64_t b_index_y = blk - 1 - b_index_x;
+                                dpu_pointer = input_itemsets;
+                                input_itemsets_offset = b_index_y * (max_cols+1) * BL + b_index_x * BL + bl * (max_cols + 1);  
+                            }
 
-                        if (bl == 0) // Skip the first row of the block
-                            continue;
-                        DPU_ASSERT(dpu_prepare_xfer(dpu, dpu_pointer + input_itemsets_offset));
+                            if (bl == 0) // Skip the first row of the block
+                                continue;
+                            DPU_ASSERT(dpu_prepare_xfer(dpu, dpu_pointer + input_itemsets_offset));
 
-                    }
-                    if (bl == 0) {
+                        }
+                        if (bl == 0) {
+                            mram_offset += (BL+2) * sizeof(int32_t);
+                            continue;
+                        }
+                        DPU_ASSERT(dpu_push_xfer(dpu_set, DPU_XFER_FROM_DPU, DPU_MRAM_HEAP_POINTER_NAME, mram_offset, (BL+2) * sizeof(int32_t), DPU_XFER_DEFAULT));
+                        count_xfer(&xfer_stats, nr_of_dpus, (BL+2) * sizeof(int32_t));
                         mram_offset += (BL+2) * sizeof(int32_t);
-                        continue;
-                    }
-                    DPU_ASSERT(dpu_push_xfer(dpu_set, DPU_XFER_FROM_DPU, DPU_MRAM_HEAP_POINTER_NAME, mram_offset, (BL+2) * sizeof(int32_t), DPU_XFER_DEFAULT));
-                    mram_offset += (BL+2) * sizeof(int32_t);
 
+                    }
                 }
             }
             if (rep >= p.n_warmup) {
@@ -575,34 +1681,44 @@ int main(int argc, char **argv) {
 
         // Bottom-right computation on DPUs
         for (unsigned int blk = 2; blk <= (max_cols-1)/BL; blk++) {
-#if DYNAMIC
-            // If nr_of_blocks are lower than max_dpus,
-            // set nr_of_dpus to be equal with nr_of_blocks
-            unsigned nr_of_blocks = (((max_cols-1)/BL) - blk + 1);
-            if (nr_of_blocks < max_dpus) {
-                DPU_ASSERT(dpu_free(dpu_set));
-                DPU_ASSERT(dpu_alloc(nr_of_blocks, NULL, &dpu_set));
-                DPU_ASSERT(dpu_load(dpu_set, DPU_BINARY, NULL));
-                DPU_ASSERT(dpu_get_nr_dpus(dpu_set, &nr_of_dpus));
-            } else if (nr_of_dpus == max_dpus) {
-                ;
-            } else {
-                DPU_ASSERT(dpu_free(dpu_set));
-                DPU_ASSERT(dpu_alloc(max_dpus, NULL, &dpu_set));
-                DPU_ASSERT(dpu_load(dpu_set, DPU_BINARY, NULL));
-                DPU_ASSERT(dpu_get_nr_dpus(dpu_set, &nr_of_dpus));
-            }
+            // Reallocation mode: free and reload the DPUs whenever the # of DPUs needed changes.
+            // Otherwise all DPUs stay allocated and those without blocks on this diagonal get nblocks = 0 and dummy transfers
+            if (p.realloc_dpus) {
+                if (rep >= p.n_warmup)
+                    start(&alloc_timer, 0, rep - p.n_warmup + blk - 1);
+                // If nr_of_blocks are lower than max_dpus,
+                // set nr_of_dpus to be equal with nr_of_blocks
+                unsigned nr_of_blocks = (((max_cols-1)/BL) - blk + 1);
+                if (nr_of_blocks < max_dpus) {
+                    DPU_ASSERT(dpu_free(dpu_set));
+                    DPU_ASSERT(dpu_alloc(nr_of_blocks, NULL, &dpu_set));
+                    DPU_ASSERT(dpu_load(dpu_set, DPU_BINARY, NULL));
+                    DPU_ASSERT(dpu_get_nr_dpus(dpu_set, &nr_of_dpus));
+                } else if (nr_of_dpus == max_dpus) {
+                    ;
+                } else {
+                    DPU_ASSERT(dpu_free(dpu_set));
+                    DPU_ASSERT(dpu_alloc(max_dpus, NULL, &dpu_set));
+                    DPU_ASSERT(dpu_load(dpu_set, DPU_BINARY, NULL));
+                    DPU_ASSERT(dpu_get_nr_dpus(dpu_set, &nr_of_dpus));
+                }
 #if PRINT
-            printf("Allocated %d DPU(s) for %d (%d) blocks\n", nr_of_dpus, nr_of_blocks, (((max_cols-1)/BL) - blk + 1));
-#endif
+                printf("Allocated %d DPU(s) for %d (%d) blocks\n", nr_of_dpus, nr_of_blocks, (((max_cols-1)/BL) - blk + 1));
 #endif
+                if (rep >= p.n_warmup)
+                    stop(&alloc_timer, 0);
+            }
+
+            // Blocks of this diagonal: the t-th is (diag_x + t, diag_y - t)
+            uint32_t diag_blocks = n_blocks - blk + 1, diag_x = blk - 1, diag_y = n_blocks - 1;
+            band_clip(&diag_blocks, &diag_x, &diag_y, band_blocks);
 
             // Copy data to DPUs
             unsigned int i=0;
             DPU_FOREACH(dpu_set, dpu, i) {
-                unsigned int blocks_per_dpu = (((max_cols-1)/BL) - blk + 1) / nr_of_dpus;
-                unsigned int active_blocks_per_dpu = (((max_cols-1)/BL) - blk + 1) / nr_of_dpus;
-                unsigned int rest_blocks = (((max_cols-1)/BL) - blk + 1) % nr_of_dpus;
+                unsigned int blocks_per_dpu = diag_blocks / nr_of_dpus;
+                unsigned int active_blocks_per_dpu = diag_blocks / nr_of_dpus;
+                unsigned int rest_blocks = diag_blocks % nr_of_dpus;
                 if(i < rest_blocks)
                     blocks_per_dpu++;
 
@@ -613,9 +1729,15 @@ int main(int argc, char **argv) {
                 input_args[i].nblocks = blocks_per_dpu;
                 input_args[i].active_blocks = active_blocks_per_dpu;
                 input_args[i].penalty = penalty;
+                input_args[i].mode = NW_BLOCKS;
+                input_args[i].batch_slots = 0;
+                input_args[i].boundaries = exchange_on;
+                input_args[i].work_offset = exchange_on ? exchange.work_offset + exchange.resident_blocks[i] * (BL+1) * (BL+2) * sizeof(int32_t) : 0;
+                input_args[i].wavefront = wavefront;
                 DPU_ASSERT(dpu_prepare_xfer(dpu, input_args + i));
             } 
             DPU_ASSERT(dpu_push_xfer(dpu_set, DPU_XFER_TO_DPU, "DPU_INPUT_ARGUMENTS", 0, sizeof(dpu_arguments_t), DPU_XFER_DEFAULT));
+            count_xfer(&xfer_stats, nr_of_dpus, sizeof(dpu_arguments_t));
 
             if (rep >= p.n_warmup)
                 start(&timer, 1, rep - p.n_warmup + blk - 1);
@@ -629,45 +1751,52 @@ int main(int argc, char **argv) {
             printf("Total memory allocated in each DPU %u bytes\n", total_dpu_memory);
 #endif
             unsigned int mram_offset = 0;
-            for (unsigned int bl_indx = 0; bl_indx < blocks_per_dpu; bl_indx++) {
-                for (unsigned int bl = 0; bl < BL + 1; bl++) {
-
-                    i = 0;
-                    DPU_FOREACH(dpu_set, dpu, i) {
-                        unsigned int chunks = (((max_cols-1)/BL) - blk + 1) / nr_of_dpus;
-                        unsigned int prev_block_index = 0;
-                        unsigned int rest_blocks = (((max_cols-1)/BL) - blk + 1) % nr_of_dpus;
-                        if (rest_blocks > 0) {
-                            if (i >= rest_blocks) {
-                                prev_block_index = rest_blocks * (chunks + 1) + (i - rest_blocks) * chunks;
+            if (exchange_on) {
+                stage_boundaries(&exchange, input_itemsets, max_cols, diag_blocks, diag_x, diag_y);
+            } else {
+                for (unsigned int bl_indx = 0; bl_indx < blocks_per_dpu; bl_indx++) {
+                    for (unsigned int bl = 0; bl < BL + 1; bl++) {
+
+                        i = 0;
+                        DPU_FOREACH(dpu_set, dpu, i) {
+                            unsigned int chunks = (((max_cols-1)/BL) - blk + 1) / nr_of_dpus;
+                            unsigned int prev_block_index = 0;
+                            unsigned int rest_blocks = (((max_cols-1)/BL) - blk + 1) % nr_of_dpus;
+                            if (rest_blocks > 0) {
+                                if (i >= rest_blocks) {
+                                    prev_block_index = rest_blocks * (chunks + 1) + (i - rest_blocks) * chunks;
+                                } else {
+                                    prev_block_index = i * (chunks + 1);
+                                }
                             } else {
-                                prev_block_index = i * (chunks + 1);
+                                prev_block_index = i * blocks_per_dpu; 
                             }
-                        } else {
-                            prev_block_index = i * blocks_per_dpu; 
+
+                            uint64_t input_itemsets_offset = 0;  
+                            int32_t *dpu_pointer;  
+                            if (i + bl_indx * nr_of_dpus >= (((max_cols-1)/BL) - blk + 1)) {
+                                dpu_pointer = dummy;
+                                input_itemsets_offset = 0;  
+                            } else {
+                                uint64_t b_index_x = blk - 1 + prev_block_index + bl_indx;
+                                uint64_t b_index_y = (max_cols-1)/BL + blk - 2 - b_index_x;
+                                dpu_pointer = input_itemsets;
+                                input_itemsets_offset = b_index_y * (max_cols+1) * BL + b_index_x * BL + bl * (max_cols + 1);  
+                            }
+
+                            DPU_ASSERT(dpu_prepare_xfer(dpu, dpu_pointer + input_itemsets_offset));
                         }
 
-                        uint64_t input_itemsets_offset = 0;  
-                        int32_t *dpu_pointer;  
-                        if (i + bl_indx * nr_of_dpus >= (((max_cols-1)/BL) - blk + 1)) {
-                            dpu_pointer = dummy;
-                            input_itemsets_offset = 0;  
+                        if (bl == 0) {
+                            DPU_ASSERT(dpu_push_xfer(dpu_set, DPU_XFER_TO_DPU, DPU_MRAM_HEAP_POINTER_NAME, mram_offset, (BL+2) * sizeof(int32_t), DPU_XFER_DEFAULT));
+                            count_xfer(&xfer_stats, nr_of_dpus, (BL+2) * sizeof(int32_t));
                         } else {
-                            uint64_t b_index_x = blk - 1 + prev_block_index + bl_indx;
-                            uint64_t b_index_y = (max_cols-1)/BL + blk - 2 - b_index_x;
-                            dpu_pointer = input_itemsets;
-                            input_itemsets_offset = b_index_y * (max_cols+1) * BL + b_index_x * BL + bl * (max_cols + 1);  
+                            DPU_ASSERT(dpu_push_xfer(dpu_set, DPU_XFER_TO_DPU, DPU_MRAM_HEAP_POINTER_NAME, mram_offset, 2 * sizeof(int32_t), DPU_XFER_DEFAULT));
+                            count_xfer(&xfer_stats, nr_of_dpus, 2 * sizeof(int32_t));
                         }
+                        mram_offset += (BL+2) * sizeof(int32_t);
 
-                        DPU_ASSERT(dpu_prepare_xfer(dpu, dpu_pointer + input_itemsets_offset));
                     }
-
-                    if (bl == 0) 
-                        DPU_ASSERT(dpu_push_xfer(dpu_set, DPU_XFER_TO_DPU, DPU_MRAM_HEAP_POINTER_NAME, mram_offset, (BL+2) * sizeof(int32_t), DPU_XFER_DEFAULT));
-                    else
-                        DPU_ASSERT(dpu_push_xfer(dpu_set, DPU_XFER_TO_DPU, DPU_MRAM_HEAP_POINTER_NAME, mram_offset, 2 * sizeof(int32_t), DPU_XFER_DEFAULT));
-                    mram_offset += (BL+2) * sizeof(int32_t);
-
                 }
             }
             if (rep >= p.n_warmup)
@@ -678,42 +1807,47 @@ int main(int argc, char **argv) {
                 start(&timer, 2, rep - p.n_warmup + blk - 1);
             // Copy reference to DPUs
             mram_offset = blocks_per_dpu * (BL+1) * (BL+2) * sizeof(int32_t); 
-            for (unsigned int bl_indx = 0; bl_indx < blocks_per_dpu; bl_indx++) {
-                for (unsigned int bl = 0; bl < BL; bl++) {
-
-                    i = 0;
-                    DPU_FOREACH(dpu_set, dpu, i) {
-                        unsigned int chunks = (((max_cols-1)/BL) - blk + 1) / nr_of_dpus;
-                        unsigned int prev_block_index = 0;
-                        unsigned int rest_blocks = (((max_cols-1)/BL) - blk + 1) % nr_of_dpus;
-                        if (rest_blocks > 0) {
-                            if (i >= rest_blocks) {
-                                prev_block_index = rest_blocks * (chunks + 1) + (i - rest_blocks) * chunks;
+            if (exchange_on) {
+                push_blocks(&exchange, reference, max_cols, diag_blocks, diag_x, diag_y, &xfer_stats);
+            } else {
+                for (unsigned int bl_indx = 0; bl_indx < blocks_per_dpu; bl_indx++) {
+                    for (unsigned int bl = 0; bl < BL; bl++) {
+
+                        i = 0;
+                        DPU_FOREACH(dpu_set, dpu, i) {
+                            unsigned int chunks = (((max_cols-1)/BL) - blk + 1) / nr_of_dpus;
+                            unsigned int prev_block_index = 0;
+                            unsigned int rest_blocks = (((max_cols-1)/BL) - blk + 1) % nr_of_dpus;
+                            if (rest_blocks > 0) {
+                                if (i >= rest_blocks) {
+                                    prev_block_index = rest_blocks * (chunks + 1) + (i - rest_blocks) * chunks;
+                                } else {
+                                    prev_block_index = i * (chunks + 1);
+                                }
                             } else {
-                                prev_block_index = i * (chunks + 1);
+                                prev_block_index = i * blocks_per_dpu; 
                             }
-                        } else {
-                            prev_block_index = i * blocks_per_dpu; 
-                        }
 
-                        uint64_t reference_offset = 0;  
-                        int32_t *dpu_pointer;  
-                        if (i + bl_indx * nr_of_dpus >= (((max_cols-1)/BL) - blk + 1)) {
-                            dpu_pointer = dummy;
-                            reference_offset = 0;  
-                        } else {
-                            uint64_t b_index_x = blk - 1 + prev_block_index + bl_indx;
-                            uint64_t b_index_y = (max_cols-1)/BL + blk - 2 - b_index_x;
-                            dpu_pointer = reference;
-                            reference_offset = b_index_y * (max_cols - 1) * BL + b_index_x * BL + bl * (max_cols - 1);  
-                        }
+                            uint64_t reference_offset = 0;  
+                            int32_t *dpu_pointer;  
+                            if (i + bl_indx * nr_of_dpus >= (((max_cols-1)/BL) - blk + 1)) {
+                                dpu_pointer = dummy;
+                                reference_offset = 0;  
+                            } else {
+                                uint64_t b_index_x = blk - 1 + prev_block_index + bl_indx;
+                                uint64_t b_index_y = (max_cols-1)/BL + blk - 2 - b_index_x;
+                                dpu_pointer = reference;
+                                reference_offset = b_index_y * (max_cols - 1) * BL + b_index_x * BL + bl * (max_cols - 1);  
+                            }
 
-                        DPU_ASSERT(dpu_prepare_xfer(dpu, dpu_pointer + reference_offset));
-                    }
+                            DPU_ASSERT(dpu_prepare_xfer(dpu, dpu_pointer + reference_offset));
+                        }
 
-                    DPU_ASSERT(dpu_push_xfer(dpu_set, DPU_XFER_TO_DPU, DPU_MRAM_HEAP_POINTER_NAME, mram_offset, BL * sizeof(int32_t), DPU_XFER_DEFAULT));
-                    mram_offset += BL * sizeof(int32_t);
+                        DPU_ASSERT(dpu_push_xfer(dpu_set, DPU_XFER_TO_DPU, DPU_MRAM_HEAP_POINTER_NAME, mram_offset, BL * sizeof(int32_t), DPU_XFER_DEFAULT));
+                        count_xfer(&xfer_stats, nr_of_dpus, BL * sizeof(int32_t));
+                        mram_offset += BL * sizeof(int32_t);
 
+                    }
                 }
             }
             if (rep >= p.n_warmup)
@@ -758,49 +1892,54 @@ int main(int argc, char **argv) {
             // Retrieve results
             // Copy output result to Host CPU
             mram_offset = 0;
-            for (unsigned int bl_indx = 0; bl_indx < blocks_per_dpu; bl_indx++) {
-                for (unsigned int bl = 0; bl < BL + 1; bl++) {
-
-                    i = 0;
-                    DPU_FOREACH(dpu_set, dpu, i) {
-                        unsigned int chunks = (((max_cols-1)/BL) - blk + 1) / nr_of_dpus;
-                        unsigned int prev_block_index = 0;
-                        unsigned int rest_blocks = (((max_cols-1)/BL) - blk + 1) % nr_of_dpus;
-                        if (rest_blocks > 0) {
-                            if (i >= rest_blocks) {
-                                prev_block_index = rest_blocks * (chunks + 1) + (i - rest_blocks) * chunks;
+            if (exchange_on) {
+                pull_boundaries(&exchange, input_itemsets, max_cols, diag_blocks, diag_x, diag_y, &xfer_stats);
+            } else {
+                for (unsigned int bl_indx = 0; bl_indx < blocks_per_dpu; bl_indx++) {
+                    for (unsigned int bl = 0; bl < BL + 1; bl++) {
+
+                        i = 0;
+                        DPU_FOREACH(dpu_set, dpu, i) {
+                            unsigned int chunks = (((max_cols-1)/BL) - blk + 1) / nr_of_dpus;
+                            unsigned int prev_block_index = 0;
+                            unsigned int rest_blocks = (((max_cols-1)/BL) - blk + 1) % nr_of_dpus;
+                            if (rest_blocks > 0) {
+                                if (i >= rest_blocks) {
+                                    prev_block_index = rest_blocks * (chunks + 1) + (i - rest_blocks) * chunks;
+                                } else {
+                                    prev_block_index = i * (chunks + 1);
+                                }
                             } else {
-                                prev_block_index = i * (chunks + 1);
+                                prev_block_index = i * blocks_per_dpu; 
                             }
-                        } else {
-                            prev_block_index = i * blocks_per_dpu; 
-                        }
 
-                        uint64_t input_itemsets_offset = 0;  
-                        int32_t *dpu_pointer;  
-                        if (i + bl_indx * nr_of_dpus >= (((max_cols-1)/BL) - blk + 1)) {
-                            dpu_pointer = dummy;
-                            input_itemsets_offset = 0;  
-                        } else {
-                            uint64_t b_index_x = blk - 1 + prev_block_index + bl_indx;
-                            uint64_t b_index_y = (max_cols-1)/BL + blk - 2 - b_index_x;
-                            dpu_pointer = input_itemsets;
-                            input_itemsets_offset = b_index_y * (max_cols+1) * BL + b_index_x * BL + bl * (max_cols + 1);  
-                        }
+                            uint64_t input_itemsets_offset = 0;  
+                            int32_t *dpu_pointer;  
+                            if (i + bl_indx * nr_of_dpus >= (((max_cols-1)/BL) - blk + 1)) {
+                                dpu_pointer = dummy;
+                                input_itemsets_offset = 0;  
+                            } else {
+                                uint64_t b_index_x = blk - 1 + prev_block_index + bl_indx;
+                                uint64_t b_index_y = (max_cols-1)/BL + blk - 2 - b_index_x;
+                                dpu_pointer = input_itemsets;
+                                input_itemsets_offset = b_index_y * (max_cols+1) * BL + b_index_x * BL + bl * (max_cols + 1);  
+                            }
 
-                        if (bl == 0) // Skip the first row of the block
-                            continue;
-                        DPU_ASSERT(dpu_prepare_xfer(dpu, dpu_pointer + input_itemsets_offset));
+                            if (bl == 0) // Skip the first row of the block
+                                continue;
+                            DPU_ASSERT(dpu_prepare_xfer(dpu, dpu_pointer + input_itemsets_offset));
 
-                    }
+                        }
 
-                    if (bl == 0) {
+                        if (bl == 0) {
+                            mram_offset += (BL+2) * sizeof(int32_t);
+                            continue;
+                        }
+                        DPU_ASSERT(dpu_push_xfer(dpu_set, DPU_XFER_FROM_DPU, DPU_MRAM_HEAP_POINTER_NAME, mram_offset, (BL+2) * sizeof(int32_t), DPU_XFER_DEFAULT));
+                        count_xfer(&xfer_stats, nr_of_dpus, (BL+2) * sizeof(int32_t));
                         mram_offset += (BL+2) * sizeof(int32_t);
-                        continue;
-                    }
-                    DPU_ASSERT(dpu_push_xfer(dpu_set, DPU_XFER_FROM_DPU, DPU_MRAM_HEAP_POINTER_NAME, mram_offset, (BL+2) * sizeof(int32_t), DPU_XFER_DEFAULT));
-                    mram_offset += (BL+2) * sizeof(int32_t);
 
+                    }
                 }
             }
             if (rep >= p.n_warmup)
@@ -809,6 +1948,15 @@ int main(int argc, char **argv) {
 
         }
 
+        // Boundary exchange: retrieve the resident blocks
+        if (exchange_on) {
+            if (rep >= p.n_warmup)
+                start(&timer, 4, 1);
+            gather_blocks(&exchange, input_itemsets, max_cols, &xfer_stats);
+            if (rep >= p.n_warmup)
+                stop(&timer, 4);
+        }
+
         // Traceback step
         if (rep >= p.n_warmup)
             start(&timer, 1, 1);
@@ -844,6 +1992,13 @@ int main(int argc, char **argv) {
     printf("Longest Diagonal DPU-CPU ");
     print(&long_diagonal_timer, 4, p.n_reps);
     printf("\n");
+    if (p.realloc_dpus) {
+        printf("DPU Reallocation ");
+        print(&alloc_timer, 0, p.n_reps);
+        printf("\n");
+    }
+    printf("Total DPU version Time (ms): %f\n", (timer.time[1] + timer.time[2] + timer.time[3] + timer.time[4] + alloc_timer.time[0]) / (1000 * p.n_reps));
+    printf("CPU-DPU transfers per alignment: %lu calls, %f MB\n", (unsigned long) xfer_stats.calls, xfer_stats.bytes / 1e6);
     
 #if ENERGY
     printf("DPU Energy (J): %f \t ", tavg_energy / p.n_reps);
@@ -873,7 +2028,8 @@ int main(int argc, char **argv) {
     free(reference);
     free(traceback_output);
     free(traceback_output_host);
+    if (exchange_on)
+        nw_exchange_free(&exchange);
     DPU_ASSERT(dpu_free(dpu_set));
     return status ? 0 : -1;
-    return 0;
 }
@@ -6,13 +6,78 @@ typedef struct {
     uint32_t nblocks;
     uint32_t active_blocks;
     uint32_t penalty;
-    uint32_t dummy;
+    uint32_t mode;
+    uint32_t batch_slots;
+    uint32_t boundaries;
+    uint32_t work_offset;
+    uint32_t wavefront;
 } dpu_arguments_t;
 
+// Kernel modes
+#define NW_BLOCKS 0 // Blocks of an anti-diagonal of one alignment
+#define NW_BATCH 1  // Whole independent alignments, one per tasklet at a time
+#define NW_BLOCKS_SEQ 2 // Like NW_BLOCKS, with the residues of each block instead of its reference scores
+
 #ifndef BL
 #define BL 16 
 #endif
 
+#define ROUND_UP_TO_MULTIPLE_OF_8(x) ((((x) + 7)/8)*8)
+
+// Boundary exchange (NW_BLOCKS and NW_BLOCKS_SEQ with boundaries set): per block, the host sends the corner and top
+// row (padded to BL+2 values) followed by the left column, and receives the right column followed by the bottom row
+// (with its left value and a padding value). The MRAM of a DPU with active_blocks slots holds the boundaries sent, the
+// reference blocks and the boundaries received, then the itemset blocks at work_offset, which may stay resident.
+#define BOUNDARY_SIZE ((2 * BL + 2) * sizeof(int32_t))
+#define BOUNDARY_CHUNK 256
+
+// Wavefront kernel (NW_BLOCKS and NW_BLOCKS_SEQ with wavefront set): the whole block is kept in WRAM as 16-bit scores
+// relative to its top-left corner and computed an anti-diagonal at a time by all tasklets. Available up to this BL
+#ifndef WAVEFRONT_MAX_BL
+#define WAVEFRONT_MAX_BL 64
+#endif
+
+// Host memory modes of a single alignment
+#define NW_FULL_MATRIX 0 // Full score matrix on the host
+#define NW_SCORE_ONLY 1  // Block boundaries only, O(n) host memory
+#define NW_HIRSCHBERG 2  // Block boundaries only, divide-and-conquer traceback
+
+// NW_BLOCKS_SEQ mode: residues of a block (BL of sequence A, then BL of sequence B), read with a single DMA
+#define BLOCK_SEQ_SIZE (2 * BL)
+
+// Batch mode: longest sequence of a pair (at most 1024, so that a traceback of up to 2 * BATCH_MAX_LEN operations fits
+// the single DMA of at most 2048 bytes that writes it back)
+#ifndef BATCH_MAX_LEN
+#define BATCH_MAX_LEN 256
+#endif
+_Static_assert(BATCH_MAX_LEN <= 1024, "BATCH_MAX_LEN must be at most 1024");
+#define BATCH_SEQ_SLOT ROUND_UP_TO_MULTIPLE_OF_8(BATCH_MAX_LEN)
+#define BATCH_TRACEBACK_SLOT ROUND_UP_TO_MULTIPLE_OF_8(2 * BATCH_MAX_LEN)
+#define BATCH_DIR_STRIDE ROUND_UP_TO_MULTIPLE_OF_8(BATCH_MAX_LEN + 1)
+
+// Batch mode MRAM layout for batch_slots pairs per DPU:
+//   input:   pair_lengths_t[batch_slots], then sequence A and sequence B of each pair (BATCH_SEQ_SLOT bytes each)
+//   output:  pair_result_t[batch_slots], then the traceback of each pair (BATCH_TRACEBACK_SLOT bytes each)
+//   scratch: a (BATCH_MAX_LEN+1) x BATCH_DIR_STRIDE matrix of traceback directions per tasklet
+#define BATCH_INPUT_SIZE(slots) ((slots) * (sizeof(pair_lengths_t) + 2 * BATCH_SEQ_SLOT))
+#define BATCH_OUTPUT_SIZE(slots) ((slots) * (sizeof(pair_result_t) + BATCH_TRACEBACK_SLOT))
+#define BATCH_SCRATCH_SIZE (NR_TASKLETS * (BATCH_MAX_LEN + 1) * BATCH_DIR_STRIDE)
+
+typedef struct {
+    uint32_t len_a;
+    uint32_t len_b;
+} pair_lengths_t;
+
+typedef struct {
+    int32_t score;
+    uint32_t traceback_len;
+} pair_result_t;
+
+// Traceback operations, from the top-left cell to the bottom-right cell
+#define OP_MATCH 'M'  // Consume a residue of both sequences
+#define OP_INSERT 'I' // Consume a residue of sequence A (rows) only
+#define OP_DELETE 'D' // Consume a residue of sequence B (columns) only
+
 // Data type
 #define T int32_t
 
@@ -40,6 +105,9 @@ int32_t maximum(int32_t a, int32_t b, int32_t c) {
 
 #define LIMIT -999
 
+// Banded mode: score of the cells outside the band, low enough to never win a maximum and far from overflowing
+#define BAND_NEG_INF (INT32_MIN / 4)
+
 int blosum62[24][24] = {
     { 4, -1, -2, -2,  0, -1, -1,  0, -2, -1, -1, -1, -1, -2, -1,  1,  0, -3, -2,  0, -2, -1,  0, -4},
     {-1,  5,  0, -2, -3,  1,  0, -2,  0, -3, -2,  2, -1, -3, -2, -1, -1, -3, -2, -3, -1,  0, -1, -4},
@@ -67,7 +135,6 @@ int blosum62[24][24] = {
     {-4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4,  1}
 };
 
-#define DYNAMIC 1
 #define PRINT 0
 #define PRINT_FILE 0
 #ifndef ENERGY
@@ -8,6 +8,14 @@ typedef struct Params {
     unsigned int   penalty;
     unsigned int   n_warmup;
     unsigned int   n_reps;
+    unsigned int   n_pairs;
+    unsigned int   max_len;
+    unsigned int   batch_slots;
+    unsigned int   memory_mode;
+    unsigned int   realloc_dpus;
+    unsigned int   boundary_exchange;
+    unsigned int   wavefront;
+    unsigned int   band;
 } Params;
 
 static void usage() {
@@ -22,6 +30,14 @@ static void usage() {
             "\nBenchmark-specific options:"
             "\n    -n <N>    size of sequence: length of the sequence"
             "\n    -p <P>    penalty: a positive integer"
+            "\n    -m <M>    host memory: 0=full score matrix, 1=score only, 2=Hirschberg traceback; 1 and 2 keep O(n) host memory (default=0)"
+            "\n    -r <R>    diagonals with fewer blocks than DPUs: 0=keep all DPUs allocated, idle ones get no blocks; 1=free, reallocate and reload the DPUs (default=0)"
+            "\n    -x <X>    CPU-DPU exchange of the full score matrix: 0=block rows, one transfer per row; 1=block boundaries, one transfer per DPU and diagonal, blocks kept in MRAM until the last diagonal (default=1)"
+            "\n    -s <S>    DPU kernel of a block: 0=32-bit scores, BL_IN x BL_IN sub-blocks; 1=16-bit scores, whole block in WRAM, one anti-diagonal at a time, when BL <= WAVEFRONT_MAX_BL and the scores fit 16 bits (default=1)"
+            "\n    -k <K>    banded alignment: only the blocks within K cells of the main diagonal are computed, K rounded up to whole blocks; with -m 2, the traceback keeps the boundaries of the blocks of the band, and -n must be a multiple of BL (default=0, whole matrix)"
+            "\n    -b <B>    batch mode: # of independent sequence pairs to align (default=0, one alignment of size -n)"
+            "\n    -l <L>    batch mode: maximum length of the sequences of a pair (default=128, at most BATCH_MAX_LEN)"
+            "\n    -q <Q>    batch mode: # of pairs sent to each DPU per launch (default=512)"
             "\n");
 }
 
@@ -31,9 +47,17 @@ struct Params input_params(int argc, char **argv) {
     p.n_reps        = 3;
     p.max_rows      = 256;
     p.penalty       = 1;
+    p.n_pairs       = 0;
+    p.max_len       = 128;
+    p.batch_slots   = 512;
+    p.memory_mode   = NW_FULL_MATRIX;
+    p.realloc_dpus  = 0;
+    p.boundary_exchange = 1;
+    p.wavefront     = 1;
+    p.band          = 0;
 
     int opt;
-    while((opt = getopt(argc, argv, "hw:e:n:p:")) >= 0) {
+    while((opt = getopt(argc, argv, "hw:e:n:p:m:r:x:s:k:b:l:q:")) >= 0) {
         switch(opt) {
             case 'h':
                 usage();
@@ -43,6 +67,14 @@ struct Params input_params(int argc, char **argv) {
             case 'e': p.n_reps        = atoi(optarg); break;
             case 'n': p.max_rows      = atoi(optarg); break;
             case 'p': p.penalty       = atoi(optarg); break;
+            case 'm': p.memory_mode   = atoi(optarg); break;
+            case 'r': p.realloc_dpus  = atoi(optarg); break;
+            case 'x': p.boundary_exchange = atoi(optarg); break;
+            case 's': p.wavefront     = atoi(optarg); break;
+            case 'k': p.band          = atoi(optarg); break;
+            case 'b': p.n_pairs       = atoi(optarg); break;
+            case 'l': p.max_len       = atoi(optarg); break;
+            case 'q': p.batch_slots   = atoi(optarg); break;
             default:
                       fprintf(stderr, "\nUnrecognized option!\n");
                       usage();
@@ -50,6 +82,11 @@ struct Params input_params(int argc, char **argv) {
         }
     }
     assert(NR_DPUS > 0 && "Invalid # of dpus!");
+    assert(p.max_len <= BATCH_MAX_LEN && "Invalid maximum pair length!");
+    assert(p.batch_slots > 0 && "Invalid # of pairs per DPU!");
+    assert(p.memory_mode <= NW_HIRSCHBERG && "Invalid host memory mode!");
+    assert((p.memory_mode == NW_FULL_MATRIX || p.max_rows > 0) && "Invalid size of sequence!");
+    assert((p.band == 0 || p.n_pairs == 0) && "Banded mode aligns a single pair!");
 
     return p;
 }
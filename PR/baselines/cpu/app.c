@@ -0,0 +1,125 @@
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <stdint.h>
+
+#include <omp.h>
+
+#include "../../support/common.h"
+#include "graph.h"
+#include "../../support/params.h"
+#include "../../support/timer.h"
+#include "../../support/utils.h"
+
+// Pull-based PageRank over the in-edges of the first numNodes nodes, those of the input graph (the padding nodes after
+// them have no edges), iterating until the L1 norm of the rank change falls below the tolerance.
+// Returns the number of iterations.
+static uint32_t pageRank(struct CSRGraph inGraph, uint32_t numNodes, const float* invOutDegrees, struct Params p, float* ranks, float* contributions) {
+    double danglingRank = 0.0;
+    #pragma omp parallel for reduction(+:danglingRank)
+    for(uint32_t node = 0; node < numNodes; ++node) {
+        ranks[node] = 1.0f/numNodes;
+        contributions[node] = ranks[node]*invOutDegrees[node];
+        if(invOutDegrees[node] == 0.0f) {
+            danglingRank += ranks[node];
+        }
+    }
+    uint32_t numIterations = 0;
+    while(numIterations < p.maxIterations) {
+        float baseRank = (float) ((1.0 - p.damping)/numNodes + p.damping*danglingRank/numNodes);
+        double rankDelta = 0.0;
+        danglingRank = 0.0;
+        #pragma omp parallel for schedule(dynamic, 256) reduction(+:rankDelta, danglingRank)
+        for(uint32_t node = 0; node < numNodes; ++node) {
+            float sum = 0.0f;
+            for(uint32_t i = inGraph.nodePtrs[node]; i < inGraph.nodePtrs[node + 1]; ++i) {
+                sum += contributions[inGraph.neighborIdxs[i]];
+            }
+            float rank = baseRank + p.damping*sum;
+            rankDelta += (rank > ranks[node])?(rank - ranks[node]):(ranks[node] - rank);
+            if(invOutDegrees[node] == 0.0f) {
+                danglingRank += rank;
+            }
+            ranks[node] = rank;
+        }
+        // Contributions are only updated once all nodes have pulled the previous ones
+        #pragma omp parallel for
+        for(uint32_t node = 0; node < numNodes; ++node) {
+            contributions[node] = ranks[node]*invOutDegrees[node];
+        }
+        ++numIterations;
+        if(rankDelta < p.tolerance) {
+            break;
+        }
+    }
+    return numIterations;
+}
+
+int main(int argc, char** argv) {
+
+    // Process parameters
+    struct Params p = input_params(argc, argv);
+
+    // Initialize PageRank data structures
+    PRINT_INFO(p.verbosity >= 1, "Reading graph %s", p.fileName);
+    struct COOGraph cooGraph = readCOOGraph(p.fileName);
+    PRINT_INFO(p.verbosity >= 1, "    Graph has %d nodes and %d edges", cooGraph.numNodes, cooGraph.numEdges);
+    struct CSRGraph inGraph = coo2csr(transposeCOOGraph(cooGraph));
+    float* invOutDegrees = computeInvOutDegrees(cooGraph);
+    uint32_t numNodes = cooGraph.numInputNodes;
+    freeCOOGraph(cooGraph);
+    float* ranks = (float*) malloc(inGraph.numNodes*sizeof(float));
+    float* ranksReference = (float*) malloc(inGraph.numNodes*sizeof(float));
+    float* contributions = (float*) malloc(inGraph.numNodes*sizeof(float));
+
+    // Calculating reference result on CPU sequentially
+    PRINT_INFO(p.verbosity >= 1, "Calculating result on CPU (sequential)");
+    int maxThreads = (p.numThreads > 0)?(int)p.numThreads:omp_get_max_threads();
+    omp_set_num_threads(1);
+    Timer timer;
+    startTimer(&timer);
+    uint32_t numIterationsRef = pageRank(inGraph, numNodes, invOutDegrees, p, ranksReference, contributions);
+    stopTimer(&timer);
+    PRINT_INFO(p.verbosity >= 1, "    Elapsed time: %f ms (%u iterations)", getElapsedTime(timer)*1e3, numIterationsRef);
+
+    // Calculating result on CPU for increasing thread counts (up to -t, or OMP_NUM_THREADS which defaults to the number of cores)
+    for(int numThreads = (p.numThreads > 0)?maxThreads:1; ; numThreads = (numThreads*2 < maxThreads)?numThreads*2:maxThreads) {
+        PRINT_INFO(p.verbosity >= 1, "Calculating result on CPU (OpenMP, %d threads)", numThreads);
+        omp_set_num_threads(numThreads);
+        startTimer(&timer);
+        uint32_t numIterations = pageRank(inGraph, numNodes, invOutDegrees, p, ranks, contributions);
+        stopTimer(&timer);
+        float elapsedTime = getElapsedTime(timer);
+        double edgesPerSec = (double)inGraph.numEdges*numIterations/elapsedTime;
+        if(p.verbosity == 0) PRINT("%d %u %f %f %f", numThreads, numIterations, elapsedTime*1e3, elapsedTime*1e3/numIterations, edgesPerSec);
+        PRINT_INFO(p.verbosity >= 1, "    Elapsed time: %f ms (%u iterations)", elapsedTime*1e3, numIterations);
+        PRINT_INFO(p.verbosity >= 1, "    Time per iteration: %f ms", elapsedTime*1e3/numIterations);
+        PRINT_INFO(p.verbosity >= 1, "    Edges/sec: %f", edgesPerSec);
+
+        // The parallel reductions sum in a different order, so allow for float rounding
+        uint32_t numMismatches = 0;
+        for(uint32_t node = 0; node < numNodes; ++node) {
+            float error = (ranks[node] > ranksReference[node])?(ranks[node] - ranksReference[node]):(ranksReference[node] - ranks[node]);
+            numMismatches += (error > 1e-3f*ranksReference[node] + 1e-3f/numNodes);
+        }
+        if(numMismatches > 0) {
+            PRINT_ERROR("Mismatch (%u of %u ranks differ from the sequential result)", numMismatches, numNodes);
+        }
+        if(numThreads == maxThreads) {
+            break;
+        }
+    }
+
+    // Deallocate data structures
+    freeCSRGraph(inGraph);
+    free(invOutDegrees);
+    free(ranks);
+    free(ranksReference);
+    free(contributions);
+
+    return 0;
+
+}
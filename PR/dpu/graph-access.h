@@ -0,0 +1,91 @@
+#ifndef _GRAPH_ACCESS_H_
+#define _GRAPH_ACCESS_H_
+
+#include <alloc.h>
+#include <mram.h>
+
+#include "common.h"
+
+// Buffered reader over a range of the neighbor array in MRAM
+struct NeighborReader {
+    uint32_t* buffer_w;     /* WRAM block of NEIGHBOR_BLOCK_SIZE neighbor indexes */
+    uint32_t neighborIdxs_m;
+    uint32_t idx;           /* Current position in the neighbor array */
+    uint32_t end;           /* One past the last position of the range */
+    uint32_t bufferStart;   /* Position of buffer_w[0] (always even so that reads are 8B-aligned) */
+    uint32_t bufferEnd;     /* One past the last position held in buffer_w */
+};
+
+// Buffered reader over consecutive node pointers in MRAM
+struct NodePtrReader {
+    uint32_t* buffer_w;     /* WRAM block of NODE_PTR_BLOCK_SIZE node pointers */
+    uint32_t nodePtrs_m;
+    uint32_t nodePtrsOffset;
+    uint32_t numNodePtrs;   /* Number of node pointers in MRAM (number of nodes + 1) */
+    uint32_t bufferStart;
+    uint32_t bufferEnd;
+};
+
+static void initNeighborReader(struct NeighborReader* reader, uint32_t neighborIdxs_m) {
+    reader->buffer_w = mem_alloc(NEIGHBOR_BLOCK_SIZE*sizeof(uint32_t));
+    reader->neighborIdxs_m = neighborIdxs_m;
+    reader->idx = 0;
+    reader->end = 0;
+    reader->bufferStart = 0;
+    reader->bufferEnd = 0;
+}
+
+// Point the reader at neighbors [start, end), reusing the buffered block if it covers start
+static void seekNeighbors(struct NeighborReader* reader, uint32_t start, uint32_t end) {
+    reader->idx = start;
+    reader->end = end;
+}
+
+static uint32_t getNeighbor(struct NeighborReader* reader) {
+    if(reader->idx >= reader->bufferEnd || reader->idx < reader->bufferStart) {
+        // Refill the block starting at the current position, without reading past the end of the range
+        reader->bufferStart = reader->idx & ~1;
+        reader->bufferEnd = reader->bufferStart + NEIGHBOR_BLOCK_SIZE;
+        if(reader->bufferEnd > reader->end) {
+            reader->bufferEnd = reader->end;
+        }
+        uint32_t size = ROUND_UP_TO_MULTIPLE_OF_8((reader->bufferEnd - reader->bufferStart)*sizeof(uint32_t));
+        mram_read((__mram_ptr void const*)(reader->neighborIdxs_m + reader->bufferStart*sizeof(uint32_t)), reader->buffer_w, size);
+    }
+    return reader->buffer_w[reader->idx - reader->bufferStart];
+}
+
+static void initNodePtrReader(struct NodePtrReader* reader, uint32_t nodePtrs_m, uint32_t nodePtrsOffset, uint32_t numNodePtrs) {
+    reader->buffer_w = mem_alloc(NODE_PTR_BLOCK_SIZE*sizeof(uint32_t));
+    reader->nodePtrs_m = nodePtrs_m;
+    reader->nodePtrsOffset = nodePtrsOffset;
+    reader->numNodePtrs = numNodePtrs;
+    reader->bufferStart = 0;
+    reader->bufferEnd = 0;
+}
+
+// Get the neighbor range of a node, fetching a block of node pointers when it is not buffered
+static void getNodePtrs(struct NodePtrReader* reader, uint32_t node, uint32_t* nodePtr, uint32_t* nextNodePtr) {
+    if(node < reader->bufferStart || node + 1 >= reader->bufferEnd) {
+        reader->bufferStart = node & ~1;
+        reader->bufferEnd = reader->bufferStart + NODE_PTR_BLOCK_SIZE;
+        if(reader->bufferEnd > reader->numNodePtrs) {
+            reader->bufferEnd = reader->numNodePtrs;
+        }
+        uint32_t size = ROUND_UP_TO_MULTIPLE_OF_8((reader->bufferEnd - reader->bufferStart)*sizeof(uint32_t));
+        mram_read((__mram_ptr void const*)(reader->nodePtrs_m + reader->bufferStart*sizeof(uint32_t)), reader->buffer_w, size);
+    }
+    *nodePtr = reader->buffer_w[node - reader->bufferStart] - reader->nodePtrsOffset;
+    *nextNodePtr = reader->buffer_w[node + 1 - reader->bufferStart] - reader->nodePtrsOffset;
+}
+
+// Get the neighbor range of an arbitrary node with a single 8B or 16B read (cache_w holds 16B)
+static void loadNodePtrs(uint32_t nodePtrs_m, uint32_t nodePtrsOffset, uint32_t node, uint64_t* cache_w, uint32_t* nodePtr, uint32_t* nextNodePtr) {
+    uint32_t* cache_32_w = (uint32_t*) cache_w;
+    uint32_t first = node & ~1;
+    mram_read((__mram_ptr void const*)(nodePtrs_m + first*sizeof(uint32_t)), cache_w, (node == first)?8:16);
+    *nodePtr = cache_32_w[node - first] - nodePtrsOffset;
+    *nextNodePtr = cache_32_w[node - first + 1] - nodePtrsOffset;
+}
+
+#endif
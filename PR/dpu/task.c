@@ -0,0 +1,122 @@
+/*
+* PageRank with multiple tasklets
+*
+*/
+#include <stdio.h>
+
+#include <alloc.h>
+#include <barrier.h>
+#include <defs.h>
+#include <mram.h>
+#include <perfcounter.h>
+
+#include "dpu-utils.h"
+#include "graph-access.h"
+#include "common.h"
+
+__host struct IterationParams ITERATION_PARAMS;
+__host struct DPUResults DPU_RESULTS;
+
+BARRIER_INIT(my_barrier, NR_TASKLETS);
+
+// Per-tasklet rank change and dangling rank, reduced into DPU_RESULTS
+float taskletRankDeltas[NR_TASKLETS];
+float taskletDanglingRanks[NR_TASKLETS];
+
+// Load the contribution of an arbitrary node of the graph with a single 8B read
+static float loadContribution(uint32_t contributions_m, uint32_t node, uint64_t* cache_w) {
+    mram_read((__mram_ptr void const*)(contributions_m + (node & ~1)*sizeof(float)), cache_w, 8);
+    return ((float*) cache_w)[node & 1];
+}
+
+// main
+int main() {
+
+    if(me() == 0) {
+        mem_reset(); // Reset the heap
+        perfcounter_config(COUNT_CYCLES, true);
+    }
+    // Barrier
+    barrier_wait(&my_barrier);
+
+    // Load parameters
+    uint32_t params_m = (uint32_t) DPU_MRAM_HEAP_POINTER;
+    struct DPUParams* params_w = (struct DPUParams*) mem_alloc(ROUND_UP_TO_MULTIPLE_OF_8(sizeof(struct DPUParams)));
+    mram_read((__mram_ptr void const*)params_m, params_w, ROUND_UP_TO_MULTIPLE_OF_8(sizeof(struct DPUParams)));
+
+    // Extract parameters
+    uint32_t numNodes = params_w->dpuNumNodes;
+    uint32_t numInputNodes = params_w->dpuNumInputNodes;
+    uint32_t nodePtrsOffset = params_w->dpuNodePtrsOffset;
+    uint32_t nodePtrs_m = params_w->dpuNodePtrs_m;
+    uint32_t neighborIdxs_m = params_w->dpuNeighborIdxs_m;
+    uint32_t contributions_m = params_w->dpuContributions_m;
+    uint32_t nextContributions_m = params_w->dpuNextContributions_m;
+    uint32_t ranks_m = params_w->dpuRanks_m;
+    uint32_t invOutDegrees_m = params_w->dpuInvOutDegrees_m;
+    float damping = params_w->damping;
+    float baseRank = ITERATION_PARAMS.baseRank;
+
+    float localRankDelta = 0.0f;
+    float localDanglingRank = 0.0f;
+    if(numNodes > 0) {
+
+        // Allocate WRAM cache, rank blocks and graph readers for each tasklet to use throughout
+        uint64_t* cache_w = mem_alloc(sizeof(uint64_t));
+        float* ranks_w = mem_alloc(RANK_BLOCK_SIZE*sizeof(float));
+        float* invOutDegrees_w = mem_alloc(RANK_BLOCK_SIZE*sizeof(float));
+        float* nextContributions_w = mem_alloc(RANK_BLOCK_SIZE*sizeof(float));
+        struct NodePtrReader nodePtrReader;
+        struct NeighborReader neighborReader;
+        initNodePtrReader(&nodePtrReader, nodePtrs_m, nodePtrsOffset, numNodes + 1);
+        initNeighborReader(&neighborReader, neighborIdxs_m);
+
+        // Identify tasklet's nodes (the host aligns the tasklet ranges to 2 nodes so that rank blocks are 8B-aligned)
+        uint32_t taskletNodesStart = params_w->taskletNodesStart[me()];
+        uint32_t taskletNodesEnd = params_w->taskletNodesStart[me() + 1];
+
+        // Pull the contributions of the in-neighbors of every node, a block of nodes at a time
+        for(uint32_t blockStart = taskletNodesStart; blockStart < taskletNodesEnd; blockStart += RANK_BLOCK_SIZE) {
+            uint32_t blockSize = (blockStart + RANK_BLOCK_SIZE <= taskletNodesEnd)?RANK_BLOCK_SIZE:(taskletNodesEnd - blockStart);
+            uint32_t blockBytes = ROUND_UP_TO_MULTIPLE_OF_8(blockSize*sizeof(float));
+            mram_read((__mram_ptr void const*)(ranks_m + blockStart*sizeof(float)), ranks_w, blockBytes);
+            mram_read((__mram_ptr void const*)(invOutDegrees_m + blockStart*sizeof(float)), invOutDegrees_w, blockBytes);
+            for(uint32_t i = 0; i < blockSize; ++i) {
+                uint32_t nodePtr, nextNodePtr;
+                getNodePtrs(&nodePtrReader, blockStart + i, &nodePtr, &nextNodePtr);
+                float sum = 0.0f;
+                for(seekNeighbors(&neighborReader, nodePtr, nextNodePtr); neighborReader.idx < nextNodePtr; ++neighborReader.idx) {
+                    sum += loadContribution(contributions_m, getNeighbor(&neighborReader), cache_w);
+                }
+                float rank = (blockStart + i < numInputNodes)?(baseRank + damping*sum):0.0f;
+                localRankDelta += (rank > ranks_w[i])?(rank - ranks_w[i]):(ranks_w[i] - rank);
+                if(invOutDegrees_w[i] == 0.0f) {
+                    localDanglingRank += rank;
+                }
+                ranks_w[i] = rank;
+                nextContributions_w[i] = rank*invOutDegrees_w[i];
+            }
+            mram_write(ranks_w, (__mram_ptr void*)(ranks_m + blockStart*sizeof(float)), blockBytes);
+            mram_write(nextContributions_w, (__mram_ptr void*)(nextContributions_m + blockStart*sizeof(float)), blockBytes);
+        }
+    }
+
+    // Tree-based reduction of the per-tasklet sums
+    taskletRankDeltas[me()] = localRankDelta;
+    taskletDanglingRanks[me()] = localDanglingRank;
+    barrier_wait(&my_barrier);
+    for(uint32_t offset = 1; offset < NR_TASKLETS; offset <<= 1) {
+        if((me() & (2*offset - 1)) == 0 && me() + offset < NR_TASKLETS) {
+            taskletRankDeltas[me()] += taskletRankDeltas[me() + offset];
+            taskletDanglingRanks[me()] += taskletDanglingRanks[me() + offset];
+        }
+        barrier_wait(&my_barrier);
+    }
+    if(me() == 0) {
+        DPU_RESULTS.rankDelta = taskletRankDeltas[0];
+        DPU_RESULTS.danglingRank = taskletDanglingRanks[0];
+        DPU_RESULTS.cycles = perfcounter_get();
+    }
+
+    return 0;
+}
@@ -0,0 +1,351 @@
+/**
+* app.c
+* PageRank Host Application Source File
+*
+*/
+#include <dpu.h>
+#include <dpu_log.h>
+
+#include <assert.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "mram-management.h"
+#include "partition.h"
+#include "staging.h"
+#include "common.h"
+#include "graph.h"
+#include "params.h"
+#include "timer.h"
+#include "utils.h"
+
+#ifndef ENERGY
+#define ENERGY 0
+#endif
+#if ENERGY
+#include <dpu_probe.h>
+#endif
+
+#define DPU_BINARY "./bin/dpu_code"
+
+// Pull-based PageRank on the CPU in double precision, running the same number of iterations as the DPUs. Only the first
+// numNodes nodes are in the input graph; the padding nodes after them get a rank of 0
+static void pageRankReference(struct CSRGraph inGraph, uint32_t numNodes, const float* invOutDegrees, float damping, uint32_t numIterations, float* ranksReference) {
+    double* ranks = (double*) malloc(numNodes*sizeof(double));
+    double* contributions = (double*) malloc(numNodes*sizeof(double));
+    for(uint32_t node = 0; node < numNodes; ++node) {
+        ranks[node] = 1.0/numNodes;
+    }
+    for(uint32_t iteration = 0; iteration < numIterations; ++iteration) {
+        double danglingRank = 0.0;
+        for(uint32_t node = 0; node < numNodes; ++node) {
+            contributions[node] = ranks[node]*invOutDegrees[node];
+            if(invOutDegrees[node] == 0.0f) {
+                danglingRank += ranks[node];
+            }
+        }
+        double baseRank = (1.0 - damping)/numNodes + damping*danglingRank/numNodes;
+        for(uint32_t node = 0; node < numNodes; ++node) {
+            double sum = 0.0;
+            for(uint32_t i = inGraph.nodePtrs[node]; i < inGraph.nodePtrs[node + 1]; ++i) {
+                sum += contributions[inGraph.neighborIdxs[i]];
+            }
+            ranks[node] = baseRank + damping*sum;
+        }
+    }
+    for(uint32_t node = 0; node < inGraph.numNodes; ++node) {
+        ranksReference[node] = (node < numNodes)?(float) ranks[node]:0.0f;
+    }
+    free(ranks);
+    free(contributions);
+}
+
+// Main of the Host Application
+int main(int argc, char** argv) {
+
+    // Process parameters
+    struct Params p = input_params(argc, argv);
+
+    // Timer and profiling
+    Timer timer;
+    float loadTime = 0.0f, dpuTime = 0.0f, hostTime = 0.0f, retrieveTime = 0.0f;
+    #if ENERGY
+    struct dpu_probe_t probe;
+    DPU_ASSERT(dpu_probe_init("energy_probe", &probe));
+    #endif
+
+    // Allocate DPUs and load binary
+    struct dpu_set_t dpu_set, dpu;
+    uint32_t numDPUs;
+    DPU_ASSERT(dpu_alloc(NR_DPUS, NULL, &dpu_set));
+    DPU_ASSERT(dpu_load(dpu_set, DPU_BINARY, NULL));
+    DPU_ASSERT(dpu_get_nr_dpus(dpu_set, &numDPUs));
+    PRINT_INFO(p.verbosity >= 1, "Allocated %d DPU(s)", numDPUs);
+
+    // Initialize PageRank data structures: the DPUs pull ranks along in-edges, so they receive the transposed graph
+    PRINT_INFO(p.verbosity >= 1, "Reading graph %s", p.fileName);
+    struct COOGraph cooGraph = readCOOGraph(p.fileName);
+    PRINT_INFO(p.verbosity >= 1, "    Graph has %d nodes and %d edges", cooGraph.numNodes, cooGraph.numEdges);
+    struct CSRGraph inGraph = coo2csr(transposeCOOGraph(cooGraph));
+    float* invOutDegrees_h = computeInvOutDegrees(cooGraph);
+    uint32_t numInputNodes = cooGraph.numInputNodes;
+    freeCOOGraph(cooGraph);
+    uint32_t numNodes = inGraph.numNodes;
+    uint32_t* nodePtrs = inGraph.nodePtrs;
+    uint32_t* neighborIdxs = inGraph.neighborIdxs;
+    float* contributions = (float*) malloc(numNodes*sizeof(float));
+    float* ranks = (float*) malloc(numNodes*sizeof(float));
+    float* ranksReference = (float*) malloc(numNodes*sizeof(float));
+
+    // Start from the uniform distribution over the nodes of the input graph. The padding nodes readCOOGraph adds have
+    // no edges and stay at a rank of 0, so they are not counted in the base rank either
+    double danglingRank = 0.0;
+    for(uint32_t node = 0; node < numNodes; ++node) {
+        ranks[node] = (node < numInputNodes)?1.0f/numInputNodes:0.0f;
+        contributions[node] = ranks[node]*invOutDegrees_h[node];
+        if(invOutDegrees_h[node] == 0.0f) {
+            danglingRank += ranks[node];
+        }
+    }
+
+    // Partition the nodes across DPUs in ranges of an even number of nodes, balancing either the in-edges or the node count
+    uint32_t dpuNodeBounds[numDPUs + 1];
+    uint64_t* workPrefix = degreeWorkPrefix(nodePtrs, numNodes);
+    if(p.edgeBalanced) {
+        partitionByWork(workPrefix, 0, numNodes, numDPUs, 2, dpuNodeBounds);
+    } else {
+        partitionEvenly(0, numNodes, numDPUs, 2, dpuNodeBounds);
+    }
+    uint32_t maxDPUNumNodes = 0;
+    for(uint32_t dpuIdx = 0; dpuIdx < numDPUs; ++dpuIdx) {
+        uint32_t dpuNumNodes = dpuNodeBounds[dpuIdx + 1] - dpuNodeBounds[dpuIdx];
+        maxDPUNumNodes = (dpuNumNodes > maxDPUNumNodes)?dpuNumNodes:maxDPUNumNodes;
+    }
+    maxDPUNumNodes = ROUND_UP_TO_MULTIPLE_OF_2(maxDPUNumNodes);
+
+    uint32_t maxDPUNumNeighbors = 0;
+    for(uint32_t dpuIdx = 0; dpuIdx < numDPUs; ++dpuIdx) {
+        uint32_t dpuNumNeighbors = nodePtrs[dpuNodeBounds[dpuIdx + 1]] - nodePtrs[dpuNodeBounds[dpuIdx]];
+        maxDPUNumNeighbors = (dpuNumNeighbors > maxDPUNumNeighbors)?dpuNumNeighbors:maxDPUNumNeighbors;
+    }
+
+    // Populate MRAM at the same offsets on all DPUs, sized for the largest partition, so that all data is sent with
+    // parallel transfers
+    PRINT_INFO(p.verbosity >= 1, "Populating MRAM");
+    struct mram_heap_allocator_t allocator;
+    init_allocator(&allocator);
+    uint32_t dpuParams_m = mram_heap_alloc(&allocator, sizeof(struct DPUParams));
+    uint32_t dpuContributions_m = mram_heap_alloc(&allocator, numNodes*sizeof(float));
+    uint32_t dpuNextContributions_m = mram_heap_alloc(&allocator, maxDPUNumNodes*sizeof(float));
+    uint32_t dpuRanks_m = mram_heap_alloc(&allocator, maxDPUNumNodes*sizeof(float));
+    uint32_t dpuInvOutDegrees_m = mram_heap_alloc(&allocator, maxDPUNumNodes*sizeof(float));
+    uint32_t dpuNodePtrs_m = mram_heap_alloc(&allocator, (maxDPUNumNodes + 1)*sizeof(uint32_t));
+    uint32_t dpuNeighborIdxs_m = mram_heap_alloc(&allocator, (uint64_t)maxDPUNumNeighbors*sizeof(uint32_t));
+    PRINT_INFO(p.verbosity >= 2, "    Total memory allocated is %lu bytes", (unsigned long)allocator.totalAllocated);
+
+    // Set up DPU parameters and find every DPU's nodes and in-edges
+    struct DPUParams dpuParams[numDPUs];
+    uint8_t* dpuNodePtrs_h[numDPUs];
+    uint8_t* dpuNeighborIdxs_h[numDPUs];
+    uint8_t* dpuRanks_h[numDPUs];
+    uint8_t* dpuInvOutDegrees_h[numDPUs];
+    uint8_t* dpuParams_h[numDPUs];
+    uint64_t dpuNodePtrsSizes[numDPUs], dpuNeighborIdxsSizes[numDPUs], dpuVectorSizes[numDPUs], dpuParamsSizes[numDPUs];
+    unsigned int dpuIdx;
+    for(dpuIdx = 0; dpuIdx < numDPUs; ++dpuIdx) {
+        uint32_t dpuStartNodeIdx = dpuNodeBounds[dpuIdx];
+        uint32_t dpuNumNodes = dpuNodeBounds[dpuIdx + 1] - dpuStartNodeIdx;
+        uint32_t dpuNodePtrsOffset = nodePtrs[dpuStartNodeIdx];
+        uint32_t dpuNumNeighbors = nodePtrs[dpuStartNodeIdx + dpuNumNodes] - dpuNodePtrsOffset;
+        memset(&dpuParams[dpuIdx], 0, sizeof(struct DPUParams));
+        dpuParams[dpuIdx].dpuNumNodes = dpuNumNodes;
+        dpuParams[dpuIdx].dpuNumInputNodes = (numInputNodes <= dpuStartNodeIdx)?0:
+            (numInputNodes - dpuStartNodeIdx < dpuNumNodes)?numInputNodes - dpuStartNodeIdx:dpuNumNodes;
+        dpuParams[dpuIdx].numNodes = numNodes;
+        dpuParams[dpuIdx].dpuStartNodeIdx = dpuStartNodeIdx;
+        dpuParams[dpuIdx].dpuNodePtrsOffset = dpuNodePtrsOffset;
+        dpuParams[dpuIdx].dpuNodePtrs_m = dpuNodePtrs_m;
+        dpuParams[dpuIdx].dpuNeighborIdxs_m = dpuNeighborIdxs_m;
+        dpuParams[dpuIdx].dpuContributions_m = dpuContributions_m;
+        dpuParams[dpuIdx].dpuNextContributions_m = dpuNextContributions_m;
+        dpuParams[dpuIdx].dpuRanks_m = dpuRanks_m;
+        dpuParams[dpuIdx].dpuInvOutDegrees_m = dpuInvOutDegrees_m;
+        dpuParams[dpuIdx].damping = p.damping;
+        PRINT_INFO(p.verbosity >= 2, "    DPU %u:", dpuIdx);
+        PRINT_INFO(p.verbosity >= 2, "        Receives %u nodes and %u in-edges", dpuNumNodes, dpuNumNeighbors);
+
+        // Split the DPU's nodes across tasklets in the same way, keeping every range start even
+        if(dpuNumNodes > 0) {
+            uint32_t taskletNodeBounds[NR_TASKLETS + 1];
+            if(p.edgeBalanced) {
+                partitionByWork(workPrefix, dpuStartNodeIdx, dpuStartNodeIdx + dpuNumNodes, NR_TASKLETS, 2, taskletNodeBounds);
+            } else {
+                partitionEvenly(dpuStartNodeIdx, dpuStartNodeIdx + dpuNumNodes, NR_TASKLETS, 2, taskletNodeBounds);
+            }
+            for(uint32_t t = 0; t <= NR_TASKLETS; ++t) {
+                dpuParams[dpuIdx].taskletNodesStart[t] = taskletNodeBounds[t] - dpuStartNodeIdx;
+            }
+        }
+
+        dpuNodePtrs_h[dpuIdx] = (dpuNumNodes > 0)?(uint8_t*)&nodePtrs[dpuStartNodeIdx]:NULL;
+        dpuNodePtrsSizes[dpuIdx] = (dpuNumNodes + 1)*sizeof(uint32_t);
+        dpuNeighborIdxs_h[dpuIdx] = (dpuNumNodes > 0)?(uint8_t*)&neighborIdxs[dpuNodePtrsOffset]:NULL;
+        dpuNeighborIdxsSizes[dpuIdx] = (uint64_t)dpuNumNeighbors*sizeof(uint32_t);
+        dpuRanks_h[dpuIdx] = (dpuNumNodes > 0)?(uint8_t*)&ranks[dpuStartNodeIdx]:NULL;
+        dpuInvOutDegrees_h[dpuIdx] = (dpuNumNodes > 0)?(uint8_t*)&invOutDegrees_h[dpuStartNodeIdx]:NULL;
+        dpuVectorSizes[dpuIdx] = dpuNumNodes*sizeof(float);
+        dpuParams_h[dpuIdx] = (uint8_t*)&dpuParams[dpuIdx];
+        dpuParamsSizes[dpuIdx] = sizeof(struct DPUParams);
+    }
+
+    // Send data and parameters to DPUs
+    PRINT_INFO(p.verbosity >= 2, "    Copying data to DPUs");
+    startTimer(&timer);
+    pushSlicesToDPUs(dpu_set, numDPUs, dpuNodePtrs_m, dpuNodePtrs_h, dpuNodePtrsSizes, (uint8_t*)&nodePtrs[ROUND_UP_TO_MULTIPLE_OF_2(numNodes + 1)]);
+    pushSlicesToDPUs(dpu_set, numDPUs, dpuNeighborIdxs_m, dpuNeighborIdxs_h, dpuNeighborIdxsSizes,
+            (uint8_t*)neighborIdxs + ROUND_UP_TO_MULTIPLE_OF_8((uint64_t)inGraph.numEdges*sizeof(uint32_t)));
+    pushSlicesToDPUs(dpu_set, numDPUs, dpuRanks_m, dpuRanks_h, dpuVectorSizes, (uint8_t*)&ranks[numNodes]);
+    pushSlicesToDPUs(dpu_set, numDPUs, dpuInvOutDegrees_m, dpuInvOutDegrees_h, dpuVectorSizes, (uint8_t*)&invOutDegrees_h[numNodes]);
+    pushSlicesToDPUs(dpu_set, numDPUs, dpuParams_m, dpuParams_h, dpuParamsSizes, (uint8_t*)&dpuParams[numDPUs]);
+    stopTimer(&timer);
+    loadTime += getElapsedTime(timer);
+    PRINT_INFO(p.verbosity >= 1, "    CPU-DPU Time: %f ms", loadTime*1e3);
+
+    // Every iteration broadcasts all contributions and gathers the next contributions of every DPU's nodes
+    uint64_t sentBytesPerIteration = (uint64_t)numDPUs*(numNodes*sizeof(float) + sizeof(struct IterationParams));
+    uint64_t receivedBytesPerIteration = (uint64_t)numDPUs*(maxDPUNumNodes*sizeof(float) + sizeof(struct DPUResults));
+    float* dpuNextContributions = (float*) malloc((uint64_t)numDPUs*maxDPUNumNodes*sizeof(float));
+    struct DPUResults dpuResults[numDPUs];
+
+    // Iterate until the ranks converge
+    PRINT_INFO(p.verbosity >= 1, "Running PageRank on DPUs");
+    uint32_t numIterations = 0;
+    double rankDelta = 0.0;
+    while(numIterations < p.maxIterations) {
+
+        // Send the contributions and the base rank of the iteration to all DPUs
+        startTimer(&timer);
+        struct IterationParams iterationParams;
+        iterationParams.baseRank = (float) ((1.0 - p.damping)/numInputNodes + p.damping*danglingRank/numInputNodes);
+        iterationParams.iteration = numIterations;
+        DPU_ASSERT(dpu_broadcast_to(dpu_set, "ITERATION_PARAMS", 0, &iterationParams, sizeof(struct IterationParams), DPU_XFER_DEFAULT));
+        DPU_FOREACH (dpu_set, dpu) {
+            DPU_ASSERT(dpu_prepare_xfer(dpu, contributions));
+        }
+        DPU_ASSERT(dpu_push_xfer(dpu_set, DPU_XFER_TO_DPU, DPU_MRAM_HEAP_POINTER_NAME, dpuContributions_m, numNodes*sizeof(float), DPU_XFER_DEFAULT));
+        stopTimer(&timer);
+        float iterationExchangeTime = getElapsedTime(timer);
+
+        // Run all DPUs
+        #if ENERGY
+        DPU_ASSERT(dpu_probe_start(&probe));
+        #endif
+        startTimer(&timer);
+        DPU_ASSERT(dpu_launch(dpu_set, DPU_SYNCHRONOUS));
+        stopTimer(&timer);
+        #if ENERGY
+        DPU_ASSERT(dpu_probe_stop(&probe));
+        #endif
+        float iterationDPUTime = getElapsedTime(timer);
+        dpuTime += iterationDPUTime;
+
+        // Gather the results and the next contributions of all DPUs, then concatenate the contributions
+        startTimer(&timer);
+        DPU_FOREACH (dpu_set, dpu, dpuIdx) {
+            DPU_ASSERT(dpu_prepare_xfer(dpu, &dpuResults[dpuIdx]));
+        }
+        DPU_ASSERT(dpu_push_xfer(dpu_set, DPU_XFER_FROM_DPU, "DPU_RESULTS", 0, sizeof(struct DPUResults), DPU_XFER_DEFAULT));
+        DPU_FOREACH (dpu_set, dpu, dpuIdx) {
+            DPU_ASSERT(dpu_prepare_xfer(dpu, &dpuNextContributions[(uint64_t)dpuIdx*maxDPUNumNodes]));
+        }
+        DPU_ASSERT(dpu_push_xfer(dpu_set, DPU_XFER_FROM_DPU, DPU_MRAM_HEAP_POINTER_NAME, dpuNextContributions_m, maxDPUNumNodes*sizeof(float), DPU_XFER_DEFAULT));
+        rankDelta = 0.0;
+        danglingRank = 0.0;
+        for(dpuIdx = 0; dpuIdx < numDPUs; ++dpuIdx) {
+            rankDelta += dpuResults[dpuIdx].rankDelta;
+            danglingRank += dpuResults[dpuIdx].danglingRank;
+        }
+        #pragma omp parallel for schedule(dynamic, 1)
+        for(uint32_t i = 0; i < numDPUs; ++i) {
+            memcpy(&contributions[dpuNodeBounds[i]], &dpuNextContributions[(uint64_t)i*maxDPUNumNodes], (dpuNodeBounds[i + 1] - dpuNodeBounds[i])*sizeof(float));
+        }
+        stopTimer(&timer);
+        iterationExchangeTime += getElapsedTime(timer);
+        hostTime += iterationExchangeTime;
+
+        ++numIterations;
+        PRINT_INFO(p.verbosity >= 2, "    Iteration %u: rank change %e, DPU time %f ms, exchange time %f ms", numIterations, rankDelta, iterationDPUTime*1e3, iterationExchangeTime*1e3);
+        if(p.verbosity == 0) PRINT("Iteration %u DPU Time (ms): %f    Inter-DPU Time (ms): %f", numIterations, iterationDPUTime*1e3, iterationExchangeTime*1e3);
+        if(rankDelta < p.tolerance) {
+            break;
+        }
+
+    }
+    PRINT_INFO(p.verbosity >= 1, "    %s after %u iterations (rank change %e)", (rankDelta < p.tolerance)?"Converged":"Stopped", numIterations, rankDelta);
+    PRINT_INFO(p.verbosity >= 1, "    DPU Time: %f ms", dpuTime*1e3);
+    PRINT_INFO(p.verbosity >= 1, "    Inter-DPU Time: %f ms", hostTime*1e3);
+    PRINT_INFO(p.verbosity >= 1, "    Time per iteration: %f ms", (dpuTime + hostTime)*1e3/numIterations);
+    PRINT_INFO(p.verbosity >= 1, "    Bytes exchanged per iteration: %lu (CPU-DPU %lu, DPU-CPU %lu)", (unsigned long)(sentBytesPerIteration + receivedBytesPerIteration), (unsigned long)sentBytesPerIteration, (unsigned long)receivedBytesPerIteration);
+    PRINT_INFO(p.verbosity >= 1, "    Edges/sec: %f", (double)inGraph.numEdges*numIterations/(dpuTime + hostTime));
+
+    // Copy back the ranks
+    PRINT_INFO(p.verbosity >= 1, "Copying back the result");
+    startTimer(&timer);
+    DPU_FOREACH (dpu_set, dpu, dpuIdx) {
+        DPU_ASSERT(dpu_prepare_xfer(dpu, &dpuNextContributions[(uint64_t)dpuIdx*maxDPUNumNodes]));
+    }
+    DPU_ASSERT(dpu_push_xfer(dpu_set, DPU_XFER_FROM_DPU, DPU_MRAM_HEAP_POINTER_NAME, dpuRanks_m, maxDPUNumNodes*sizeof(float), DPU_XFER_DEFAULT));
+    for(dpuIdx = 0; dpuIdx < numDPUs; ++dpuIdx) {
+        memcpy(&ranks[dpuNodeBounds[dpuIdx]], &dpuNextContributions[(uint64_t)dpuIdx*maxDPUNumNodes], (dpuNodeBounds[dpuIdx + 1] - dpuNodeBounds[dpuIdx])*sizeof(float));
+    }
+    stopTimer(&timer);
+    retrieveTime += getElapsedTime(timer);
+    PRINT_INFO(p.verbosity >= 1, "    DPU-CPU Time: %f ms", retrieveTime*1e3);
+    if(p.verbosity == 0) PRINT("CPU-DPU Time(ms): %f    DPU Kernel Time (ms): %f    Inter-DPU Time (ms): %f    DPU-CPU Time (ms): %f", loadTime*1e3, dpuTime*1e3, hostTime*1e3, retrieveTime*1e3);
+    if(p.verbosity == 0) PRINT("Iterations: %u    Bytes/Iteration: %lu    Edges/sec: %f", numIterations, (unsigned long)(sentBytesPerIteration + receivedBytesPerIteration), (double)inGraph.numEdges*numIterations/(dpuTime + hostTime));
+
+    // Display DPU Logs
+    if(p.verbosity >= 2) {
+        PRINT_INFO(p.verbosity >= 2, "Displaying DPU Logs:");
+        dpuIdx = 0;
+        DPU_FOREACH (dpu_set, dpu) {
+            PRINT("DPU %u:", dpuIdx);
+            DPU_ASSERT(dpu_log_read(dpu, stdout));
+            ++dpuIdx;
+        }
+    }
+
+    // Calculate the reference result on the CPU and verify, allowing for the float accumulation on the DPUs
+    PRINT_INFO(p.verbosity >= 1, "Calculating result on CPU");
+    pageRankReference(inGraph, numInputNodes, invOutDegrees_h, p.damping, numIterations, ranksReference);
+    uint32_t numMismatches = 0;
+    for(uint32_t node = 0; node < numNodes; ++node) {
+        float error = (ranks[node] > ranksReference[node])?(ranks[node] - ranksReference[node]):(ranksReference[node] - ranks[node]);
+        if(error > 1e-3f*ranksReference[node] + 1e-3f/numInputNodes) {
+            if(numMismatches == 0) {
+                PRINT_ERROR("Mismatch at node %u (CPU result = %e, DPU result = %e)", node, ranksReference[node], ranks[node]);
+            }
+            ++numMismatches;
+        }
+    }
+    if(numMismatches > 0) {
+        PRINT_ERROR("%u of %u ranks do not match", numMismatches, numNodes);
+    } else {
+        PRINT_INFO(p.verbosity >= 1, "    All ranks match");
+    }
+
+    // Deallocate data structures
+    freeCSRGraph(inGraph);
+    free(invOutDegrees_h);
+    free(workPrefix);
+    free(contributions);
+    free(ranks);
+    free(ranksReference);
+    free(dpuNextContributions);
+
+    return 0;
+
+}
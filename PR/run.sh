@@ -0,0 +1,22 @@
+#!/bin/bash
+
+# Strong scaling of PageRank with the number of DPUs
+mkdir -p profile
+for i in 1 4 16 64
+do
+	for k in 16
+	do
+		NR_DPUS=$i NR_TASKLETS=$k make all
+		wait
+		./bin/host_code -v 0 -f data/loc-gowalla_edges.txt > profile/PR_tl${k}_dpu${i}.txt
+		wait
+		make clean
+		wait
+	done
+done
+
+# Summary: iterations, bytes exchanged per iteration and edges/sec per DPU count
+for i in 1 4 16 64
+do
+	echo "NR_DPUS=$i $(grep '^Iterations:' profile/PR_tl16_dpu${i}.txt)"
+done
@@ -0,0 +1,57 @@
+#ifndef _COMMON_H_
+#define _COMMON_H_
+
+#define ROUND_UP_TO_MULTIPLE_OF_2(x)    ((((x) + 1)/2)*2)
+#define ROUND_UP_TO_MULTIPLE_OF_8(x)    ((((x) + 7)/8)*8)
+#define ROUND_UP_TO_MULTIPLE_OF_64(x)   ((((x) + 63)/64)*64)
+
+// The CPU baseline includes this header without a tasklet count
+#ifndef NR_TASKLETS
+#define NR_TASKLETS 16
+#endif
+
+// Number of neighbor indexes (even) and node pointers (even, at least 4) fetched per MRAM read by the DPU kernel
+#ifndef NEIGHBOR_BLOCK_SIZE
+#define NEIGHBOR_BLOCK_SIZE 64
+#endif
+#ifndef NODE_PTR_BLOCK_SIZE
+#define NODE_PTR_BLOCK_SIZE 32
+#endif
+
+// Number of ranks (even) read and written per MRAM access by the DPU kernel
+#ifndef RANK_BLOCK_SIZE
+#define RANK_BLOCK_SIZE 32
+#endif
+
+// Parameters of a DPU, fixed for the whole run. The contribution vector, the next contributions, the ranks and the
+// inverse out-degrees are at the same MRAM offsets on every DPU so that they can be broadcast and gathered in parallel.
+struct DPUParams {
+    uint32_t dpuNumNodes; /* The number of nodes assigned to this DPU */
+    uint32_t dpuNumInputNodes; /* The number of them in the input graph, the others are padding and keep a rank of 0 */
+    uint32_t numNodes; /* Total number of nodes in the graph  */
+    uint32_t dpuStartNodeIdx; /* The index of the first node assigned to this DPU  */
+    uint32_t dpuNodePtrsOffset; /* Offset of the in-edge node pointers of the DPU's nodes */
+    uint32_t dpuNodePtrs_m;
+    uint32_t dpuNeighborIdxs_m; /* Sources of the in-edges of the DPU's nodes (global node indexes) */
+    uint32_t dpuContributions_m; /* rank/out-degree of every node of the graph, broadcast by the host */
+    uint32_t dpuNextContributions_m; /* rank/out-degree of the DPU's nodes after the iteration */
+    uint32_t dpuRanks_m; /* Ranks of the DPU's nodes */
+    uint32_t dpuInvOutDegrees_m; /* 1/out-degree of the DPU's nodes, 0 for nodes without out-edges */
+    float damping;
+    uint32_t taskletNodesStart[NR_TASKLETS + 1]; /* First node of each tasklet relative to dpuStartNodeIdx (even), and dpuNumNodes */
+};
+
+// Parameters that change every iteration, broadcast to all DPUs
+struct IterationParams {
+    float baseRank; /* (1 - damping)/numNodes plus the damped rank of the nodes without out-edges spread over all nodes */
+    uint32_t iteration;
+};
+
+struct DPUResults {
+    float rankDelta; /* L1 norm of the change of the DPU's ranks */
+    float danglingRank; /* Sum of the ranks of the DPU's nodes without out-edges */
+    uint64_t cycles;
+};
+
+#endif
+
@@ -0,0 +1,68 @@
+
+#ifndef _PARAMS_H_
+#define _PARAMS_H_
+
+#include "common.h"
+#include "utils.h"
+
+static void usage() {
+    PRINT(  "\nUsage:  ./program [options]"
+            "\n"
+            "\nBenchmark-specific options:"
+            "\n    -f <F>    input matrix file name (default=data/roadNet-CA.txt)"
+            "\n    -d <D>    damping factor (default=0.85)"
+            "\n    -e <E>    stop when the L1 norm of the rank change falls below E (default=1e-5)"
+            "\n    -i <I>    maximum number of iterations (default=100)"
+            "\n    -p <P>    partitioning across DPUs: 0=equal node counts, 1=balanced in-edge counts (default=1)"
+            "\n    -t <T>    number of threads of the CPU baseline (default=0, meaning all thread counts up to OMP_NUM_THREADS)"
+            "\n"
+            "\nGeneral options:"
+            "\n    -v <V>    verbosity"
+            "\n    -h        help"
+            "\n\n");
+}
+
+typedef struct Params {
+  const char* fileName;
+  float damping;
+  float tolerance;
+  unsigned int maxIterations;
+  unsigned int edgeBalanced;
+  unsigned int numThreads;
+  unsigned int verbosity;
+} Params;
+
+static struct Params input_params(int argc, char **argv) {
+    struct Params p;
+    p.fileName      = "data/roadNet-CA.txt";
+    p.damping       = 0.85f;
+    p.tolerance     = 1e-5f;
+    p.maxIterations = 100;
+    p.edgeBalanced  = 1;
+    p.numThreads    = 0;
+    p.verbosity     = 1;
+    int opt;
+    while((opt = getopt(argc, argv, "f:d:e:i:p:t:v:h")) >= 0) {
+        switch(opt) {
+            case 'f': p.fileName    = optarg;       break;
+            case 'd': p.damping     = atof(optarg); break;
+            case 'e': p.tolerance   = atof(optarg); break;
+            case 'i': p.maxIterations = atoi(optarg); break;
+            case 'p': p.edgeBalanced = atoi(optarg); break;
+            case 't': p.numThreads  = atoi(optarg); break;
+            case 'v': p.verbosity   = atoi(optarg); break;
+            case 'h': usage(); exit(0);
+            default:
+                      PRINT_ERROR("Unrecognized option!");
+                      usage();
+                      exit(0);
+        }
+    }
+
+    assert(p.damping >= 0.0f && p.damping < 1.0f && "Invalid damping factor!");
+    assert(p.maxIterations > 0 && "Invalid # of iterations!");
+
+    return p;
+}
+
+#endif
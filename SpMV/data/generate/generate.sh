@@ -3,6 +3,15 @@ R="1 4 16 64 256"
 
 make
 
+# Weak scaling inputs: R-MAT (power-law), banded and uniform-random matrices
+# with 16384 rows and 16 nonzeros per row per unit of scaling
+for r in $R; do
+    ./synth -t rmat    -m $((r*16384)) -z 16 -o ../rmat.$r.bin
+    ./synth -t banded  -m $((r*16384)) -z 16 -w 64 -o ../banded.$r.bin
+    ./synth -t uniform -m $((r*16384)) -z 16 -o ../uniform.$r.bin
+done
+
+# Replicated bcsstk30 (uniform block-diagonal structure), used by run_strong_full.py
 for r in $R; do
     ./replicate ../bcsstk30.mtx $r ../bcsstk30.mtx.$r.mtx
 done
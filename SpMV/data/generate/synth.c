@@ -0,0 +1,258 @@
+
+#include <getopt.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define COO_BINARY_MAGIC 0x4F4F4350 /* "PCOO", must match support/matrix.h */
+
+enum MatrixType { RMAT, BANDED, UNIFORM };
+
+struct SynthParams {
+    enum MatrixType type;
+    uint32_t numRows;
+    uint32_t numCols;
+    uint32_t nnzPerRow;
+    uint32_t bandwidth;
+    double a, b, c; /* R-MAT quadrant probabilities (d = 1 - a - b - c) */
+    uint64_t seed;
+    const char* outFileName;
+};
+
+static void usage() {
+    printf( "\nUsage:  ./synth [options]"
+            "\n"
+            "\n    -t <T>    matrix type: rmat, banded or uniform (default=rmat)"
+            "\n    -m <M>    number of rows (default=1048576)"
+            "\n    -n <N>    number of columns (default=number of rows)"
+            "\n    -z <Z>    average nonzeros sampled per row, before duplicates are removed (default=16)"
+            "\n    -w <W>    half bandwidth for banded matrices (default=64)"
+            "\n    -p <P>    R-MAT probabilities a,b,c (default=0.57,0.19,0.19)"
+            "\n    -s <S>    random seed (default=1)"
+            "\n    -o <O>    output file name (default=out.bin)"
+            "\n    -h        help"
+            "\n\n");
+}
+
+static struct SynthParams input_params(int argc, char** argv) {
+    struct SynthParams p;
+    p.type          = RMAT;
+    p.numRows       = 1 << 20;
+    p.numCols       = 0;
+    p.nnzPerRow     = 16;
+    p.bandwidth     = 64;
+    p.a             = 0.57;
+    p.b             = 0.19;
+    p.c             = 0.19;
+    p.seed          = 1;
+    p.outFileName   = "out.bin";
+    int opt;
+    while((opt = getopt(argc, argv, "t:m:n:z:w:p:s:o:h")) >= 0) {
+        switch(opt) {
+            case 't':
+                if(strcmp(optarg, "rmat") == 0) p.type = RMAT;
+                else if(strcmp(optarg, "banded") == 0) p.type = BANDED;
+                else if(strcmp(optarg, "uniform") == 0) p.type = UNIFORM;
+                else { fprintf(stderr, "Unknown matrix type %s\n", optarg); usage(); exit(1); }
+                break;
+            case 'm': p.numRows     = atoi(optarg); break;
+            case 'n': p.numCols     = atoi(optarg); break;
+            case 'z': p.nnzPerRow   = atoi(optarg); break;
+            case 'w': p.bandwidth   = atoi(optarg); break;
+            case 'p':
+                if(sscanf(optarg, "%lf,%lf,%lf", &p.a, &p.b, &p.c) != 3 || p.a + p.b + p.c > 1.0) {
+                    fprintf(stderr, "Invalid R-MAT probabilities %s\n", optarg);
+                    exit(1);
+                }
+                break;
+            case 's': p.seed        = strtoull(optarg, NULL, 10); break;
+            case 'o': p.outFileName = optarg;       break;
+            case 'h': usage(); exit(0);
+            default:
+                      fprintf(stderr, "Unrecognized option!\n");
+                      usage();
+                      exit(1);
+        }
+    }
+    if(p.numCols == 0) {
+        p.numCols = p.numRows;
+    }
+    if(p.numRows == 0 || p.nnzPerRow == 0) {
+        fprintf(stderr, "Matrix must have at least one row and one nonzero per row\n");
+        exit(1);
+    }
+    return p;
+}
+
+// xorshift64* generator: fast and good enough for synthetic inputs
+static inline uint64_t nextRandom(uint64_t* state) {
+    uint64_t x = *state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *state = x;
+    return x*0x2545F4914F6CDD1DULL;
+}
+
+static inline double nextUniform(uint64_t* state) {
+    return (nextRandom(state) >> 11)*(1.0/9007199254740992.0);
+}
+
+static inline uint32_t nextBounded(uint64_t* state, uint32_t bound) {
+    return (uint32_t)(((nextRandom(state) >> 32)*bound) >> 32);
+}
+
+static uint32_t log2Ceil(uint32_t x) {
+    uint32_t l = 0;
+    while((1ULL << l) < x) {
+        ++l;
+    }
+    return l;
+}
+
+// Recursive-matrix (R-MAT) sampling gives a power-law row and column degree distribution
+static void generateRMAT(struct SynthParams* p, uint64_t numNonzeros, uint32_t* rowIdxs, uint32_t* colIdxs, uint64_t* state) {
+    uint32_t rowScale = log2Ceil(p->numRows);
+    uint32_t colScale = log2Ceil(p->numCols);
+    uint32_t scale = (rowScale > colScale)?rowScale:colScale;
+    double ab = p->a + p->b;
+    double abc = ab + p->c;
+    for(uint64_t i = 0; i < numNonzeros; ++i) {
+        uint32_t row, col;
+        do {
+            row = 0;
+            col = 0;
+            for(uint32_t level = 0; level < scale; ++level) {
+                double r = nextUniform(state);
+                uint32_t rowBit = (r >= ab);
+                uint32_t colBit = (r >= p->a && r < ab) || (r >= abc);
+                row = (row << 1) | rowBit;
+                col = (col << 1) | colBit;
+            }
+            // Keep the high (coarsest-level) bits of the smaller dimension and reject samples outside the matrix
+            row >>= scale - rowScale;
+            col >>= scale - colScale;
+        } while(row >= p->numRows || col >= p->numCols);
+        rowIdxs[i] = row;
+        colIdxs[i] = col;
+    }
+}
+
+// Nonzeros fall uniformly within a band of half width p->bandwidth around the (scaled) diagonal
+static void generateBanded(struct SynthParams* p, uint64_t numNonzeros, uint32_t* rowIdxs, uint32_t* colIdxs, uint64_t* state) {
+    double ratio = (double)p->numCols/p->numRows;
+    uint32_t width = 2*p->bandwidth + 1;
+    for(uint64_t i = 0; i < numNonzeros; ++i) {
+        uint32_t row = (uint32_t)(i/p->nnzPerRow);
+        int64_t center = (int64_t)(row*ratio);
+        int64_t col = center - (int64_t)p->bandwidth + nextBounded(state, width);
+        if(col < 0) col = -col;
+        if(col >= p->numCols) col = 2*((int64_t)p->numCols - 1) - col;
+        if(col < 0) col = 0;
+        rowIdxs[i] = row;
+        colIdxs[i] = (uint32_t)col;
+    }
+}
+
+static void generateUniform(struct SynthParams* p, uint64_t numNonzeros, uint32_t* rowIdxs, uint32_t* colIdxs, uint64_t* state) {
+    for(uint64_t i = 0; i < numNonzeros; ++i) {
+        rowIdxs[i] = (uint32_t)(i/p->nnzPerRow);
+        colIdxs[i] = nextBounded(state, p->numCols);
+    }
+}
+
+// Sort the nonzeros by (row, column) with an LSD radix sort of the packed pairs and drop the duplicates that the
+// random generators produce. Returns the number of distinct nonzeros, left in rowIdxs/colIdxs
+static uint64_t removeDuplicates(uint64_t numNonzeros, uint32_t* rowIdxs, uint32_t* colIdxs) {
+    uint64_t* keys = (uint64_t*) malloc(numNonzeros*sizeof(uint64_t));
+    uint64_t* tmp = (uint64_t*) malloc(numNonzeros*sizeof(uint64_t));
+    uint64_t* counts = (uint64_t*) malloc((1 << 16)*sizeof(uint64_t));
+    if(keys == NULL || tmp == NULL || counts == NULL) {
+        fprintf(stderr, "Cannot allocate %lu nonzeros\n", (unsigned long)numNonzeros);
+        exit(1);
+    }
+    for(uint64_t i = 0; i < numNonzeros; ++i) {
+        keys[i] = ((uint64_t)rowIdxs[i] << 32) | colIdxs[i];
+    }
+    for(uint32_t shift = 0; shift < 64; shift += 16) {
+        memset(counts, 0, (1 << 16)*sizeof(uint64_t));
+        for(uint64_t i = 0; i < numNonzeros; ++i) {
+            ++counts[(keys[i] >> shift) & 0xFFFF];
+        }
+        uint64_t sum = 0;
+        for(uint32_t digit = 0; digit < (1 << 16); ++digit) {
+            uint64_t count = counts[digit];
+            counts[digit] = sum;
+            sum += count;
+        }
+        for(uint64_t i = 0; i < numNonzeros; ++i) {
+            tmp[counts[(keys[i] >> shift) & 0xFFFF]++] = keys[i];
+        }
+        uint64_t* swap = keys;
+        keys = tmp;
+        tmp = swap;
+    }
+    uint64_t numDistinct = 0;
+    for(uint64_t i = 0; i < numNonzeros; ++i) {
+        if(i == 0 || keys[i] != keys[i - 1]) {
+            rowIdxs[numDistinct] = (uint32_t)(keys[i] >> 32);
+            colIdxs[numDistinct] = (uint32_t)keys[i];
+            ++numDistinct;
+        }
+    }
+    free(keys);
+    free(tmp);
+    free(counts);
+    return numDistinct;
+}
+
+int main(int argc, char** argv) {
+
+    struct SynthParams p = input_params(argc, argv);
+
+    uint64_t numNonzeros = (uint64_t)p.numRows*p.nnzPerRow;
+    if(numNonzeros > UINT32_MAX) {
+        fprintf(stderr, "Too many nonzeros (%lu), the matrix format uses 32-bit counts\n", (unsigned long)numNonzeros);
+        exit(1);
+    }
+    uint32_t* rowIdxs = (uint32_t*) malloc(numNonzeros*sizeof(uint32_t));
+    uint32_t* colIdxs = (uint32_t*) malloc(numNonzeros*sizeof(uint32_t));
+    if(rowIdxs == NULL || colIdxs == NULL) {
+        fprintf(stderr, "Cannot allocate %lu nonzeros\n", (unsigned long)numNonzeros);
+        exit(1);
+    }
+
+    uint64_t state = p.seed*0x9E3779B97F4A7C15ULL + 1;
+    switch(p.type) {
+        case RMAT:      generateRMAT(&p, numNonzeros, rowIdxs, colIdxs, &state);    break;
+        case BANDED:    generateBanded(&p, numNonzeros, rowIdxs, colIdxs, &state);  break;
+        case UNIFORM:   generateUniform(&p, numNonzeros, rowIdxs, colIdxs, &state); break;
+    }
+    uint64_t numSampled = numNonzeros;
+    numNonzeros = removeDuplicates(numSampled, rowIdxs, colIdxs);
+
+    FILE* fp = fopen(p.outFileName, "wb");
+    if(fp == NULL) {
+        fprintf(stderr, "Cannot open %s\n", p.outFileName);
+        exit(1);
+    }
+    uint32_t header[4] = { COO_BINARY_MAGIC, p.numRows, p.numCols, (uint32_t)numNonzeros };
+    if(fwrite(header, sizeof(uint32_t), 4, fp) != 4
+            || fwrite(rowIdxs, sizeof(uint32_t), numNonzeros, fp) != numNonzeros
+            || fwrite(colIdxs, sizeof(uint32_t), numNonzeros, fp) != numNonzeros) {
+        fprintf(stderr, "Error writing %s\n", p.outFileName);
+        exit(1);
+    }
+    fclose(fp);
+
+    printf("%s: %u rows, %u columns, %lu nonzeros (%lu duplicate samples removed, density %g)\n", p.outFileName, p.numRows, p.numCols,
+            (unsigned long)numNonzeros, (unsigned long)(numSampled - numNonzeros), (double)numNonzeros/((double)p.numRows*p.numCols));
+
+    free(rowIdxs);
+    free(colIdxs);
+
+    return 0;
+
+}
@@ -14,6 +14,8 @@
 #include <unistd.h>
 
 #include "mram-management.h"
+#include "partition.h"
+#include "staging.h"
 #include "../support/common.h"
 #include "../support/matrix.h"
 #include "../support/params.h"
@@ -64,77 +66,131 @@ int main(int argc, char** argv) {
     initVector(inVector, numCols);
     float* outVector = malloc(ROUND_UP_TO_MULTIPLE_OF_8(numRows*sizeof(float)));
 
-    // Partition data structure across DPUs
-    uint32_t numRowsPerDPU = ROUND_UP_TO_MULTIPLE_OF_2((numRows - 1)/numDPUs + 1);
-    PRINT_INFO(p.verbosity >= 1, "Assigning %u rows per DPU", numRowsPerDPU);
+    // Partition data structure across DPUs in ranges of an even number of rows, balancing either the row or the nonzero
+    // count, or in 2D blocks: every range of rows is split in numColParts ranges of columns, each DPU multiplying its block
+    // with the slice of the input vector of its columns into a partial output that the host sums
+    uint32_t numColParts = (p.partitioning == 2)?p.numColParts:1;
+    if(numDPUs%numColParts != 0) {
+        PRINT_ERROR("The number of column ranges (%u) must divide the number of DPUs (%u)!", numColParts, numDPUs);
+        exit(0);
+    }
+    uint32_t numRowParts = numDPUs/numColParts;
+    uint32_t dpuRowBounds[numRowParts + 1];
+    uint32_t dpuColBounds[numColParts + 1];
+    uint64_t* workPrefix = (p.partitioning > 0)?degreeWorkPrefix(rowPtrs, numRows):NULL;
+    partition2D(workPrefix, numRows, numCols, numRowParts, numColParts, 2, 2, dpuRowBounds, dpuColBounds);
+    free(workPrefix);
+    if(p.partitioning == 2) {
+        PRINT_INFO(p.verbosity >= 1, "Assigning blocks of about %u nonzeros and %u columns to a grid of %u x %u DPUs",
+                csrMatrix.numNonzeros/numDPUs, dpuColBounds[1] - dpuColBounds[0], numRowParts, numColParts);
+    } else if(p.partitioning == 1) {
+        PRINT_INFO(p.verbosity >= 1, "Assigning about %u nonzeros per DPU", csrMatrix.numNonzeros/numDPUs);
+    } else {
+        PRINT_INFO(p.verbosity >= 1, "Assigning %u rows per DPU", dpuRowBounds[1] - dpuRowBounds[0]);
+    }
+
+    // Find every DPU's rows, columns and CSR block: a slice of the matrix in 1D, or its nonzeros in the DPU's columns
+    // renumbered from the first one in 2D
     struct DPUParams dpuParams[numDPUs];
-    unsigned int dpuIdx = 0;
-    PRINT_INFO(p.verbosity == 1, "Copying data to DPUs");
-    DPU_FOREACH (dpu_set, dpu) {
-
-        // Allocate parameters
-        struct mram_heap_allocator_t allocator;
-        init_allocator(&allocator);
-        uint32_t dpuParams_m = mram_heap_alloc(&allocator, sizeof(struct DPUParams));
-
-        // Find DPU's rows
-        uint32_t dpuStartRowIdx = dpuIdx*numRowsPerDPU;
-        uint32_t dpuNumRows;
-        if(dpuStartRowIdx > numRows) {
-            dpuNumRows = 0;
-        } else if(dpuStartRowIdx + numRowsPerDPU > numRows) {
-            dpuNumRows = numRows - dpuStartRowIdx;
+    uint32_t* dpuRowPtrs_h[numDPUs];
+    struct Nonzero* dpuNonzeros_h[numDPUs];
+    uint32_t maxDPUNumRows = 0, maxDPUNumCols = 0, maxDPUNumNonzeros = 0;
+    #pragma omp parallel for schedule(dynamic, 1)
+    for(uint32_t dpuIdx = 0; dpuIdx < numDPUs; ++dpuIdx) {
+        uint32_t dpuStartRowIdx = dpuRowBounds[dpuIdx/numColParts];
+        uint32_t dpuNumRows = dpuRowBounds[dpuIdx/numColParts + 1] - dpuStartRowIdx;
+        uint32_t dpuStartColIdx = dpuColBounds[dpuIdx%numColParts];
+        uint32_t dpuEndColIdx = dpuColBounds[dpuIdx%numColParts + 1];
+        memset(&dpuParams[dpuIdx], 0, sizeof(struct DPUParams));
+        dpuParams[dpuIdx].dpuNumRows = dpuNumRows;
+        if(numColParts == 1) {
+            dpuRowPtrs_h[dpuIdx] = &rowPtrs[dpuStartRowIdx];
+            dpuNonzeros_h[dpuIdx] = &nonzeros[rowPtrs[dpuStartRowIdx]];
+            dpuParams[dpuIdx].dpuRowPtrsOffset = rowPtrs[dpuStartRowIdx];
         } else {
-            dpuNumRows = numRowsPerDPU;
+            dpuRowPtrs_h[dpuIdx] = (uint32_t*) malloc(ROUND_UP_TO_MULTIPLE_OF_2(dpuNumRows + 1)*sizeof(uint32_t));
+            uint32_t dpuNumNonzeros = 0;
+            for(uint32_t row = dpuStartRowIdx; row < dpuStartRowIdx + dpuNumRows; ++row) {
+                dpuRowPtrs_h[dpuIdx][row - dpuStartRowIdx] = dpuNumNonzeros;
+                for(uint32_t i = rowPtrs[row]; i < rowPtrs[row + 1]; ++i) {
+                    dpuNumNonzeros += (nonzeros[i].col >= dpuStartColIdx && nonzeros[i].col < dpuEndColIdx);
+                }
+            }
+            dpuRowPtrs_h[dpuIdx][dpuNumRows] = dpuNumNonzeros;
+            dpuNonzeros_h[dpuIdx] = (struct Nonzero*) malloc(dpuNumNonzeros*sizeof(struct Nonzero));
+            struct Nonzero* dpuNonzero = dpuNonzeros_h[dpuIdx];
+            for(uint32_t i = rowPtrs[dpuStartRowIdx]; i < rowPtrs[dpuStartRowIdx + dpuNumRows]; ++i) {
+                if(nonzeros[i].col >= dpuStartColIdx && nonzeros[i].col < dpuEndColIdx) {
+                    dpuNonzero->col = nonzeros[i].col - dpuStartColIdx;
+                    dpuNonzero->value = nonzeros[i].value;
+                    ++dpuNonzero;
+                }
+            }
         }
-        dpuParams[dpuIdx].dpuNumRows = dpuNumRows;
-        PRINT_INFO(p.verbosity >= 2, "    DPU %u:", dpuIdx);
-        PRINT_INFO(p.verbosity >= 2, "        Receives %u rows", dpuNumRows);
-
-        // Partition nonzeros and copy data
-        if(dpuNumRows > 0) {
-
-            // Find DPU's CSR matrix partition
-            uint32_t* dpuRowPtrs_h = &rowPtrs[dpuStartRowIdx];
-            uint32_t dpuRowPtrsOffset = dpuRowPtrs_h[0];
-            struct Nonzero* dpuNonzeros_h = &nonzeros[dpuRowPtrsOffset];
-            uint32_t dpuNumNonzeros = dpuRowPtrs_h[dpuNumRows] - dpuRowPtrsOffset;
-
-            // Allocate MRAM
-            uint32_t dpuRowPtrs_m = mram_heap_alloc(&allocator, (dpuNumRows + 1)*sizeof(uint32_t));
-            uint32_t dpuNonzeros_m = mram_heap_alloc(&allocator, dpuNumNonzeros*sizeof(struct Nonzero));
-            uint32_t dpuInVector_m = mram_heap_alloc(&allocator, numCols*sizeof(float));
-            uint32_t dpuOutVector_m = mram_heap_alloc(&allocator, dpuNumRows*sizeof(float));
-            assert((dpuNumRows*sizeof(float))%8 == 0 && "Output sub-vector must be a multiple of 8 bytes!");
-            PRINT_INFO(p.verbosity >= 2, "        Total memory allocated is %d bytes", allocator.totalAllocated);
-
-            // Set up DPU parameters
-            dpuParams[dpuIdx].dpuRowPtrsOffset = dpuRowPtrsOffset;
-            dpuParams[dpuIdx].dpuRowPtrs_m = dpuRowPtrs_m;
-            dpuParams[dpuIdx].dpuNonzeros_m = dpuNonzeros_m;
-            dpuParams[dpuIdx].dpuInVector_m = dpuInVector_m;
-            dpuParams[dpuIdx].dpuOutVector_m = dpuOutVector_m;
-
-            // Send data to DPU
-            PRINT_INFO(p.verbosity >= 2, "        Copying data to DPU");
-            startTimer(&timer);
-            copyToDPU(dpu, (uint8_t*)dpuRowPtrs_h, dpuRowPtrs_m, (dpuNumRows + 1)*sizeof(uint32_t));
-            copyToDPU(dpu, (uint8_t*)dpuNonzeros_h, dpuNonzeros_m, dpuNumNonzeros*sizeof(struct Nonzero));
-            copyToDPU(dpu, (uint8_t*)inVector, dpuInVector_m, numCols*sizeof(float));
-            stopTimer(&timer);
-            loadTime += getElapsedTime(timer);
-
+        uint32_t dpuNumNonzeros = dpuRowPtrs_h[dpuIdx][dpuNumRows] - dpuParams[dpuIdx].dpuRowPtrsOffset;
+        #pragma omp critical
+        {
+            maxDPUNumRows = (dpuNumRows > maxDPUNumRows)?dpuNumRows:maxDPUNumRows;
+            maxDPUNumCols = (dpuEndColIdx - dpuStartColIdx > maxDPUNumCols)?(dpuEndColIdx - dpuStartColIdx):maxDPUNumCols;
+            maxDPUNumNonzeros = (dpuNumNonzeros > maxDPUNumNonzeros)?dpuNumNonzeros:maxDPUNumNonzeros;
         }
+    }
 
-        // Send parameters to DPU
-        PRINT_INFO(p.verbosity >= 2, "        Copying parameters to DPU");
-        startTimer(&timer);
-        copyToDPU(dpu, (uint8_t*)&dpuParams[dpuIdx], dpuParams_m, sizeof(struct DPUParams));
-        stopTimer(&timer);
-        loadTime += getElapsedTime(timer);
-
-        ++dpuIdx;
+    // Allocate MRAM at the same offsets on all DPUs, sized for the largest block, so that each array is sent with one
+    // parallel transfer
+    struct mram_heap_allocator_t allocator;
+    init_allocator(&allocator);
+    uint32_t dpuParams_m = mram_heap_alloc(&allocator, sizeof(struct DPUParams));
+    uint32_t dpuRowPtrs_m = mram_heap_alloc(&allocator, (maxDPUNumRows + 1)*sizeof(uint32_t));
+    uint32_t dpuNonzeros_m = mram_heap_alloc(&allocator, maxDPUNumNonzeros*sizeof(struct Nonzero));
+    uint32_t dpuInVector_m = mram_heap_alloc(&allocator, maxDPUNumCols*sizeof(float));
+    uint32_t dpuOutVector_m = mram_heap_alloc(&allocator, maxDPUNumRows*sizeof(float));
+    PRINT_INFO(p.verbosity >= 2, "    Total memory allocated is %d bytes", allocator.totalAllocated);
+    uint64_t dpuSizes[numDPUs];
+    uint8_t* dpuSlices[numDPUs];
+    for(uint32_t dpuIdx = 0; dpuIdx < numDPUs; ++dpuIdx) {
+        dpuParams[dpuIdx].dpuRowPtrs_m = dpuRowPtrs_m;
+        dpuParams[dpuIdx].dpuNonzeros_m = dpuNonzeros_m;
+        dpuParams[dpuIdx].dpuInVector_m = dpuInVector_m;
+        dpuParams[dpuIdx].dpuOutVector_m = dpuOutVector_m;
+        PRINT_INFO(p.verbosity >= 2, "    DPU %u:", dpuIdx);
+        PRINT_INFO(p.verbosity >= 2, "        Receives %u rows", dpuParams[dpuIdx].dpuNumRows);
+    }
 
+    // Send data to DPUs
+    PRINT_INFO(p.verbosity == 1, "Copying data to DPUs");
+    startTimer(&timer);
+    uint8_t* rowPtrsEnd = (numColParts == 1)?(uint8_t*)&rowPtrs[ROUND_UP_TO_MULTIPLE_OF_2(numRows + 1)]:NULL;
+    uint8_t* nonzerosEnd = (numColParts == 1)?(uint8_t*)&nonzeros[csrMatrix.numNonzeros]:NULL;
+    for(uint32_t dpuIdx = 0; dpuIdx < numDPUs; ++dpuIdx) {
+        dpuSlices[dpuIdx] = (dpuParams[dpuIdx].dpuNumRows > 0)?(uint8_t*)dpuRowPtrs_h[dpuIdx]:NULL;
+        dpuSizes[dpuIdx] = (dpuParams[dpuIdx].dpuNumRows + 1)*sizeof(uint32_t);
+    }
+    pushSlicesToDPUs(dpu_set, numDPUs, dpuRowPtrs_m, dpuSlices, dpuSizes, rowPtrsEnd);
+    for(uint32_t dpuIdx = 0; dpuIdx < numDPUs; ++dpuIdx) {
+        uint32_t dpuNumRows = dpuParams[dpuIdx].dpuNumRows;
+        dpuSlices[dpuIdx] = (dpuNumRows > 0)?(uint8_t*)dpuNonzeros_h[dpuIdx]:NULL;
+        dpuSizes[dpuIdx] = (dpuNumRows > 0)?(dpuRowPtrs_h[dpuIdx][dpuNumRows] - dpuParams[dpuIdx].dpuRowPtrsOffset)*sizeof(struct Nonzero):0;
+    }
+    pushSlicesToDPUs(dpu_set, numDPUs, dpuNonzeros_m, dpuSlices, dpuSizes, nonzerosEnd);
+    for(uint32_t dpuIdx = 0; dpuIdx < numDPUs; ++dpuIdx) {
+        uint32_t dpuStartColIdx = dpuColBounds[dpuIdx%numColParts];
+        dpuSlices[dpuIdx] = (uint8_t*)&inVector[dpuStartColIdx];
+        dpuSizes[dpuIdx] = (dpuColBounds[dpuIdx%numColParts + 1] - dpuStartColIdx)*sizeof(float);
+    }
+    pushSlicesToDPUs(dpu_set, numDPUs, dpuInVector_m, dpuSlices, dpuSizes, (uint8_t*)inVector + ROUND_UP_TO_MULTIPLE_OF_8(numCols*sizeof(float)));
+    for(uint32_t dpuIdx = 0; dpuIdx < numDPUs; ++dpuIdx) {
+        dpuSlices[dpuIdx] = (uint8_t*)&dpuParams[dpuIdx];
+        dpuSizes[dpuIdx] = sizeof(struct DPUParams);
+    }
+    pushSlicesToDPUs(dpu_set, numDPUs, dpuParams_m, dpuSlices, dpuSizes, (uint8_t*)&dpuParams[numDPUs]);
+    stopTimer(&timer);
+    loadTime += getElapsedTime(timer);
+    if(numColParts > 1) {
+        for(uint32_t dpuIdx = 0; dpuIdx < numDPUs; ++dpuIdx) {
+            free(dpuRowPtrs_h[dpuIdx]);
+            free(dpuNonzeros_h[dpuIdx]);
+        }
     }
     PRINT_INFO(p.verbosity >= 1, "    CPU-DPU Time: %f ms", loadTime*1e3);
 
@@ -155,18 +211,22 @@ int main(int argc, char** argv) {
     dpuTime += getElapsedTime(timer);
     PRINT_INFO(p.verbosity >= 1, "    DPU Time: %f ms", dpuTime*1e3);
 
-    // Copy back result
+    // Copy back the (partial) outputs of all DPUs and sum those of the same rows
     PRINT_INFO(p.verbosity >= 1, "Copying back the result");
     startTimer(&timer);
-    dpuIdx = 0;
-    DPU_FOREACH (dpu_set, dpu) {
-        unsigned int dpuNumRows = dpuParams[dpuIdx].dpuNumRows;
-        if(dpuNumRows > 0) {
-            uint32_t dpuStartRowIdx = dpuIdx*numRowsPerDPU;
-            copyFromDPU(dpu, dpuParams[dpuIdx].dpuOutVector_m, (uint8_t*)(outVector + dpuStartRowIdx), dpuNumRows*sizeof(float));
+    float* dpuOutVectors = (float*) malloc((uint64_t)numDPUs*maxDPUNumRows*sizeof(float));
+    pullFromDPUs(dpu_set, dpuOutVector_m, (uint8_t*)dpuOutVectors, maxDPUNumRows*sizeof(float));
+    memset(outVector, 0, numRows*sizeof(float));
+    #pragma omp parallel for schedule(dynamic, 1)
+    for(uint32_t rowPart = 0; rowPart < numRowParts; ++rowPart) {
+        for(uint32_t dpuIdx = rowPart*numColParts; dpuIdx < (rowPart + 1)*numColParts; ++dpuIdx) {
+            float* dpuOutVector = &dpuOutVectors[(uint64_t)dpuIdx*maxDPUNumRows];
+            for(uint32_t i = 0; i < dpuParams[dpuIdx].dpuNumRows; ++i) {
+                outVector[dpuRowBounds[rowPart] + i] += dpuOutVector[i];
+            }
         }
-        ++dpuIdx;
     }
+    free(dpuOutVectors);
     stopTimer(&timer);
     retrieveTime += getElapsedTime(timer);
     PRINT_INFO(p.verbosity >= 1, "    DPU-CPU Time: %f ms", retrieveTime*1e3);
@@ -198,7 +258,7 @@ int main(int argc, char** argv) {
     // Display DPU Logs
     if(p.verbosity >= 2) {
         PRINT_INFO(p.verbosity >= 2, "Displaying DPU Logs:");
-        dpuIdx = 0;
+        unsigned int dpuIdx = 0;
         DPU_FOREACH (dpu_set, dpu) {
             PRINT("DPU %u:", dpuIdx);
             DPU_ASSERT(dpu_log_read(dpu, stdout));
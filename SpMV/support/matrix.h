@@ -4,8 +4,11 @@
 
 #include <assert.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include "common.h"
+#include "input.h"
 #include "utils.h"
 
 struct COOMatrix {
@@ -24,32 +27,54 @@ struct CSRMatrix {
     struct Nonzero* nonzeros;
 };
 
+// Read a matrix from a Matrix Market text file (1-based indexes) or a binary COO file
 static struct COOMatrix readCOOMatrix(const char* fileName) {
 
     struct COOMatrix cooMatrix;
 
+    // Map the file, then detect binary files by their magic number, otherwise parse the text format
+    size_t size;
+    const char* data = mapFile(fileName, &size);
+    const char* pos = data;
+    const char* end = data + size;
+    uint32_t binary = isBinaryCOO(data, size);
+
     // Initialize fields
-    FILE* fp = fopen(fileName, "r");
-    assert(fscanf(fp, "%u", &cooMatrix.numRows));
+    if(binary) {
+        cooMatrix.numRows = ((const uint32_t*)data)[1];
+        cooMatrix.numCols = ((const uint32_t*)data)[2];
+        cooMatrix.numNonzeros = ((const uint32_t*)data)[3];
+        assert(size >= (4 + 2*(size_t)cooMatrix.numNonzeros)*sizeof(uint32_t) && "Truncated binary file!");
+    } else {
+        cooMatrix.numRows = parseUint(&pos, end);
+        cooMatrix.numCols = parseUint(&pos, end);
+        cooMatrix.numNonzeros = parseUint(&pos, end);
+    }
     if(cooMatrix.numRows%2 == 1) {
         PRINT_WARNING("Reading matrix %s: number of rows must be even. Padding with an extra row.", fileName);
         cooMatrix.numRows++;
     }
-    assert(fscanf(fp, "%u", &cooMatrix.numCols));
-    assert(fscanf(fp, "%u", &cooMatrix.numNonzeros));
     cooMatrix.rowIdxs = (uint32_t*) malloc(ROUND_UP_TO_MULTIPLE_OF_8(cooMatrix.numNonzeros*sizeof(uint32_t)));
     cooMatrix.nonzeros = (struct Nonzero*) malloc(ROUND_UP_TO_MULTIPLE_OF_8(cooMatrix.numNonzeros*sizeof(struct Nonzero)));
 
-    // Read the nonzeros
-    for(uint32_t i = 0; i < cooMatrix.numNonzeros; ++i) {
-        uint32_t rowIdx;
-        assert(fscanf(fp, "%u", &rowIdx));
-        cooMatrix.rowIdxs[i] = rowIdx - 1; // File format indexes begin at 1
-        uint32_t colIdx;
-        assert(fscanf(fp, "%u", &colIdx));
-        cooMatrix.nonzeros[i].col = colIdx - 1; // File format indexes begin at 1
-        cooMatrix.nonzeros[i].value = 1.0f;
+    // Read the nonzeros (binary indexes are 0-based, text file format indexes begin at 1)
+    if(binary) {
+        const uint32_t* rowIdxs = (const uint32_t*)data + 4;
+        const uint32_t* colIdxs = rowIdxs + cooMatrix.numNonzeros;
+        #pragma omp parallel for
+        for(uint32_t i = 0; i < cooMatrix.numNonzeros; ++i) {
+            cooMatrix.rowIdxs[i] = rowIdxs[i];
+            cooMatrix.nonzeros[i].col = colIdxs[i];
+            cooMatrix.nonzeros[i].value = 1.0f;
+        }
+    } else {
+        for(uint32_t i = 0; i < cooMatrix.numNonzeros; ++i) {
+            cooMatrix.rowIdxs[i] = parseUint(&pos, end) - 1;
+            cooMatrix.nonzeros[i].col = parseUint(&pos, end) - 1;
+            cooMatrix.nonzeros[i].value = 1.0f;
+        }
     }
+    munmap((void*)data, (size > 0)?size:1);
 
     return cooMatrix;
 
@@ -71,11 +96,14 @@ static struct CSRMatrix coo2csr(struct COOMatrix cooMatrix) {
     csrMatrix.rowPtrs = (uint32_t*) malloc(ROUND_UP_TO_MULTIPLE_OF_8((csrMatrix.numRows + 1)*sizeof(uint32_t)));
     csrMatrix.nonzeros = (struct Nonzero*) malloc(ROUND_UP_TO_MULTIPLE_OF_8(csrMatrix.numNonzeros*sizeof(struct Nonzero)));
 
-    // Histogram rowIdxs
+    // Histogram rowIdxs in parallel, checking whether the nonzeros are already sorted by row
     memset(csrMatrix.rowPtrs, 0, (csrMatrix.numRows + 1)*sizeof(uint32_t));
+    uint32_t numUnsorted = 0;
+    #pragma omp parallel for reduction(+:numUnsorted)
     for(uint32_t i = 0; i < cooMatrix.numNonzeros; ++i) {
         uint32_t rowIdx = cooMatrix.rowIdxs[i];
-        csrMatrix.rowPtrs[rowIdx]++;
+        __atomic_fetch_add(&csrMatrix.rowPtrs[rowIdx], 1, __ATOMIC_RELAXED);
+        numUnsorted += (i > 0 && cooMatrix.rowIdxs[i - 1] > rowIdx);
     }
 
     // Prefix sum rowPtrs
@@ -87,6 +115,15 @@ static struct CSRMatrix coo2csr(struct COOMatrix cooMatrix) {
     }
     csrMatrix.rowPtrs[csrMatrix.numRows] = sumBeforeNextRow;
 
+    // Nonzeros sorted by row (as in most input files) are already binned, so copy them in parallel
+    if(numUnsorted == 0) {
+        #pragma omp parallel for
+        for(uint32_t i = 0; i < cooMatrix.numNonzeros; ++i) {
+            csrMatrix.nonzeros[i] = cooMatrix.nonzeros[i];
+        }
+        return csrMatrix;
+    }
+
     // Bin the nonzeros
     for(uint32_t i = 0; i < cooMatrix.numNonzeros; ++i) {
         uint32_t rowIdx = cooMatrix.rowIdxs[i];
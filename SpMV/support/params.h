@@ -9,7 +9,10 @@ static void usage() {
     PRINT(  "\nUsage:  ./program [options]"
             "\n"
             "\nBenchmark-specific options:"
-            "\n    -f <F>    input matrix file name (default=data/bcsstk30.mtx)"
+            "\n    -f <F>    input matrix file name, .mtx text or synth binary (default=data/bcsstk30.mtx)"
+            "\n    -p <P>    partitioning across DPUs: 0=equal row counts, 1=balanced nonzero counts,"
+            "\n              2=2D blocks of balanced nonzero counts per row range and equal column counts (default=0)"
+            "\n    -c <C>    number of column ranges for 2D partitioning, dividing the number of DPUs (default=2)"
             "\n"
             "\nGeneral options:"
             "\n    -v <V>    verbosity"
@@ -19,17 +22,23 @@ static void usage() {
 
 typedef struct Params {
   const char* fileName;
+  unsigned int partitioning;
+  unsigned int numColParts;
   unsigned int verbosity;
 } Params;
 
 static struct Params input_params(int argc, char **argv) {
     struct Params p;
     p.fileName      = "data/bcsstk30.mtx";
+    p.partitioning  = 0;
+    p.numColParts   = 2;
     p.verbosity     = 1;
     int opt;
-    while((opt = getopt(argc, argv, "f:v:h")) >= 0) {
+    while((opt = getopt(argc, argv, "f:p:c:v:h")) >= 0) {
         switch(opt) {
             case 'f': p.fileName    = optarg;       break;
+            case 'p': p.partitioning = atoi(optarg); break;
+            case 'c': p.numColParts = atoi(optarg); break;
             case 'v': p.verbosity   = atoi(optarg); break;
             case 'h': usage(); exit(0);
             default:
@@ -39,6 +48,9 @@ static struct Params input_params(int argc, char **argv) {
         }
     }
 
+    assert(p.partitioning <= 2 && "Invalid partitioning!");
+    assert(p.numColParts > 0 && "Invalid number of column ranges!");
+
     return p;
 }
 
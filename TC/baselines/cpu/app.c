@@ -7,141 +7,190 @@
 #include <stdint.h>
 
 #include <omp.h>
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
 
 #include "../../support/common.h"
-#include "../../support/graph.h"
+#include "graph.h"
 #include "../../support/params.h"
 #include "../../support/timer.h"
 #include "../../support/utils.h"
 
+// Lists whose lengths differ by more than this factor are intersected by galloping
+#define GALLOP_RATIO 32
+
+// Scalar merge of two sorted lists
+static uint64_t intersectMerge(const uint32_t* a, uint32_t na, const uint32_t* b, uint32_t nb) {
+    uint64_t count = 0;
+    uint32_t i = 0, j = 0;
+    while(i < na && j < nb) {
+        if(a[i] < b[j]) {
+            ++i;
+        } else if(a[i] > b[j]) {
+            ++j;
+        } else {
+            ++count;
+            ++i;
+            ++j;
+        }
+    }
+    return count;
+}
+
+// Look up every element of the short list in the long one with exponential then binary search
+static uint64_t intersectGallop(const uint32_t* small, uint32_t nSmall, const uint32_t* large, uint32_t nLarge) {
+    uint64_t count = 0;
+    uint32_t lo = 0;
+    for(uint32_t i = 0; i < nSmall && lo < nLarge; ++i) {
+        uint32_t x = small[i];
+        uint32_t step = 1, hi = lo;
+        while(hi < nLarge && large[hi] < x) {
+            lo = hi + 1;
+            hi += step;
+            step <<= 1;
+        }
+        if(hi > nLarge) {
+            hi = nLarge;
+        }
+        while(lo < hi) {
+            uint32_t mid = lo + (hi - lo)/2;
+            if(large[mid] < x) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        if(lo < nLarge && large[lo] == x) {
+            ++count;
+            ++lo;
+        }
+    }
+    return count;
+}
+
+// Block-wise SIMD merge: compare a block of each list against all rotations of the other,
+// then advance the block(s) with the smaller last element
+static uint64_t intersectSIMD(const uint32_t* a, uint32_t na, const uint32_t* b, uint32_t nb) {
+    uint64_t count = 0;
+    uint32_t i = 0, j = 0;
+#if defined(__AVX2__)
+    const __m256i rotate = _mm256_set_epi32(0, 7, 6, 5, 4, 3, 2, 1);
+    while(i + 8 <= na && j + 8 <= nb) {
+        __m256i va = _mm256_loadu_si256((const __m256i*)(a + i));
+        __m256i vb = _mm256_loadu_si256((const __m256i*)(b + j));
+        __m256i match = _mm256_cmpeq_epi32(va, vb);
+        for(int r = 1; r < 8; ++r) {
+            vb = _mm256_permutevar8x32_epi32(vb, rotate);
+            match = _mm256_or_si256(match, _mm256_cmpeq_epi32(va, vb));
+        }
+        count += __builtin_popcount(_mm256_movemask_ps(_mm256_castsi256_ps(match)));
+        uint32_t aLast = a[i + 7], bLast = b[j + 7];
+        i += (aLast <= bLast)?8:0;
+        j += (bLast <= aLast)?8:0;
+    }
+#elif defined(__SSE2__)
+    while(i + 4 <= na && j + 4 <= nb) {
+        __m128i va = _mm_loadu_si128((const __m128i*)(a + i));
+        __m128i vb = _mm_loadu_si128((const __m128i*)(b + j));
+        __m128i match = _mm_or_si128(
+                _mm_or_si128(_mm_cmpeq_epi32(va, vb), _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(0, 3, 2, 1)))),
+                _mm_or_si128(_mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(1, 0, 3, 2))), _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(2, 1, 0, 3)))));
+        count += __builtin_popcount(_mm_movemask_ps(_mm_castsi128_ps(match)));
+        uint32_t aLast = a[i + 3], bLast = b[j + 3];
+        i += (aLast <= bLast)?4:0;
+        j += (bLast <= aLast)?4:0;
+    }
+#endif
+    return count + intersectMerge(a + i, na - i, b + j, nb - j);
+}
+
+static uint64_t intersect(const uint32_t* a, uint32_t na, const uint32_t* b, uint32_t nb) {
+    if(na == 0 || nb == 0) {
+        return 0;
+    }
+    if((uint64_t)na*GALLOP_RATIO < nb) {
+        return intersectGallop(a, na, b, nb);
+    }
+    if((uint64_t)nb*GALLOP_RATIO < na) {
+        return intersectGallop(b, nb, a, na);
+    }
+    return intersectSIMD(a, na, b, nb);
+}
+
+// Count triangles u < v < w of an oriented graph as the elements w common to N(u) after v and N(v)
+static uint64_t countTriangles(struct CSRGraph dagGraph, int simd) {
+    uint64_t numTriangles = 0;
+    #pragma omp parallel for schedule(dynamic, 64) reduction(+:numTriangles)
+    for(uint32_t u = 0; u < dagGraph.numNodes; ++u) {
+        uint32_t uStart = dagGraph.nodePtrs[u];
+        uint32_t uEnd = dagGraph.nodePtrs[u + 1];
+        for(uint32_t i = uStart; i < uEnd; ++i) {
+            uint32_t v = dagGraph.neighborIdxs[i];
+            const uint32_t* a = &dagGraph.neighborIdxs[i + 1];
+            const uint32_t* b = &dagGraph.neighborIdxs[dagGraph.nodePtrs[v]];
+            uint32_t na = uEnd - i - 1;
+            uint32_t nb = dagGraph.nodePtrs[v + 1] - dagGraph.nodePtrs[v];
+            numTriangles += simd?intersect(a, na, b, nb):intersectMerge(a, na, b, nb);
+        }
+    }
+    return numTriangles;
+}
+
 int main(int argc, char** argv) {
 
     // Process parameters
     struct Params p = input_params(argc, argv);
 
-    // Initialize BFS data structures
+    // Initialize TC data structures
     PRINT_INFO(p.verbosity >= 1, "Reading graph %s", p.fileName);
-    struct COOGraph cooGraph = readCOOGraph(p.fileName);
-    PRINT_INFO(p.verbosity >= 1, "    Graph has %d nodes and %d edges", cooGraph.numNodes, cooGraph.numEdges);
-    struct CSRGraph csrGraph = coo2csr(cooGraph);
-    uint32_t* nodeLevel = (uint32_t*) malloc(csrGraph.numNodes*sizeof(uint32_t));
-    uint32_t* nodeLevelRef = (uint32_t*) malloc(csrGraph.numNodes*sizeof(uint32_t));
-    for(uint32_t i = 0; i < csrGraph.numNodes; ++i) {
-        nodeLevel[i] = UINT32_MAX; // Unreachable
-        nodeLevelRef[i] = UINT32_MAX; // Unreachable
-    }
-    uint32_t srcNode = 0;
-
-    // Initialize frontier double buffers
-    uint32_t* buffer1 = (uint32_t*) malloc(csrGraph.numNodes*sizeof(uint32_t));
-    uint32_t* buffer2 = (uint32_t*) malloc(csrGraph.numNodes*sizeof(uint32_t));
-    uint32_t* prevFrontier = buffer1;
-    uint32_t* currFrontier = buffer2;
+    struct CSRGraph csrGraph = read_graph_data(p.fileName);
+    PRINT_INFO(p.verbosity >= 1, "    Graph has %d nodes and %d edges", csrGraph.numNodes, csrGraph.numEdges);
 
-    // Calculating result on CPU
-    PRINT_INFO(p.verbosity >= 1, "Calculating result on CPU (OpenMP)");
-    omp_set_num_threads(4);
+    // Order nodes by degree, orient edges from lower to higher node and sort the neighbor lists
+    PRINT_INFO(p.verbosity >= 1, "Building the degree-ordered DAG");
     Timer timer;
     startTimer(&timer);
-    nodeLevel[srcNode] = 0;
-    prevFrontier[0] = srcNode;
-    uint32_t numPrevFrontier = 1;
-    for(uint32_t level = 1; numPrevFrontier > 0; ++level) {
-
-        uint32_t numCurrFrontier = 0;
-
-        // Visit nodes in the previous frontier
-        #pragma omp parallel for
-        for(uint32_t i = 0; i < numPrevFrontier; ++i) {
-            uint32_t node = prevFrontier[i];
-            for(uint32_t edge = csrGraph.nodePtrs[node]; edge < csrGraph.nodePtrs[node + 1]; ++edge) {
-                uint32_t neighbor = csrGraph.neighborIdxs[edge];
-                uint32_t justVisited = 0;
-                #pragma omp critical
-                {
-                    if(nodeLevel[neighbor] == UINT32_MAX) { // Node not previously visited
-                        nodeLevel[neighbor] = level;
-                        justVisited = 1;
-                    }
-                }
-                if(justVisited) {
-                    uint32_t currFrontierIdx;
-                    #pragma omp critical
-                    {
-                        currFrontierIdx = numCurrFrontier++;
-                    }
-                    currFrontier[currFrontierIdx] = neighbor;
-                }
-            }
-        }
-
-        // Swap buffers
-        uint32_t* tmp = prevFrontier;
-        prevFrontier = currFrontier;
-        currFrontier = tmp;
-        numPrevFrontier = numCurrFrontier;
-
-    }
+    struct CSRGraph relabeledGraph = relabelByDegree(csrGraph);
+    struct CSRGraph dagGraph = orientCSRGraph(relabeledGraph);
     stopTimer(&timer);
-    if(p.verbosity == 0) PRINT("%f", getElapsedTime(timer)*1e3);
-    PRINT_INFO(p.verbosity >= 1, "Elapsed time: %f ms", getElapsedTime(timer)*1e3);
+    PRINT_INFO(p.verbosity >= 1, "    Elapsed time: %f ms", getElapsedTime(timer)*1e3);
 
-    // Calculating result on CPU sequentially
-    PRINT_INFO(p.verbosity >= 1, "Calculating result on CPU (sequential)");
+    // Calculating reference result on CPU sequentially with a scalar merge
+    PRINT_INFO(p.verbosity >= 1, "Calculating result on CPU (sequential, scalar merge)");
+    int maxThreads = omp_get_max_threads();
+    omp_set_num_threads(1);
     startTimer(&timer);
-    nodeLevelRef[srcNode] = 0;
-    prevFrontier[0] = srcNode;
-    numPrevFrontier = 1;
-    for(uint32_t level = 1; numPrevFrontier > 0; ++level) {
-
-        uint32_t numCurrFrontier = 0;
-
-        // Visit nodes in the previous frontier
-        for(uint32_t i = 0; i < numPrevFrontier; ++i) {
-            uint32_t node = prevFrontier[i];
-            for(uint32_t edge = csrGraph.nodePtrs[node]; edge < csrGraph.nodePtrs[node + 1]; ++edge) {
-                uint32_t neighbor = csrGraph.neighborIdxs[edge];
-                uint32_t justVisited = 0;
-                if(nodeLevelRef[neighbor] == UINT32_MAX) { // Node not previously visited
-                    nodeLevelRef[neighbor] = level;
-                    justVisited = 1;
-                }
-                if(justVisited) {
-                    uint32_t currFrontierIdx;
-                    currFrontierIdx = numCurrFrontier++;
-                    currFrontier[currFrontierIdx] = neighbor;
-                }
-            }
-        }
-
-        // Swap buffers
-        uint32_t* tmp = prevFrontier;
-        prevFrontier = currFrontier;
-        currFrontier = tmp;
-        numPrevFrontier = numCurrFrontier;
-
-    }
+    uint64_t numTrianglesRef = countTriangles(dagGraph, 0);
     stopTimer(&timer);
-    if(p.verbosity == 0) PRINT("%f", getElapsedTime(timer)*1e3);
-    PRINT_INFO(p.verbosity >= 1, "Elapsed time: %f ms", getElapsedTime(timer)*1e3);
-
-    // Verifying result
-    PRINT_INFO(p.verbosity >= 1, "Verifying the result");
-    for(uint32_t nodeIdx = 0; nodeIdx < csrGraph.numNodes; ++nodeIdx) {
-        if(nodeLevel[nodeIdx] != nodeLevelRef[nodeIdx]) {
-            PRINT_ERROR("Mismatch at node %u (CPU sequential result = level %u, CPU parallel result = level %u)", nodeIdx, nodeLevelRef[nodeIdx], nodeLevel[nodeIdx]);
+    PRINT_INFO(p.verbosity >= 1, "    Elapsed time: %f ms", getElapsedTime(timer)*1e3);
+    PRINT_INFO(p.verbosity >= 1, "    Graph has %lu triangles", (unsigned long)numTrianglesRef);
+
+    // Calculating result on CPU with SIMD/galloping intersection for increasing thread counts
+    // (the thread count goes up to OMP_NUM_THREADS, which defaults to the number of cores)
+    for(int numThreads = 1; ; numThreads = (numThreads*2 < maxThreads)?numThreads*2:maxThreads) {
+        PRINT_INFO(p.verbosity >= 1, "Calculating result on CPU (OpenMP, %d threads)", numThreads);
+        omp_set_num_threads(numThreads);
+        startTimer(&timer);
+        uint64_t numTriangles = countTriangles(dagGraph, 1);
+        stopTimer(&timer);
+        float elapsedTime = getElapsedTime(timer);
+        if(p.verbosity == 0) PRINT("%d %f %f", numThreads, elapsedTime*1e3, numTriangles/elapsedTime);
+        PRINT_INFO(p.verbosity >= 1, "    Elapsed time: %f ms", elapsedTime*1e3);
+        PRINT_INFO(p.verbosity >= 1, "    Triangles/sec: %f", numTriangles/elapsedTime);
+        if(numTriangles != numTrianglesRef) {
+            PRINT_ERROR("Mismatch (CPU sequential result = %lu triangles, CPU parallel result = %lu triangles)", (unsigned long)numTrianglesRef, (unsigned long)numTriangles);
+        }
+        if(numThreads == maxThreads) {
+            break;
         }
     }
 
-
     // Deallocate data structures
-    freeCOOGraph(cooGraph);
     freeCSRGraph(csrGraph);
-    free(nodeLevel);
-    free(buffer1);
-    free(buffer2);
+    freeCSRGraph(relabeledGraph);
+    freeCSRGraph(dagGraph);
 
     return 0;
 
 }
-
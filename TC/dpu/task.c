@@ -8,22 +8,47 @@
 #include <barrier.h>
 #include <defs.h>
 #include <mram.h>
-#include <mutex.h>
 #include <perfcounter.h>
 
 #include "dpu-utils.h"
+#include "graph-access.h"
 #include "common.h"
 
+__host struct DPUResults DPU_RESULTS;
+
 BARRIER_INIT(my_barrier, NR_TASKLETS);
-BARRIER_INIT(beforeStoringTC, NR_TASKLETS);
 
-MUTEX_INIT(nextFrontierMutex);
+// Per-tasklet triangle counts and merge steps, reduced into DPU_RESULTS
+uint64_t taskletTriangleCounts[NR_TASKLETS];
+uint64_t taskletIntersectionSteps[NR_TASKLETS];
+
+// Count the common elements of two sorted neighbor lists, adding the number of merge steps to steps
+static uint32_t intersect(struct NeighborReader* a, struct NeighborReader* b, uint64_t* steps) {
+    uint32_t count = 0;
+    uint32_t aStart = a->idx, bStart = b->idx;
+    while(a->idx < a->end && b->idx < b->end) {
+        uint32_t x = getNeighbor(a);
+        uint32_t y = getNeighbor(b);
+        if(x < y) {
+            ++a->idx;
+        } else if(x > y) {
+            ++b->idx;
+        } else {
+            ++count;
+            ++a->idx;
+            ++b->idx;
+        }
+    }
+    *steps += (a->idx - aStart) + (b->idx - bStart) - count;
+    return count;
+}
 
 // main
 int main() {
 
     if(me() == 0) {
         mem_reset(); // Reset the heap
+        perfcounter_config(COUNT_CYCLES, true);
     }
     // Barrier
     barrier_wait(&my_barrier);
@@ -34,74 +59,68 @@ int main() {
     mram_read((__mram_ptr void const*)params_m, params_w, ROUND_UP_TO_MULTIPLE_OF_8(sizeof(struct DPUParams)));
 
     // Extract parameters
-    uint32_t numGlobalNodes = params_w->numNodes;
-    uint32_t startNodeIdx = params_w->dpuStartNodeIdx;
     uint32_t numNodes = params_w->dpuNumNodes;
     uint32_t nodePtrsOffset = params_w->dpuNodePtrsOffset;
     uint32_t nodePtrs_m = params_w->dpuNodePtrs_m;
     uint32_t neighborIdxs_m = params_w->dpuNeighborIdxs_m;
-    uint32_t dpuTriangleCount_m = params_w->dpuTriangleCount_m;
 
+    uint64_t localTriangleCount = 0;
+    uint64_t localIntersectionSteps = 0;
     if(numNodes > 0) {
 
-        uint64_t* cache_w = mem_alloc(sizeof(uint64_t));
-           
-
-        // Identify tasklet's nodes
-        uint32_t numNodesPerTasklet = (numNodes + NR_TASKLETS - 1)/NR_TASKLETS;
-        uint32_t taskletNodesStart = me()*numNodesPerTasklet;
-        uint32_t taskletNumNodes;
-        if(taskletNodesStart > numNodes) {
-            taskletNumNodes = 0;
-        } else if(taskletNodesStart + numNodesPerTasklet > numNodes) {
-            taskletNumNodes = numNodes - taskletNodesStart;
-        } else {
-            taskletNumNodes = numNodesPerTasklet;
-        }
+        // Allocate WRAM cache and graph readers for each tasklet to use throughout
+        uint64_t* cache_w = mem_alloc(2*sizeof(uint64_t));
+        struct NodePtrReader uNodePtrs;
+        struct NeighborReader uOuter, uInner, vNeighbors;
+        initNodePtrReader(&uNodePtrs, nodePtrs_m, nodePtrsOffset, numNodes + 1);
+        initNeighborReader(&uOuter, neighborIdxs_m);
+        initNeighborReader(&uInner, neighborIdxs_m);
+        initNeighborReader(&vNeighbors, neighborIdxs_m);
 
-        uint32_t localTriangleCount = 0;
+        // Identify tasklet's nodes (the host balances the tasklet ranges by estimated work)
+        uint32_t taskletNodesStart = params_w->taskletNodesStart[me()];
+        uint32_t taskletNumNodes = params_w->taskletNodesStart[me() + 1] - taskletNodesStart;
+
+        // The graph is oriented (every neighbor v of u satisfies v > u) and its neighbor lists are sorted,
+        // so each triangle u < v < w is counted once as an element w of both N(u) after v and N(v)
         for(uint32_t u = taskletNodesStart; u < taskletNodesStart + taskletNumNodes; ++u) {
             // get node u neighbors
-            uint32_t uNodePtr = load4B(nodePtrs_m, u, cache_w) - nodePtrsOffset;
-            uint32_t uNextNodePtr = load4B(nodePtrs_m, u + 1, cache_w) - nodePtrsOffset; // TODO: Optimize: might be in the same 8B as nodePtr
-            
+            uint32_t uNodePtr, uNextNodePtr;
+            getNodePtrs(&uNodePtrs, u, &uNodePtr, &uNextNodePtr);
+
             // iterate through node u neighbors
-            for(uint32_t i = uNodePtr; i < uNextNodePtr; ++i) {
-                // read node v
-                uint32_t v = load4B(neighborIdxs_m, i, cache_w); // TODO: Optimize: sequential access to neighbors can use sequential reader
-                
+            for(seekNeighbors(&uOuter, uNodePtr, uNextNodePtr); uOuter.idx + 1 < uNextNodePtr; ++uOuter.idx) {
+                // read node v (numbered within the DPU's subgraph, whose own nodes come first)
+                uint32_t v = getNeighbor(&uOuter);
+
                 // read node v neighbors
-                uint32_t vNodePtr = load4B(nodePtrs_m, v, cache_w) - nodePtrsOffset;
-                uint32_t vNextNodePtr = load4B(nodePtrs_m, v + 1, cache_w) - nodePtrsOffset;
-                // iterate through node v neighbors
-                for(uint32_t j = vNodePtr; j < vNextNodePtr; ++j) {
-                    uint32_t vNeighbor = load4B(neighborIdxs_m, j, cache_w);
-                    for(uint32_t k = uNodePtr; k < uNextNodePtr; ++k) {
-                        uint32_t uNeighbor = load4B(neighborIdxs_m, k, cache_w);
-                        if(uNeighbor != v && vNeighbor != u && uNeighbor == vNeighbor) {
-                            localTriangleCount++;
-                        }
-                    }
-                }
+                uint32_t vNodePtr, vNextNodePtr;
+                loadNodePtrs(nodePtrs_m, nodePtrsOffset, v, cache_w, &vNodePtr, &vNextNodePtr);
+
+                // intersect the neighbors of u after v with the neighbors of v
+                seekNeighbors(&uInner, uOuter.idx + 1, uNextNodePtr);
+                seekNeighbors(&vNeighbors, vNodePtr, vNextNodePtr);
+                localTriangleCount += intersect(&uInner, &vNeighbors, &localIntersectionSteps);
             }
         }
-        mutex_id_t mutexID = MUTEX_GET(nextFrontierMutex);
-        mutex_lock(mutexID);
-        uint32_t dpuTriangleCount = load4B(dpuTriangleCount_m, 0, cache_w);   
-        dpuTriangleCount += localTriangleCount;
-        store4B(dpuTriangleCount, dpuTriangleCount_m, 0, cache_w);
-        mutex_unlock(mutexID);
-
-        barrier_wait(&beforeStoringTC);
-
-        if(me() == 0) {
-            uint32_t dpuTriangleCount_last = load4B(dpuTriangleCount_m, 0, cache_w);   
-            //devide by 6 because of repeatations
-            uint32_t finalTriangleCount = dpuTriangleCount_last / 6;
-            // Store triangle count
-            store4B(finalTriangleCount, dpuTriangleCount_m, 0, cache_w);
+    }
+
+    // Tree-based reduction of the per-tasklet counts
+    taskletTriangleCounts[me()] = localTriangleCount;
+    taskletIntersectionSteps[me()] = localIntersectionSteps;
+    barrier_wait(&my_barrier);
+    for(uint32_t offset = 1; offset < NR_TASKLETS; offset <<= 1) {
+        if((me() & (2*offset - 1)) == 0 && me() + offset < NR_TASKLETS) {
+            taskletTriangleCounts[me()] += taskletTriangleCounts[me() + offset];
+            taskletIntersectionSteps[me()] += taskletIntersectionSteps[me() + offset];
         }
+        barrier_wait(&my_barrier);
+    }
+    if(me() == 0) {
+        DPU_RESULTS.triangleCount = taskletTriangleCounts[0];
+        DPU_RESULTS.intersectionSteps = taskletIntersectionSteps[0];
+        DPU_RESULTS.cycles = perfcounter_get();
     }
-    
+
     return 0;
-}
\ No newline at end of file
+}
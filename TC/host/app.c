@@ -14,6 +14,8 @@
 #include <unistd.h>
 
 #include "mram-management.h"
+#include "partition.h"
+#include "staging.h"
 #include "common.h"
 #include "graph.h"
 #include "params.h"
@@ -29,10 +31,11 @@
 
 #define DPU_BINARY "./bin/dpu_code"
 
-uint32_t countTriangles( uint32_t numNodes, uint32_t* nodePtrs, uint32_t* neighborIdxs) {
-    uint32_t numTriangles = 0;
+// Count the triangles u < v < w whose smallest node u is in [startNode, endNode)
+uint64_t countTriangles(uint32_t startNode, uint32_t endNode, uint32_t* nodePtrs, uint32_t* neighborIdxs) {
+    uint64_t numTriangles = 0;
 
-    for (uint32_t u = 0; u < numNodes; u++) {
+    for (uint32_t u = startNode; u < endNode; u++) {
         for (uint32_t i = nodePtrs[u]; i < nodePtrs[u + 1]; i++) {
             uint32_t v = neighborIdxs[i];
             if (v > u) {
@@ -53,11 +56,94 @@ uint32_t countTriangles( uint32_t numNodes, uint32_t* nodePtrs, uint32_t* neighb
     return numTriangles;
 }
 
+// Prefix sum of the estimated intersection work of the nodes of an oriented graph. Merging N(u) after v
+// with N(v) takes at most (degree of u after v) + (degree of v) steps, plus one step of per-node overhead.
+static uint64_t* estimateWorkPrefix(struct CSRGraph dagGraph) {
+    uint64_t* workPrefix = (uint64_t*) malloc((dagGraph.numNodes + 1)*sizeof(uint64_t));
+    workPrefix[0] = 0;
+    for(uint32_t u = 0; u < dagGraph.numNodes; ++u) {
+        uint64_t uDegree = dagGraph.nodePtrs[u + 1] - dagGraph.nodePtrs[u];
+        uint64_t work = 1 + uDegree*(uDegree - (uDegree > 0))/2;
+        for(uint32_t i = dagGraph.nodePtrs[u]; i < dagGraph.nodePtrs[u + 1]; ++i) {
+            uint32_t v = dagGraph.neighborIdxs[i];
+            work += dagGraph.nodePtrs[v + 1] - dagGraph.nodePtrs[v];
+        }
+        workPrefix[u + 1] = workPrefix[u] + work;
+    }
+    return workPrefix;
+}
+
+// Extract the part of the oriented graph a DPU needs to count the triangles of its nodes [startNode, endNode): the
+// lists of its own nodes, and those of the higher neighbors v it intersects them with, keeping only the neighbors of v
+// that are nodes of the subgraph (a triangle's third node is a neighbor of u). Nodes are renumbered in increasing
+// order, own nodes first, so that the lists stay sorted. localIdxs holds UINT32_MAX for every node on entry and exit
+static struct CSRGraph extractDPUSubgraph(struct CSRGraph dagGraph, uint32_t startNode, uint32_t endNode, uint32_t* localIdxs) {
+
+    struct CSRGraph subgraph;
+
+    // Own nodes, then the higher neighbors (all of them at or after endNode) in increasing order
+    uint32_t numOwnNodes = endNode - startNode;
+    uint32_t numOuterNodes = 0;
+    uint32_t* outerNodes = (uint32_t*) malloc((dagGraph.nodePtrs[endNode] - dagGraph.nodePtrs[startNode] + 1)*sizeof(uint32_t));
+    for(uint32_t u = startNode; u < endNode; ++u) {
+        localIdxs[u] = u - startNode;
+    }
+    for(uint32_t i = dagGraph.nodePtrs[startNode]; i < dagGraph.nodePtrs[endNode]; ++i) {
+        uint32_t v = dagGraph.neighborIdxs[i];
+        if(localIdxs[v] == UINT32_MAX) {
+            localIdxs[v] = 0;
+            outerNodes[numOuterNodes++] = v;
+        }
+    }
+    qsort(outerNodes, numOuterNodes, sizeof(uint32_t), compareNodeIdxs);
+    for(uint32_t i = 0; i < numOuterNodes; ++i) {
+        localIdxs[outerNodes[i]] = numOwnNodes + i;
+    }
+
+    // Count the kept neighbors of every node
+    subgraph.numNodes = numOwnNodes + numOuterNodes;
+    subgraph.nodePtrs = (uint32_t*) calloc(ROUND_UP_TO_MULTIPLE_OF_2(subgraph.numNodes + 1), sizeof(uint32_t));
+    for(uint32_t localIdx = 0; localIdx < subgraph.numNodes; ++localIdx) {
+        uint32_t u = (localIdx < numOwnNodes)?(startNode + localIdx):outerNodes[localIdx - numOwnNodes];
+        uint32_t degree = 0;
+        for(uint32_t i = dagGraph.nodePtrs[u]; i < dagGraph.nodePtrs[u + 1]; ++i) {
+            degree += (localIdxs[dagGraph.neighborIdxs[i]] != UINT32_MAX);
+        }
+        subgraph.nodePtrs[localIdx + 1] = subgraph.nodePtrs[localIdx] + degree;
+    }
+    subgraph.numEdges = subgraph.nodePtrs[subgraph.numNodes];
+
+    // Copy them renumbered (padded so that 8B transfers never read past the end)
+    subgraph.neighborIdxs = (uint32_t*) calloc(ROUND_UP_TO_MULTIPLE_OF_2(subgraph.numEdges + 1), sizeof(uint32_t));
+    for(uint32_t localIdx = 0; localIdx < subgraph.numNodes; ++localIdx) {
+        uint32_t u = (localIdx < numOwnNodes)?(startNode + localIdx):outerNodes[localIdx - numOwnNodes];
+        uint32_t* localNeighbors = &subgraph.neighborIdxs[subgraph.nodePtrs[localIdx]];
+        for(uint32_t i = dagGraph.nodePtrs[u]; i < dagGraph.nodePtrs[u + 1]; ++i) {
+            uint32_t localNeighbor = localIdxs[dagGraph.neighborIdxs[i]];
+            if(localNeighbor != UINT32_MAX) {
+                *localNeighbors++ = localNeighbor;
+            }
+        }
+    }
+
+    // Reset the renumbering
+    for(uint32_t u = startNode; u < endNode; ++u) {
+        localIdxs[u] = UINT32_MAX;
+    }
+    for(uint32_t i = 0; i < numOuterNodes; ++i) {
+        localIdxs[outerNodes[i]] = UINT32_MAX;
+    }
+    free(outerNodes);
+
+    return subgraph;
+
+}
+
 // Main of the Host Application
 int main(int argc, char** argv) {
     // Timer and profiling
     Timer timer;
-    float loadTime = 0.0f, dpuTime = 0.0f, hostTime = 0.0f, retrieveTime = 0.0f, cpuTime = 0.0f;
+    float loadTime = 0.0f, dpuTime = 0.0f, hostTime = 0.0f, retrieveTime = 0.0f, cpuTime = 0.0f, preprocessTime = 0.0f;
 
     // Process parameters
     
@@ -70,16 +156,36 @@ int main(int argc, char** argv) {
 
     PRINT_INFO(p.verbosity >= 1, "Graph has %d nodes and %d edges", csrGraph.numNodes, csrGraph.numEdges);
 
-    uint32_t* nodePtrs = csrGraph.nodePtrs;
-    uint32_t* neighborIdxs = csrGraph.neighborIdxs;
+    // Renumber nodes by increasing degree so that oriented edges point to higher-degree nodes
+    if(p.relabel) {
+        startTimer(&timer);
+        struct CSRGraph relabeledGraph = relabelByDegree(csrGraph);
+        freeCSRGraph(csrGraph);
+        csrGraph = relabeledGraph;
+        stopTimer(&timer);
+        preprocessTime += getElapsedTime(timer);
+    }
+
     uint32_t numNodes = csrGraph.numNodes;
 
+    // Orient edges from lower to higher node, sort the neighbor lists and drop duplicate edges for the DPU kernel
     startTimer(&timer);
-    uint32_t numTriangles = countTriangles(numNodes, nodePtrs, neighborIdxs);
+    struct CSRGraph dagGraph = orientCSRGraph(csrGraph);
+    uint32_t* dagNodePtrs = dagGraph.nodePtrs;
+    uint32_t* dagNeighborIdxs = dagGraph.neighborIdxs;
+    uint64_t* workPrefix = estimateWorkPrefix(dagGraph);
+    stopTimer(&timer);
+    preprocessTime += getElapsedTime(timer);
+    PRINT_INFO(p.verbosity >= 2, "Oriented graph has %d edges", dagGraph.numEdges);
+    PRINT_INFO(p.verbosity >= 1, "Host preprocessing time: %f ms", preprocessTime*1e3);
+
+    // The reference counts on the oriented graph too, so that duplicate input edges are not counted twice
+    startTimer(&timer);
+    uint64_t numTriangles = countTriangles(0, numNodes, dagNodePtrs, dagNeighborIdxs);
     stopTimer(&timer);
     cpuTime += getElapsedTime(timer);
     PRINT_INFO(p.verbosity >= 1, "CPU time: %f ms", cpuTime*1e3);
-    PRINT_INFO(p.verbosity >= 1, "CPU: Graph has %d triangles", numTriangles);
+    PRINT_INFO(p.verbosity >= 1, "CPU: Graph has %lu triangles", (unsigned long)numTriangles);
 
     // Allocate DPUs and load binary
     struct dpu_set_t dpu_set, dpu;
@@ -89,87 +195,99 @@ int main(int argc, char** argv) {
     DPU_ASSERT(dpu_get_nr_dpus(dpu_set, &numDPUs));
     PRINT_INFO(p.verbosity >= 2, "Allocated %d DPU(s)", numDPUs)
 
-    // Partition data structure across DPUs
-    uint32_t numNodesPerDPU = ROUND_UP_TO_MULTIPLE_OF_64((numNodes - 1)/numDPUs + 1);
-    PRINT_INFO(p.verbosity >= 2, "Assigning %u nodes per DPU", numNodesPerDPU);
+    // Partition data structure across DPUs, balancing either the estimated intersection work or the node count
+    uint32_t dpuNodeBounds[numDPUs + 1];
+    if(p.balanced) {
+        partitionByWork(workPrefix, 0, numNodes, numDPUs, 1, dpuNodeBounds);
+    } else {
+        partitionEvenly(0, numNodes, numDPUs, 64, dpuNodeBounds);
+    }
+    // Find every DPU's CSR graph partition: its own nodes and the higher neighbors it intersects them with
+    struct CSRGraph dpuGraphs[numDPUs];
+    uint32_t maxDPUGraphNodes = 0, maxDPUGraphEdges = 0;
+    uint64_t* cpuTriangleCounts = calloc(numDPUs, sizeof(uint64_t));
+    uint32_t* localIdxs = (uint32_t*) malloc(numNodes*sizeof(uint32_t));
+    memset(localIdxs, 0xFF, numNodes*sizeof(uint32_t));
+    unsigned int dpuIdx;
+    for(dpuIdx = 0; dpuIdx < numDPUs; ++dpuIdx) {
+        uint32_t dpuStartNodeIdx = dpuNodeBounds[dpuIdx];
+        uint32_t dpuNumNodes = dpuNodeBounds[dpuIdx + 1] - dpuStartNodeIdx;
+        memset(&dpuGraphs[dpuIdx], 0, sizeof(struct CSRGraph));
+        if(dpuNumNodes > 0) {
+            dpuGraphs[dpuIdx] = extractDPUSubgraph(dagGraph, dpuStartNodeIdx, dpuStartNodeIdx + dpuNumNodes, localIdxs);
+            maxDPUGraphNodes = (dpuGraphs[dpuIdx].numNodes > maxDPUGraphNodes)?dpuGraphs[dpuIdx].numNodes:maxDPUGraphNodes;
+            maxDPUGraphEdges = (dpuGraphs[dpuIdx].numEdges > maxDPUGraphEdges)?dpuGraphs[dpuIdx].numEdges:maxDPUGraphEdges;
+        }
+    }
+
+    // Allocate MRAM at the same offsets on all DPUs, sized for the largest subgraph, so that the subgraphs are sent with
+    // parallel transfers (exits if it does not fit)
+    struct mram_heap_allocator_t allocator;
+    init_allocator(&allocator);
+    uint32_t dpuParams_m = mram_heap_alloc(&allocator, sizeof(struct DPUParams));
+    uint32_t dpuNodePtrs_m = mram_heap_alloc(&allocator, (maxDPUGraphNodes + 1)*sizeof(uint32_t));
+    uint32_t dpuNeighborIdxs_m = mram_heap_alloc(&allocator, (uint64_t)maxDPUGraphEdges*sizeof(uint32_t));
+    PRINT_INFO(p.verbosity >= 2, "Total memory allocated is %lu bytes", (unsigned long)allocator.totalAllocated);
+
+    // Set up DPU parameters
     struct DPUParams dpuParams[numDPUs];
-    uint32_t dpuParams_m[numDPUs];
-    uint32_t* cpuTriangleCounts = malloc(sizeof(uint32_t)*numDPUs);
-    unsigned int dpuIdx = 0;
-    DPU_FOREACH (dpu_set, dpu) {
+    uint8_t* dpuNodePtrs_h[numDPUs];
+    uint8_t* dpuNeighborIdxs_h[numDPUs];
+    uint8_t* dpuParams_h[numDPUs];
+    uint64_t dpuNodePtrsSizes[numDPUs], dpuNeighborIdxsSizes[numDPUs], dpuParamsSizes[numDPUs];
+    for(dpuIdx = 0; dpuIdx < numDPUs; ++dpuIdx) {
         PRINT_INFO(p.verbosity >= 2, "=======================================");
-        // Allocate parameters
-        struct mram_heap_allocator_t allocator;
-        init_allocator(&allocator);
-        dpuParams_m[dpuIdx] = mram_heap_alloc(&allocator, sizeof(struct DPUParams));
-
-        // Find DPU's nodes
-        // uint32_t dpuStartNodeIdx = dpuIdx*numNodesPerDPU;
-        uint32_t dpuStartNodeIdx = 0;
-        uint32_t dpuNumNodes;
-        if(dpuStartNodeIdx > numNodes) {
-            dpuNumNodes = 0;
-        } else if(dpuStartNodeIdx + numNodesPerDPU > numNodes) {
-            dpuNumNodes = numNodes - dpuStartNodeIdx;
-        } else {
-            dpuNumNodes = numNodesPerDPU;
-        }
-        
+        uint32_t dpuStartNodeIdx = dpuNodeBounds[dpuIdx];
+        uint32_t dpuNumNodes = dpuNodeBounds[dpuIdx + 1] - dpuStartNodeIdx;
+
         PRINT_INFO(p.verbosity >= 2, "dpuStartNodeIdx: %u ", dpuStartNodeIdx);//morteza log
+        memset(&dpuParams[dpuIdx], 0, sizeof(struct DPUParams));
         dpuParams[dpuIdx].dpuNumNodes = dpuNumNodes;
         PRINT_INFO(p.verbosity >= 2, "DPU %u:", dpuIdx);
         PRINT_INFO(p.verbosity >= 2, "Receives %u nodes", dpuNumNodes);
 
-        // Partition edges and copy data
         if(dpuNumNodes > 0) {
-
-            // Find DPU's CSR graph partition
-            uint32_t* dpuNodePtrs_h = &nodePtrs[dpuStartNodeIdx];
-            uint32_t dpuNodePtrsOffset = dpuNodePtrs_h[0];
-            uint32_t* dpuNeighborIdxs_h = neighborIdxs + dpuNodePtrsOffset;
-            uint32_t dpuNumNeighbors = dpuNodePtrs_h[dpuNumNodes] - dpuNodePtrsOffset;
-            uint32_t dpuTriangleCount = 0;
-            PRINT_INFO(p.verbosity >= 2, "dpuNodePtrsOffset: %u ", dpuNodePtrsOffset);//morteza log
-            PRINT_INFO(p.verbosity >= 2, "dpuNumNeighbors: %u ", dpuNumNeighbors);//morteza log
-
-            // Allocate MRAM
-            uint32_t dpuNodePtrs_m = mram_heap_alloc(&allocator, (dpuNumNodes + 1)*sizeof(uint32_t));
-            uint32_t dpuNeighborIdxs_m = mram_heap_alloc(&allocator, dpuNumNeighbors*sizeof(uint32_t));
-            uint32_t dpuTriangleCount_m = mram_heap_alloc(&allocator, sizeof(uint32_t));
-            PRINT_INFO(p.verbosity >= 2, "Total memory allocated is %d bytes", allocator.totalAllocated);
-
-            // Set up DPU parameters
+            PRINT_INFO(p.verbosity >= 2, "Receives a subgraph of %u nodes and %u edges", dpuGraphs[dpuIdx].numNodes, dpuGraphs[dpuIdx].numEdges);
             dpuParams[dpuIdx].numNodes = numNodes;
             dpuParams[dpuIdx].dpuStartNodeIdx = dpuStartNodeIdx;
-            dpuParams[dpuIdx].dpuNodePtrsOffset = dpuNodePtrsOffset;
+            dpuParams[dpuIdx].dpuNodePtrsOffset = 0;
             dpuParams[dpuIdx].dpuNodePtrs_m = dpuNodePtrs_m;
             dpuParams[dpuIdx].dpuNeighborIdxs_m = dpuNeighborIdxs_m;
-            dpuParams[dpuIdx].dpuTriangleCount_m = dpuTriangleCount_m;
 
-            // Send data to DPU
-            PRINT_INFO(p.verbosity >= 2, "Copying data to DPU");
-            startTimer(&timer);
-            copyToDPU(dpu, (uint8_t*)dpuNodePtrs_h, dpuNodePtrs_m, (dpuNumNodes + 1)*sizeof(uint32_t));
-            copyToDPU(dpu, (uint8_t*)dpuNeighborIdxs_h, dpuNeighborIdxs_m, dpuNumNeighbors*sizeof(uint32_t));
-            copyToDPU(dpu, (uint8_t*)&dpuTriangleCount, dpuTriangleCount_m, sizeof(uint32_t));
-            stopTimer(&timer);
-            loadTime += getElapsedTime(timer);
+            // Split the DPU's nodes across tasklets in the same way
+            uint32_t taskletNodeBounds[NR_TASKLETS + 1];
+            if(p.balanced) {
+                partitionByWork(workPrefix, dpuStartNodeIdx, dpuStartNodeIdx + dpuNumNodes, NR_TASKLETS, 1, taskletNodeBounds);
+            } else {
+                partitionEvenly(dpuStartNodeIdx, dpuStartNodeIdx + dpuNumNodes, NR_TASKLETS, 1, taskletNodeBounds);
+            }
+            for(uint32_t t = 0; t <= NR_TASKLETS; ++t) {
+                dpuParams[dpuIdx].taskletNodesStart[t] = taskletNodeBounds[t] - dpuStartNodeIdx;
+            }
 
             //cpu check
-            cpuTriangleCounts[dpuIdx] = countTriangles(dpuNumNodes, dpuNodePtrs_h, dpuNeighborIdxs_h);
-            PRINT_INFO(p.verbosity >= 2, "numTrianglesDPU on host: %u ", cpuTriangleCounts[dpuIdx]);//morteza log
-
+            cpuTriangleCounts[dpuIdx] = countTriangles(dpuStartNodeIdx, dpuStartNodeIdx + dpuNumNodes, dagNodePtrs, dagNeighborIdxs);
+            PRINT_INFO(p.verbosity >= 2, "numTrianglesDPU on host: %lu ", (unsigned long)cpuTriangleCounts[dpuIdx]);//morteza log
         }
 
-        // Send parameters to DPU
-        PRINT_INFO(p.verbosity >= 2, "Copying parameters to DPU");
-        startTimer(&timer);
-        copyToDPU(dpu, (uint8_t*)&dpuParams[dpuIdx], dpuParams_m[dpuIdx], sizeof(struct DPUParams));
-        stopTimer(&timer);
-        loadTime += getElapsedTime(timer);
-
-        ++dpuIdx;
+        dpuNodePtrs_h[dpuIdx] = (uint8_t*)dpuGraphs[dpuIdx].nodePtrs;
+        dpuNodePtrsSizes[dpuIdx] = (dpuGraphs[dpuIdx].numNodes + 1)*sizeof(uint32_t);
+        dpuNeighborIdxs_h[dpuIdx] = (uint8_t*)dpuGraphs[dpuIdx].neighborIdxs;
+        dpuNeighborIdxsSizes[dpuIdx] = (uint64_t)dpuGraphs[dpuIdx].numEdges*sizeof(uint32_t);
+        dpuParams_h[dpuIdx] = (uint8_t*)&dpuParams[dpuIdx];
+        dpuParamsSizes[dpuIdx] = sizeof(struct DPUParams);
+    }
 
+    // Send data and parameters to DPUs, each subgraph being in its own buffer
+    PRINT_INFO(p.verbosity >= 2, "Copying data to DPUs");
+    startTimer(&timer);
+    pushSlicesToDPUs(dpu_set, numDPUs, dpuNodePtrs_m, dpuNodePtrs_h, dpuNodePtrsSizes, NULL);
+    pushSlicesToDPUs(dpu_set, numDPUs, dpuNeighborIdxs_m, dpuNeighborIdxs_h, dpuNeighborIdxsSizes, NULL);
+    pushSlicesToDPUs(dpu_set, numDPUs, dpuParams_m, dpuParams_h, dpuParamsSizes, (uint8_t*)&dpuParams[numDPUs]);
+    stopTimer(&timer);
+    loadTime += getElapsedTime(timer);
+    for(dpuIdx = 0; dpuIdx < numDPUs; ++dpuIdx) {
+        freeCSRGraph(dpuGraphs[dpuIdx]);
     }
 
     PRINT_INFO(p.verbosity >= 2, "------------------------------------------------");
@@ -191,23 +309,36 @@ int main(int argc, char** argv) {
     PRINT_INFO(p.verbosity >= 1, "DPU Kernel Time: %f ms", dpuTime*1e3);
     // PRINT_INFO(p.verbosity >= 1, "Inter-DPU Time: %f ms", hostTime*1e3);
 
-    // Copy back node levels
+    // Copy back the results of all DPUs with one parallel transfer
     PRINT_INFO(p.verbosity >= 2, "Copying back the result");
     startTimer(&timer);
-    dpuIdx = 0;
+    struct DPUResults dpuResults[numDPUs];
+    DPU_FOREACH (dpu_set, dpu, dpuIdx) {
+        DPU_ASSERT(dpu_prepare_xfer(dpu, &dpuResults[dpuIdx]));
+    }
+    DPU_ASSERT(dpu_push_xfer(dpu_set, DPU_XFER_FROM_DPU, "DPU_RESULTS", 0, sizeof(struct DPUResults), DPU_XFER_DEFAULT));
+    uint64_t dpuTriangleCounts[numDPUs];
+    uint64_t dpuTotalTriangles = 0;
+    for(dpuIdx = 0; dpuIdx < numDPUs; ++dpuIdx) {
+        dpuTriangleCounts[dpuIdx] = dpuResults[dpuIdx].triangleCount;
+        PRINT_INFO(p.verbosity >= 2, "DPU %u has %u nodes and counted %lu triangles", dpuIdx, dpuParams[dpuIdx].dpuNumNodes, (unsigned long)dpuTriangleCounts[dpuIdx]);
+        dpuTotalTriangles += dpuTriangleCounts[dpuIdx];
+    }
 
-    uint32_t dpuTriangleCounts[numDPUs];
-    DPU_FOREACH (dpu_set, dpu) {
-        uint32_t dpuNumNodes = dpuParams[dpuIdx].dpuNumNodes;
-        PRINT_INFO(p.verbosity >= 2, "DPU %u has %u nodes", dpuIdx, dpuNumNodes);
-        if(dpuNumNodes > 0) {
-            // uint32_t dpuStartNodeIdx = dpuIdx*numNodesPerDPU;
-            uint32_t dpuTriangleCount = 0;
-            copyFromDPU(dpu, dpuParams[dpuIdx].dpuTriangleCount_m, (uint8_t*) &(dpuTriangleCounts[dpuIdx]), sizeof(uint32_t));
-            PRINT_INFO(p.verbosity >= 2, "DPU %u counted %u triangles", dpuIdx, dpuTriangleCounts[dpuIdx]);
-        }
-        ++dpuIdx;
+    // Compare the estimated and the actual work of every DPU
+    uint64_t maxEstimatedWork = 0, totalEstimatedWork = 0, maxActualWork = 0, totalActualWork = 0;
+    for(dpuIdx = 0; dpuIdx < numDPUs; ++dpuIdx) {
+        uint64_t estimatedWork = workPrefix[dpuNodeBounds[dpuIdx + 1]] - workPrefix[dpuNodeBounds[dpuIdx]];
+        uint64_t actualWork = dpuResults[dpuIdx].intersectionSteps;
+        PRINT_INFO(p.verbosity >= 2, "DPU %u: estimated work %lu, actual work %lu steps in %lu cycles", dpuIdx, (unsigned long)estimatedWork, (unsigned long)actualWork, (unsigned long)dpuResults[dpuIdx].cycles);
+        maxEstimatedWork = (estimatedWork > maxEstimatedWork)?estimatedWork:maxEstimatedWork;
+        maxActualWork = (actualWork > maxActualWork)?actualWork:maxActualWork;
+        totalEstimatedWork += estimatedWork;
+        totalActualWork += actualWork;
     }
+    PRINT_INFO(p.verbosity >= 1, "DPU work imbalance (max/average): estimated %f, actual %f",
+            (totalEstimatedWork > 0)?(double)maxEstimatedWork*numDPUs/totalEstimatedWork:1.0,
+            (totalActualWork > 0)?(double)maxActualWork*numDPUs/totalActualWork:1.0);
 
     //verify the dpu results
     PRINT_INFO(p.verbosity >= 2, "<<<<<<<<<<<<<<<Verifying the results>>>>>>>>>>>>>>>");
@@ -216,7 +347,7 @@ int main(int argc, char** argv) {
         if(dpuTriangleCounts[i] == cpuTriangleCounts[i]) {
             PRINT_INFO(p.verbosity >= 2, "DPU %u and CPU agree on the number of triangles", i);
         } else {
-            PRINT_INFO(p.verbosity >= 2, "DPU %u and CPU disagree on the number of triangles, DPU = %u, CPU=%u", i, dpuTriangleCounts[i], cpuTriangleCounts[i]);
+            PRINT_INFO(p.verbosity >= 2, "DPU %u and CPU disagree on the number of triangles, DPU = %lu, CPU=%lu", i, (unsigned long)dpuTriangleCounts[i], (unsigned long)cpuTriangleCounts[i]);
             dpusNotMatching++;
         }
     }
@@ -225,6 +356,7 @@ int main(int argc, char** argv) {
     } else{
         PRINT_INFO(p.verbosity >= 1, "There are %u DPUs that disagree on the number of triangles", dpusNotMatching);
     }
+    PRINT_INFO(p.verbosity >= 1, "DPU: Graph has %lu triangles", (unsigned long)dpuTotalTriangles);
 
     stopTimer(&timer);
     retrieveTime += getElapsedTime(timer);
@@ -244,7 +376,10 @@ int main(int argc, char** argv) {
 
     // Deallocate data structures
     freeCSRGraph(csrGraph);
+    freeCSRGraph(dagGraph);
+    free(workPrefix);
     free(cpuTriangleCounts);
+    free(localIdxs);
 
     return 0;
 
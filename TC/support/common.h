@@ -5,6 +5,19 @@
 #define ROUND_UP_TO_MULTIPLE_OF_8(x)    ((((x) + 7)/8)*8)
 #define ROUND_UP_TO_MULTIPLE_OF_64(x)   ((((x) + 63)/64)*64)
 
+// The CPU and GPU baselines include this header without a tasklet count
+#ifndef NR_TASKLETS
+#define NR_TASKLETS 16
+#endif
+
+// Number of neighbor indexes (even) and node pointers (even, at least 4) fetched per MRAM read by the DPU kernel
+#ifndef NEIGHBOR_BLOCK_SIZE
+#define NEIGHBOR_BLOCK_SIZE 64
+#endif
+#ifndef NODE_PTR_BLOCK_SIZE
+#define NODE_PTR_BLOCK_SIZE 32
+#endif
+
 #define setBit(val, idx) (val) |= (1 << (idx))
 #define isSet(val, idx)  ((val) & (1 << (idx)))
 
@@ -12,16 +25,22 @@ struct DPUParams {
     uint32_t dpuNumNodes; /* The number of nodes assigned to this DPU */
     uint32_t numNodes; /* Total number of nodes in the graph  */
     uint32_t dpuStartNodeIdx; /* The index of the first node assigned to this DPU  */
-    uint32_t dpuNodePtrsOffset; /* Offset of the node pointers */
+    uint32_t dpuNodePtrsOffset; /* Offset of the node pointers (0: the DPU holds its own subgraph, own nodes first) */
     // uint32_t level; /* The current BFS level */
     uint32_t dpuNodePtrs_m;
     uint32_t dpuNeighborIdxs_m;
-    uint32_t dpuTriangleCount_m;
+    uint32_t taskletNodesStart[NR_TASKLETS + 1]; /* First node of each tasklet relative to dpuStartNodeIdx, and dpuNumNodes */
     // uint32_t dpuNodeLevel_m;
     // uint32_t dpuVisited_m;
     // uint32_t dpuCurrentFrontier_m;
     // uint32_t dpuNextFrontier_m;
 };
 
+struct DPUResults {
+    uint64_t triangleCount;
+    uint64_t intersectionSteps; /* Merge steps performed, comparable to the host's work estimate */
+    uint64_t cycles;
+};
+
 #endif
 
@@ -10,6 +10,8 @@ static void usage() {
             "\n"
             "\nBenchmark-specific options:"
             "\n    -f <F>    input matrix file name (default=data/roadNet-CA.txt)"
+            "\n    -r <R>    relabel nodes by increasing degree: 0 or 1 (default=1)"
+            "\n    -b <B>    partitioning: 0 = equal node counts, 1 = balanced estimated work (default=1)"
             "\n"
             "\nGeneral options:"
             "\n    -v <V>    verbosity"
@@ -19,17 +21,23 @@ static void usage() {
 
 typedef struct Params {
   const char* fileName;
+  unsigned int relabel;
+  unsigned int balanced;
   unsigned int verbosity;
 } Params;
 
 static struct Params input_params(int argc, char **argv) {
     struct Params p;
     p.fileName      = "data/roadNet-CA.txt";
+    p.relabel       = 1;
+    p.balanced      = 1;
     p.verbosity     = 1;
     int opt;
-    while((opt = getopt(argc, argv, "f:v:h")) >= 0) {
+    while((opt = getopt(argc, argv, "f:r:b:v:h")) >= 0) {
         switch(opt) {
             case 'f': p.fileName    = optarg;       break;
+            case 'r': p.relabel     = atoi(optarg); break;
+            case 'b': p.balanced    = atoi(optarg); break;
             case 'v': p.verbosity   = atoi(optarg); break;
             case 'h': usage(); exit(0);
             default:
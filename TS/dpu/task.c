@@ -4,12 +4,14 @@
  */
 
 #include <stdint.h>
+#include <stdbool.h>
 #include <stdio.h>
 #include <defs.h>
 #include <mram.h>
 #include <alloc.h>
 #include <mram.h>
 #include <barrier.h>
+#include <mutex_pool.h>
 #include "common.h"
 
 #define DOTPIP BLOCK_SIZE / sizeof(DTYPE)
@@ -38,9 +40,15 @@ static void dot_product(DTYPE *vectorA, DTYPE *vectorA_aux, DTYPE *vectorB, DTYP
 
 BARRIER_INIT(my_barrier, NR_TASKLETS);
 
+// Matrix profile: the profile is locked MP_SEGMENT windows at a time
+#define NR_PROFILE_LOCKS 8
+MUTEX_POOL_INIT(profile_mutex_pool, NR_PROFILE_LOCKS);
+
 extern int main_kernel1(void);
+extern int main_kernel2(void);
+extern int main_kernel3(void);
 
-int(*kernels[nr_kernels])(void) = {main_kernel1};
+int(*kernels[nr_kernels])(void) = {main_kernel1, main_kernel2, main_kernel3};
 
 int main(void){
 	// Kernel
@@ -64,13 +72,14 @@ int main_kernel1() {
 	DTYPE query_mean       = DPU_INPUT_ARGUMENTS.query_mean;
 	DTYPE query_std        = DPU_INPUT_ARGUMENTS.query_std;
 	uint32_t slice_per_dpu = DPU_INPUT_ARGUMENTS.slice_per_dpu;
+	uint32_t windows       = DPU_INPUT_ARGUMENTS.windows;
 
 	// Boundaries for current tasklet
 	uint32_t myStartElem = tasklet_id  * (slice_per_dpu / (NR_TASKLETS));
-	uint32_t myEndElem   = myStartElem + (slice_per_dpu / (NR_TASKLETS)) - 1;
+	uint32_t myEndElem   = myStartElem + (slice_per_dpu / (NR_TASKLETS));
 
 	// Check time series limit
-	if(myEndElem > slice_per_dpu - query_length) myEndElem = slice_per_dpu - query_length;
+	if(myEndElem > windows) myEndElem = windows;
 
 	// Starting address of the current processing block in MRAM
 	uint32_t mem_offset = (uint32_t) DPU_MRAM_HEAP_POINTER;
@@ -134,7 +143,7 @@ int main_kernel1() {
 		current_mram_block_addr_TSMean  += BLOCK_SIZE;
 		current_mram_block_addr_TSSigma += BLOCK_SIZE;
 
-		for (uint32_t k = 0; k < (BLOCK_SIZE / sizeof(DTYPE)); k++)
+		for (uint32_t k = 0; k < (BLOCK_SIZE / sizeof(DTYPE)) && i + k < myEndElem; k++)
 		{
 			distance = 2 * ((DTYPE) query_length - (cache_dotprods[k] - (DTYPE) query_length * cache_TSMean[k]
 						* query_mean) / (cache_TSSigma[k] * query_std));
@@ -153,3 +162,268 @@ int main_kernel1() {
 
 	return 0;
 }
+
+// Read the MP_SEGMENT elements of an MRAM array from element first on, which need not be 8-byte aligned.
+// Returns the WRAM address of element first
+static DTYPE *read_segment(uint32_t array_m, uint32_t first, DTYPE *cache) {
+	uint32_t addr = array_m + first * sizeof(DTYPE);
+	mram_read((__mram_ptr void const *) (addr & ~7), cache, (MP_SEGMENT + 2) * sizeof(DTYPE));
+	return cache + (addr & 7) / sizeof(DTYPE);
+}
+
+// Lock the profile entries [first, first + count), count <= MP_SEGMENT, which span at most two lock tiles.
+// The locks are taken in increasing order, so tasklets locking overlapping ranges cannot deadlock
+static void lock_profile(uint32_t first, uint32_t count, uint32_t *locks) {
+	locks[0] = (first / MP_SEGMENT) % NR_PROFILE_LOCKS;
+	locks[1] = ((first + count - 1) / MP_SEGMENT) % NR_PROFILE_LOCKS;
+	if (locks[0] > locks[1]) {
+		uint32_t tmp = locks[0];
+		locks[0] = locks[1];
+		locks[1] = tmp;
+	}
+	mutex_pool_lock(&profile_mutex_pool, locks[0]);
+	if (locks[1] != locks[0])
+		mutex_pool_lock(&profile_mutex_pool, locks[1]);
+}
+
+static void unlock_profile(uint32_t *locks) {
+	if (locks[1] != locks[0])
+		mutex_pool_unlock(&profile_mutex_pool, locks[1]);
+	mutex_pool_unlock(&profile_mutex_pool, locks[0]);
+}
+
+// Merge count distances into the profile entries from first on; distance c is to window match_first + c
+static void update_profile(uint32_t profile_m, uint32_t first, uint32_t count, DTYPE *distances, uint32_t match_first,
+		mp_entry_t *cache_profile) {
+	uint32_t locks[2];
+	__mram_ptr void *profile_addr = (__mram_ptr void *) (profile_m + first * sizeof(mp_entry_t));
+
+	lock_profile(first, count, locks);
+	mram_read(profile_addr, cache_profile, count * sizeof(mp_entry_t));
+	bool updated = false;
+	for (uint32_t c = 0; c < count; c++)
+	{
+		if (distances[c] < cache_profile[c].value)
+		{
+			cache_profile[c].value = distances[c];
+			cache_profile[c].index = match_first + c;
+			updated = true;
+		}
+	}
+	if (updated)
+		mram_write(cache_profile, profile_addr, count * sizeof(mp_entry_t));
+	unlock_profile(locks);
+}
+
+// main_kernel2
+// Matrix profile of the series (SCRIMP): every diagonal d > exclusion_zone of the distance matrix is walked once,
+// with the dot product of windows i and i + d updated in O(1) from that of windows i - 1 and i + d - 1. Each
+// distance updates the profile entries of both windows. The diagonals are dealt in a serpentine order to the
+// tasklets of all DPUs, and every DPU keeps a partial profile of the whole series in MRAM for the host to merge
+int main_kernel2() {
+	unsigned int tasklet_id = me();
+	if(tasklet_id == 0){
+		mem_reset(); // Reset the heap
+	}
+	// Barrier
+	barrier_wait(&my_barrier);
+
+	// Input arguments
+	uint32_t ts_length      = DPU_INPUT_ARGUMENTS.ts_length;
+	uint32_t window_length  = DPU_INPUT_ARGUMENTS.query_length;
+	uint32_t profile_length = DPU_INPUT_ARGUMENTS.windows;
+	uint32_t exclusion_zone = DPU_INPUT_ARGUMENTS.exclusion_zone;
+	uint32_t nr_workers     = DPU_INPUT_ARGUMENTS.nr_dpus * NR_TASKLETS;
+	uint32_t worker         = DPU_INPUT_ARGUMENTS.dpu_id * NR_TASKLETS + tasklet_id;
+
+	// MRAM layout: series, window means, window standard deviations, partial profile
+	uint32_t ts_m      = (uint32_t) DPU_MRAM_HEAP_POINTER;
+	uint32_t mean_m    = ts_m + MP_PADDED_LENGTH(ts_length) * sizeof(DTYPE);
+	uint32_t sigma_m   = mean_m + MP_PADDED_LENGTH(profile_length) * sizeof(DTYPE);
+	uint32_t profile_m = sigma_m + MP_PADDED_LENGTH(profile_length) * sizeof(DTYPE);
+
+	// Initialize local caches to store the MRAM blocks
+	DTYPE *cache_out_i   = (DTYPE *) mem_alloc((MP_SEGMENT + 2) * sizeof(DTYPE));
+	DTYPE *cache_in_i    = (DTYPE *) mem_alloc((MP_SEGMENT + 2) * sizeof(DTYPE));
+	DTYPE *cache_out_j   = (DTYPE *) mem_alloc((MP_SEGMENT + 2) * sizeof(DTYPE));
+	DTYPE *cache_in_j    = (DTYPE *) mem_alloc((MP_SEGMENT + 2) * sizeof(DTYPE));
+	DTYPE *cache_mean_i  = (DTYPE *) mem_alloc((MP_SEGMENT + 2) * sizeof(DTYPE));
+	DTYPE *cache_sigma_i = (DTYPE *) mem_alloc((MP_SEGMENT + 2) * sizeof(DTYPE));
+	DTYPE *cache_mean_j  = (DTYPE *) mem_alloc((MP_SEGMENT + 2) * sizeof(DTYPE));
+	DTYPE *cache_sigma_j = (DTYPE *) mem_alloc((MP_SEGMENT + 2) * sizeof(DTYPE));
+	DTYPE *cache_dist    = (DTYPE *) mem_alloc(MP_SEGMENT * sizeof(DTYPE));
+	mp_entry_t *cache_profile = (mp_entry_t *) mem_alloc(MP_SEGMENT * sizeof(mp_entry_t));
+
+	// Initialize the partial profile
+	for (uint32_t c = 0; c < MP_SEGMENT; c++)
+	{
+		cache_profile[c].value = DTYPE_MAX;
+		cache_profile[c].index = 0;
+	}
+	for (uint32_t first = tasklet_id * MP_SEGMENT; first < profile_length; first += NR_TASKLETS * MP_SEGMENT)
+		mram_write(cache_profile, (__mram_ptr void *) (profile_m + first * sizeof(mp_entry_t)), MP_SEGMENT * sizeof(mp_entry_t));
+	barrier_wait(&my_barrier);
+
+	uint32_t nr_diagonals = (profile_length > exclusion_zone + 1) ? profile_length - exclusion_zone - 1 : 0;
+	for (uint32_t round = 0; ; round++)
+	{
+		uint32_t diagonal_idx = round * nr_workers + ((round & 1) ? nr_workers - 1 - worker : worker);
+		if (diagonal_idx >= nr_diagonals)
+			break;
+		uint32_t diag = exclusion_zone + 1 + diagonal_idx;
+		uint32_t length = profile_length - diag;
+
+		// Dot product of the first windows of the diagonal, 0 and diag
+		DTYPE qt = 0;
+		for (uint32_t first = 0; first < window_length; first += MP_SEGMENT)
+		{
+			DTYPE *ts_i = read_segment(ts_m, first, cache_in_i);
+			DTYPE *ts_j = read_segment(ts_m, first + diag, cache_in_j);
+			for (uint32_t c = 0; c < MP_SEGMENT && first + c < window_length; c++)
+				qt += ts_i[c] * ts_j[c];
+		}
+
+		// Walk the diagonal a segment at a time: distances of windows i and j = i + diag, then slide both windows
+		for (uint32_t i = 0; i < length; i += MP_SEGMENT)
+		{
+			uint32_t j = i + diag;
+			uint32_t count = (length - i < MP_SEGMENT) ? length - i : MP_SEGMENT;
+			DTYPE *out_i   = read_segment(ts_m, i, cache_out_i);
+			DTYPE *in_i    = read_segment(ts_m, i + window_length, cache_in_i);
+			DTYPE *out_j   = read_segment(ts_m, j, cache_out_j);
+			DTYPE *in_j    = read_segment(ts_m, j + window_length, cache_in_j);
+			DTYPE *mean_i  = read_segment(mean_m, i, cache_mean_i);
+			DTYPE *sigma_i = read_segment(sigma_m, i, cache_sigma_i);
+			DTYPE *mean_j  = read_segment(mean_m, j, cache_mean_j);
+			DTYPE *sigma_j = read_segment(sigma_m, j, cache_sigma_j);
+
+			for (uint32_t c = 0; c < count; c++)
+			{
+				cache_dist[c] = 2 * ((DTYPE) window_length - (qt - (DTYPE) window_length * mean_i[c]
+							* mean_j[c]) / (sigma_i[c] * sigma_j[c]));
+				qt += in_i[c] * in_j[c] - out_i[c] * out_j[c];
+			}
+
+			update_profile(profile_m, i, count, cache_dist, j, cache_profile);
+			update_profile(profile_m, j, count, cache_dist, i, cache_profile);
+		}
+	}
+
+	return 0;
+}
+
+// main_kernel3
+// Distance profile of the query with sliding dot products. The dot product of window i + 1 follows from that of
+// window i as QT[i + 1] = QT[i] + sum_k T[i + k] * D[k], where D[k] = Q[k - 1] - Q[k] (Q is 0 outside [0, m)),
+// i.e. QT[i] - T[i] * Q[0] + T[i + m] * Q[m - 1] plus the terms of the inner samples where the query changes.
+// That sum slides with the second difference of the query in the same way. The host sends the nonzero terms of the
+// sparser of the two differences, so after the first window every window costs O(# of terms) instead of O(m)
+int main_kernel3() {
+	unsigned int tasklet_id = me();
+	if(tasklet_id == 0){
+		mem_reset(); // Reset the heap
+	}
+	// Barrier
+	barrier_wait(&my_barrier);
+
+	// Input arguments
+	uint32_t query_length  = DPU_INPUT_ARGUMENTS.query_length;
+	DTYPE query_mean       = DPU_INPUT_ARGUMENTS.query_mean;
+	DTYPE query_std        = DPU_INPUT_ARGUMENTS.query_std;
+	uint32_t slice_per_dpu = DPU_INPUT_ARGUMENTS.slice_per_dpu;
+	uint32_t windows       = DPU_INPUT_ARGUMENTS.windows;
+	uint32_t query_order   = DPU_INPUT_ARGUMENTS.query_order;
+	uint32_t query_terms   = DPU_INPUT_ARGUMENTS.query_terms;
+
+	// Boundaries for current tasklet
+	uint32_t myStartElem = tasklet_id  * (slice_per_dpu / (NR_TASKLETS));
+	uint32_t myEndElem   = myStartElem + (slice_per_dpu / (NR_TASKLETS));
+
+	// Check time series limit
+	if(myEndElem > windows) myEndElem = windows;
+
+	// MRAM layout: query, time series slice, means, standard deviations, as in main_kernel1, then the query terms
+	uint32_t query_m = (uint32_t) DPU_MRAM_HEAP_POINTER;
+	uint32_t ts_m    = query_m + query_length * sizeof(DTYPE);
+	uint32_t mean_m  = ts_m + (slice_per_dpu + query_length) * sizeof(DTYPE);
+	uint32_t sigma_m = mean_m + (slice_per_dpu + query_length) * sizeof(DTYPE);
+	uint32_t terms_m = sigma_m + (slice_per_dpu + query_length) * sizeof(DTYPE);
+
+	// Initialize local caches to store the MRAM blocks
+	DTYPE *cache_TS      = (DTYPE *) mem_alloc((MP_SEGMENT + 2) * sizeof(DTYPE));
+	DTYPE *cache_query   = (DTYPE *) mem_alloc((MP_SEGMENT + 2) * sizeof(DTYPE));
+	DTYPE *cache_TSMean  = (DTYPE *) mem_alloc((MP_SEGMENT + 2) * sizeof(DTYPE));
+	DTYPE *cache_TSSigma = (DTYPE *) mem_alloc((MP_SEGMENT + 2) * sizeof(DTYPE));
+	DTYPE *cache_slides  = (DTYPE *) mem_alloc(MP_SEGMENT * sizeof(DTYPE));
+	query_term_t *cache_terms = (query_term_t *) mem_alloc(MP_SEGMENT * sizeof(query_term_t));
+
+	// Create result structure pointer
+	dpu_result_t *result = &DPU_RESULTS[tasklet_id];
+
+	// Auxiliary variables
+	DTYPE distance;
+	DTYPE min_distance = DTYPE_MAX;
+	uint32_t min_index = 0;
+
+	// Dot products of the first query_order windows, then their differences: sums[0] is the dot product of the
+	// current window and sums[r] its r-th difference
+	DTYPE sums[2] = {0, 0};
+	if (myStartElem < myEndElem)
+	{
+		for (uint32_t first = 0; first < query_length; first += MP_SEGMENT)
+		{
+			DTYPE *query = read_segment(query_m, first, cache_query);
+			DTYPE *ts    = read_segment(ts_m, myStartElem + first, cache_TS);
+			for (uint32_t c = 0; c < MP_SEGMENT && first + c < query_length; c++)
+				for (uint32_t r = 0; r < query_order; r++)
+					sums[r] += ts[c + r] * query[c];
+		}
+		if (query_order > 1)
+			sums[1] -= sums[0];
+	}
+
+	for (uint32_t i = myStartElem; i < myEndElem; i += MP_SEGMENT)
+	{
+		uint32_t count = (myEndElem - i < MP_SEGMENT) ? myEndElem - i : MP_SEGMENT;
+
+		// Highest-order difference of the dot products of the segment windows, a query term at a time
+		for (uint32_t c = 0; c < count; c++)
+			cache_slides[c] = 0;
+		for (uint32_t first = 0; first < query_terms; first += MP_SEGMENT)
+		{
+			uint32_t nr_terms = (query_terms - first < MP_SEGMENT) ? query_terms - first : MP_SEGMENT;
+			mram_read((__mram_ptr void const *) (terms_m + first * sizeof(query_term_t)), cache_terms, nr_terms * sizeof(query_term_t));
+			for (uint32_t t = 0; t < nr_terms; t++)
+			{
+				DTYPE *ts = read_segment(ts_m, i + cache_terms[t].offset, cache_TS);
+				for (uint32_t c = 0; c < count; c++)
+					cache_slides[c] += ts[c] * cache_terms[t].value;
+			}
+		}
+
+		DTYPE *mean  = read_segment(mean_m, i, cache_TSMean);
+		DTYPE *sigma = read_segment(sigma_m, i, cache_TSSigma);
+		for (uint32_t c = 0; c < count; c++)
+		{
+			distance = 2 * ((DTYPE) query_length - (sums[0] - (DTYPE) query_length * mean[c]
+						* query_mean) / (sigma[c] * query_std));
+
+			if(distance < min_distance)
+			{
+				min_distance =  distance;
+				min_index    =  i + c;
+			}
+
+			// Slide to the next window
+			if (query_order > 1)
+				sums[0] += sums[1];
+			sums[query_order - 1] += cache_slides[c];
+		}
+	}
+
+	// Save the result
+	result->minValue = min_distance;
+	result->minIndex = min_index;
+
+	return 0;
+}
@@ -29,6 +29,7 @@
 
 static DTYPE tSeries[1 << 26];
 static DTYPE query  [1 << 15];
+static query_term_t queryTerms[(1 << 15) + 2];
 static DTYPE AMean  [1 << 26];
 static DTYPE ASigma [1 << 26];
 static DTYPE minHost;
@@ -91,21 +92,24 @@ static void compute_ts_statistics(unsigned int timeSeriesLength, unsigned int Pr
 		ASqCumSum[i] = tSeries[i] * tSeries[i] + ASqCumSum[i - 1];
 	double* ASum = malloc(sizeof(double) * ProfileLength);
 	ASum[0] = ACumSum[queryLength - 1];
-	for (uint64_t i = 0; i < timeSeriesLength - queryLength; i++)
+	for (uint64_t i = 0; i + 1 < ProfileLength; i++)
 		ASum[i + 1] = ACumSum[queryLength + i] - ACumSum[i];
 	double* ASumSq = malloc(sizeof(double) * ProfileLength);
 	ASumSq[0] = ASqCumSum[queryLength - 1];
-	for (uint64_t i = 0; i < timeSeriesLength - queryLength; i++)
+	for (uint64_t i = 0; i + 1 < ProfileLength; i++)
 		ASumSq[i + 1] = ASqCumSum[queryLength + i] - ASqCumSum[i];
 	double * AMean_tmp = malloc(sizeof(double) * ProfileLength);
 	for (uint64_t i = 0; i < ProfileLength; i++)
 		AMean_tmp[i] = ASum[i] / queryLength;
 	double* ASigmaSq = malloc(sizeof(double) * ProfileLength);
 	for (uint64_t i = 0; i < ProfileLength; i++)
-		ASigmaSq[i] = ASumSq[i] / queryLength - AMean[i] * AMean[i];
+		ASigmaSq[i] = ASumSq[i] / queryLength - AMean_tmp[i] * AMean_tmp[i];
+	// Constant windows get a standard deviation of 1 to avoid dividing by 0
 	for (uint64_t i = 0; i < ProfileLength; i++)
 	{
 		ASigma[i] = sqrt(ASigmaSq[i]);
+		if (ASigma[i] == 0)
+			ASigma[i] = 1;
 		AMean[i]  = (DTYPE) AMean_tmp[i];
 	}
 
@@ -117,6 +121,383 @@ static void compute_ts_statistics(unsigned int timeSeriesLength, unsigned int Pr
 	free(AMean_tmp);
 }
 
+// Sliding dot products: collect the nonzero terms of the order-th difference of the query, D0 = Q and
+// Dr[k] = Dr-1[k - 1] - Dr-1[k] for 0 <= k < queryLength + r, taking the query as 0 outside [0, queryLength).
+// Returns the # of terms
+static uint32_t difference_query(unsigned int queryLength, unsigned int order) {
+	DTYPE* diff = calloc(queryLength + order, sizeof(DTYPE));
+	memcpy(diff, query, queryLength * sizeof(DTYPE));
+	for (unsigned int r = 1; r <= order; r++)
+	{
+		for (unsigned int k = queryLength + r - 1; k > 0; k--)
+			diff[k] = diff[k - 1] - diff[k];
+		diff[0] = -diff[0];
+	}
+
+	uint32_t nr_terms = 0;
+	for (unsigned int k = 0; k < queryLength + order; k++)
+	{
+		if (diff[k] != 0)
+		{
+			queryTerms[nr_terms].offset = k;
+			queryTerms[nr_terms].value  = diff[k];
+			nr_terms++;
+		}
+	}
+	free(diff);
+	return nr_terms;
+}
+
+// Streaming mode: append count samples of the synthetic series at position first
+static void append_test_chunk(unsigned long first, unsigned long count) {
+	for (uint64_t i = first; i < first + count; i++)
+	{
+		tSeries[i] = i % MAX_DATA_VAL;
+	}
+}
+
+// Streaming mode: sums of the samples of the next window, slid by one sample per window
+typedef struct {
+	unsigned long window;
+	double sum;
+	double sum_sq;
+} running_sums_t;
+
+static void init_running_sums(running_sums_t *rs, unsigned long window, unsigned int queryLength) {
+	rs->window = window;
+	rs->sum    = 0;
+	rs->sum_sq = 0;
+	for (uint64_t i = window; i < window + queryLength; i++)
+	{
+		rs->sum    += tSeries[i];
+		rs->sum_sq += (double) tSeries[i] * tSeries[i];
+	}
+}
+
+// Streaming mode: means and standard deviations of the next count windows, O(1) each, with the values of
+// compute_ts_statistics
+static void update_ts_statistics(running_sums_t *rs, unsigned long count, unsigned int queryLength) {
+	for (uint64_t w = rs->window; w < rs->window + count; w++)
+	{
+		double mean = rs->sum / queryLength;
+		AMean[w]  = (DTYPE) mean;
+		ASigma[w] = sqrt(rs->sum_sq / queryLength - mean * mean);
+		if (ASigma[w] == 0)
+			ASigma[w] = 1;
+		rs->sum    += tSeries[w + queryLength] - tSeries[w];
+		rs->sum_sq += (double) tSeries[w + queryLength] * tSeries[w + queryLength] - (double) tSeries[w] * tSeries[w];
+	}
+	rs->window += count;
+}
+
+// Streaming mode: append n_chunks chunks of chunk_size samples to the series. Each chunk completes chunk_size new
+// windows, which are split among the DPUs; every DPU receives its windows plus the query_length samples of overlap
+// they need, and only these windows are searched. The query stays in MRAM from the full run.
+// input_arguments are those of the full run, and result holds its best match on entry, and that of the whole stream on exit
+static void stream_chunks(struct dpu_set_t dpu_set, uint32_t nr_of_dpus, struct Params p, unsigned long ts_size,
+		dpu_arguments_t input_arguments, dpu_result_t *result) {
+	struct dpu_set_t dpu;
+	uint32_t i;
+	Timer timer;
+	double max_latency = 0;
+
+	// Chunks split among the DPUs, with slices that split evenly among the tasklets in 8-byte units. The last DPUs
+	// get fewer windows when the chunk does not fill all slices
+	unsigned long chunk_size = p.chunk_size;
+	uint32_t chunk_per_dpu = (chunk_size + nr_of_dpus - 1) / nr_of_dpus;
+	if (chunk_per_dpu % (NR_TASKLETS * 2))
+		chunk_per_dpu += NR_TASKLETS * 2 - chunk_per_dpu % (NR_TASKLETS * 2);
+	unsigned int query_length = input_arguments.query_length;
+	DTYPE query_mean = input_arguments.query_mean;
+	DTYPE query_std  = input_arguments.query_std;
+	assert(ts_size + (unsigned long) p.n_chunks * chunk_size + nr_of_dpus * chunk_per_dpu + query_length + BLOCK_SIZE <= sizeof(tSeries) / sizeof(DTYPE) && "Stream too long!");
+	printf("Streaming %u chunks of %lu samples (up to %u windows per DPU)\n", p.n_chunks, chunk_size, chunk_per_dpu);
+
+	// The full run searched the windows before ts_size - query_length - 1, where the stream resumes
+	unsigned long profile_length = ts_size - query_length - 1;
+	running_sums_t rs;
+	init_running_sums(&rs, profile_length, query_length);
+
+	input_arguments.slice_per_dpu = chunk_per_dpu;
+	DTYPE *buffers[3] = {tSeries, AMean, ASigma};
+	dpu_result_t* results_retrieve[nr_of_dpus];
+	DPU_FOREACH(dpu_set, dpu, i) {
+		results_retrieve[i] = (dpu_result_t*)malloc(NR_TASKLETS * sizeof(dpu_result_t));
+	}
+
+	for (unsigned int chunk = 0; chunk < p.n_chunks; chunk++) {
+		// New samples arrive
+		unsigned long first = rs.window;
+		append_test_chunk(first + query_length, chunk_size);
+		start(&timer, 4, chunk);
+		double latency = timer.time[4];
+		start(&timer, 0, chunk);
+		update_ts_statistics(&rs, chunk_size, query_length);
+		stop(&timer, 0);
+
+		start(&timer, 1, chunk);
+		input_arguments.ts_length = first + chunk_size + query_length;
+		DPU_FOREACH(dpu_set, dpu, i) {
+			unsigned long dpu_first = (unsigned long) i * chunk_per_dpu;
+			input_arguments.windows = (dpu_first >= chunk_size) ? 0 :
+				(chunk_size - dpu_first < chunk_per_dpu) ? chunk_size - dpu_first : chunk_per_dpu;
+			DPU_ASSERT(dpu_copy_to(dpu, "DPU_INPUT_ARGUMENTS", 0, (const void *) &input_arguments, sizeof(input_arguments)));
+		}
+		uint32_t mem_offset = query_length * sizeof(DTYPE);
+		for (unsigned int b = 0; b < 3; b++) {
+			DPU_FOREACH(dpu_set, dpu, i) {
+				DPU_ASSERT(dpu_prepare_xfer(dpu, buffers[b] + first + chunk_per_dpu * i));
+			}
+			DPU_ASSERT(dpu_push_xfer(dpu_set, DPU_XFER_TO_DPU, DPU_MRAM_HEAP_POINTER_NAME, mem_offset, (chunk_per_dpu + query_length) * sizeof(DTYPE), DPU_XFER_DEFAULT));
+			mem_offset += (chunk_per_dpu + query_length) * sizeof(DTYPE);
+		}
+		// The query terms follow the slice, which is shorter than in the full run
+		if (input_arguments.kernel == kernel3)
+			DPU_ASSERT(dpu_broadcast_to(dpu_set, DPU_MRAM_HEAP_POINTER_NAME, mem_offset, queryTerms, input_arguments.query_terms * sizeof(query_term_t), DPU_XFER_DEFAULT));
+		stop(&timer, 1);
+
+		start(&timer, 2, chunk);
+		DPU_ASSERT(dpu_launch(dpu_set, DPU_SYNCHRONOUS));
+		stop(&timer, 2);
+
+		start(&timer, 3, chunk);
+		DPU_FOREACH(dpu_set, dpu, i) {
+			DPU_ASSERT(dpu_prepare_xfer(dpu, results_retrieve[i]));
+		}
+		DPU_ASSERT(dpu_push_xfer(dpu_set, DPU_XFER_FROM_DPU, "DPU_RESULTS", 0, NR_TASKLETS * sizeof(dpu_result_t), DPU_XFER_DEFAULT));
+		DPU_FOREACH(dpu_set, dpu, i) {
+			for (unsigned int each_tasklet = 0; each_tasklet < NR_TASKLETS; each_tasklet++) {
+				if(results_retrieve[i][each_tasklet].minValue < result->minValue)
+				{
+					result->minValue = results_retrieve[i][each_tasklet].minValue;
+					result->minIndex = results_retrieve[i][each_tasklet].minIndex + first + i * chunk_per_dpu;
+				}
+			}
+		}
+		stop(&timer, 3);
+		stop(&timer, 4);
+		latency = timer.time[4] - latency;
+		if (latency > max_latency)
+			max_latency = latency;
+	}
+
+	DPU_FOREACH(dpu_set, dpu, i) {
+		free(results_retrieve[i]);
+	}
+
+	// Print timing results, per chunk
+	printf("Statistics Time (ms): ");
+	print(&timer, 0, p.n_chunks);
+	printf("CPU-DPU Time (ms): ");
+	print(&timer, 1, p.n_chunks);
+	printf("DPU Kernel Time (ms): ");
+	print(&timer, 2, p.n_chunks);
+	printf("DPU-CPU Time (ms): ");
+	print(&timer, 3, p.n_chunks);
+	printf("Latency per chunk (ms): ");
+	print(&timer, 4, p.n_chunks);
+	printf("Max latency (ms): %f\t", max_latency / 1000);
+
+	// The best match of the stream must be that of a batch search of every window of the streamed series
+	streamp(tSeries, AMean, ASigma, rs.window, query, query_length, query_mean, query_std);
+	int status = (minHost == result->minValue && (uint32_t) minHostIdx == result->minIndex);
+	if (status) {
+		printf("[" ANSI_COLOR_GREEN "OK" ANSI_COLOR_RESET "] results are equal\n");
+	} else {
+		printf("[" ANSI_COLOR_RED "ERROR" ANSI_COLOR_RESET "] results differ!\n");
+	}
+}
+
+// Matrix profile mode: distance of the windows first and first + diag, with the arithmetic of the DPUs
+static DTYPE window_distance(uint32_t first, uint32_t diag, unsigned int windowSize) {
+	DTYPE dotprod = 0;
+	for (unsigned int k = 0; k < windowSize; k++)
+		dotprod += tSeries[first + k] * tSeries[first + diag + k];
+	return 2 * ((DTYPE) windowSize - (dotprod - (DTYPE) windowSize * AMean[first] * AMean[first + diag])
+			/ (ASigma[first] * ASigma[first + diag]));
+}
+
+// Matrix profile mode: compute the profile in the host, walking the diagonals as the DPUs do
+static void matrix_profile_host(uint32_t ProfileLength, unsigned int windowSize, uint32_t exclusionZone, mp_entry_t *profile)
+{
+	for (uint32_t i = 0; i < ProfileLength; i++)
+	{
+		profile[i].value = DTYPE_MAX;
+		profile[i].index = 0;
+	}
+
+	for (uint32_t diag = exclusionZone + 1; diag < ProfileLength; diag++)
+	{
+		DTYPE dotprod = 0;
+		for (unsigned int k = 0; k < windowSize; k++)
+			dotprod += tSeries[k] * tSeries[diag + k];
+
+		for (uint32_t i = 0, j = diag; j < ProfileLength; i++, j++)
+		{
+			DTYPE distance = 2 * ((DTYPE) windowSize - (dotprod - (DTYPE) windowSize * AMean[i] * AMean[j])
+					/ (ASigma[i] * ASigma[j]));
+			if (distance < profile[i].value)
+			{
+				profile[i].value = distance;
+				profile[i].index = j;
+			}
+			if (distance < profile[j].value)
+			{
+				profile[j].value = distance;
+				profile[j].index = i;
+			}
+			dotprod += tSeries[i + windowSize] * tSeries[j + windowSize] - tSeries[i] * tSeries[j];
+		}
+	}
+}
+
+// Matrix profile mode: self-join of the series with windows of window_length samples and an exclusion zone of a
+// quarter window, as in the CPU baseline (baselines/cpu/streamp_openmp.cpp). The series and its window statistics are
+// broadcast to every DPU; each DPU returns a partial profile of the whole series, and the host keeps the nearest
+// match of every window across them. Returns false if the series does not fit in MRAM
+static bool matrix_profile(struct dpu_set_t dpu_set, uint32_t nr_of_dpus, struct Params p, unsigned long ts_size,
+		unsigned int window_length) {
+	struct dpu_set_t dpu, rank;
+	uint32_t i;
+	Timer timer;
+
+	uint32_t profile_length = ts_size - window_length + 1;
+	uint32_t exclusion_zone = window_length / 4;
+	assert(MP_PADDED_LENGTH(ts_size) <= sizeof(tSeries) / sizeof(DTYPE) && "Series too long!");
+
+	// Every DPU holds the whole series, its window statistics and a partial profile, initialized a segment at a time
+	uint32_t mean_offset    = MP_PADDED_LENGTH(ts_size) * sizeof(DTYPE);
+	uint32_t sigma_offset   = mean_offset + MP_PADDED_LENGTH(profile_length) * sizeof(DTYPE);
+	uint32_t profile_offset = sigma_offset + MP_PADDED_LENGTH(profile_length) * sizeof(DTYPE);
+	uint64_t mram_size      = (uint64_t) profile_offset + MP_PADDED_LENGTH(profile_length) * sizeof(mp_entry_t);
+	if (mram_size > DPU_CAPACITY) {
+		printf("[" ANSI_COLOR_RED "ERROR" ANSI_COLOR_RESET "] a series of %lu elements needs %lu bytes of MRAM\n", ts_size, (unsigned long) mram_size);
+		return false;
+	}
+	printf("Matrix profile of %u windows of %u elements (exclusion zone %u)\n", profile_length, window_length, exclusion_zone);
+
+	// Window means and standard deviations. Constant windows get a standard deviation of 1 to avoid dividing by 0
+	running_sums_t rs;
+	init_running_sums(&rs, 0, window_length);
+	for (uint32_t w = 0; w < profile_length; w++)
+	{
+		double mean = rs.sum / window_length;
+		AMean[w]  = (DTYPE) mean;
+		ASigma[w] = (DTYPE) sqrt(rs.sum_sq / window_length - mean * mean);
+		if (ASigma[w] == 0)
+			ASigma[w] = 1;
+		rs.sum    += tSeries[w + window_length] - tSeries[w];
+		rs.sum_sq += (double) tSeries[w + window_length] * tSeries[w + window_length] - (double) tSeries[w] * tSeries[w];
+	}
+
+	dpu_arguments_t input_arguments = {.ts_length = ts_size, .query_length = window_length, .windows = profile_length,
+		.exclusion_zone = exclusion_zone, .kernel = kernel2, .nr_dpus = nr_of_dpus};
+
+	// Partial profiles are retrieved a rank at a time
+	uint32_t max_rank_dpus = 0;
+	DPU_RANK_FOREACH(dpu_set, rank) {
+		uint32_t nr_rank_dpus;
+		DPU_ASSERT(dpu_get_nr_dpus(rank, &nr_rank_dpus));
+		if (nr_rank_dpus > max_rank_dpus)
+			max_rank_dpus = nr_rank_dpus;
+	}
+	mp_entry_t *partial_profiles = (mp_entry_t *) malloc((size_t) max_rank_dpus * profile_length * sizeof(mp_entry_t));
+	mp_entry_t *profile          = (mp_entry_t *) malloc((size_t) profile_length * sizeof(mp_entry_t));
+	mp_entry_t *profile_host     = (mp_entry_t *) malloc((size_t) profile_length * sizeof(mp_entry_t));
+
+	for (int rep = 0; rep < p.n_warmup + p.n_reps; rep++) {
+
+		if (rep >= p.n_warmup)
+			start(&timer, 1, rep - p.n_warmup);
+		DPU_FOREACH(dpu_set, dpu, i) {
+			input_arguments.dpu_id = i;
+			DPU_ASSERT(dpu_copy_to(dpu, "DPU_INPUT_ARGUMENTS", 0, (const void *) &input_arguments, sizeof(input_arguments)));
+		}
+		DPU_ASSERT(dpu_broadcast_to(dpu_set, DPU_MRAM_HEAP_POINTER_NAME, 0, tSeries, MP_PADDED_LENGTH(ts_size) * sizeof(DTYPE), DPU_XFER_DEFAULT));
+		DPU_ASSERT(dpu_broadcast_to(dpu_set, DPU_MRAM_HEAP_POINTER_NAME, mean_offset, AMean, MP_PADDED_LENGTH(profile_length) * sizeof(DTYPE), DPU_XFER_DEFAULT));
+		DPU_ASSERT(dpu_broadcast_to(dpu_set, DPU_MRAM_HEAP_POINTER_NAME, sigma_offset, ASigma, MP_PADDED_LENGTH(profile_length) * sizeof(DTYPE), DPU_XFER_DEFAULT));
+		if (rep >= p.n_warmup)
+			stop(&timer, 1);
+
+		if (rep >= p.n_warmup)
+			start(&timer, 2, rep - p.n_warmup);
+		DPU_ASSERT(dpu_launch(dpu_set, DPU_SYNCHRONOUS));
+		if (rep >= p.n_warmup)
+			stop(&timer, 2);
+
+		// Merge the partial profiles; ties go to the lowest index so that the result does not depend on the schedule
+		if (rep >= p.n_warmup)
+			start(&timer, 3, rep - p.n_warmup);
+		for (uint32_t w = 0; w < profile_length; w++)
+		{
+			profile[w].value = DTYPE_MAX;
+			profile[w].index = 0;
+		}
+		DPU_RANK_FOREACH(dpu_set, rank) {
+			uint32_t nr_rank_dpus;
+			DPU_ASSERT(dpu_get_nr_dpus(rank, &nr_rank_dpus));
+			DPU_FOREACH(rank, dpu, i) {
+				DPU_ASSERT(dpu_prepare_xfer(dpu, partial_profiles + (size_t) i * profile_length));
+			}
+			DPU_ASSERT(dpu_push_xfer(rank, DPU_XFER_FROM_DPU, DPU_MRAM_HEAP_POINTER_NAME, profile_offset, profile_length * sizeof(mp_entry_t), DPU_XFER_DEFAULT));
+			for (i = 0; i < nr_rank_dpus; i++) {
+				mp_entry_t *partial_profile = partial_profiles + (size_t) i * profile_length;
+				for (uint32_t w = 0; w < profile_length; w++)
+				{
+					if (partial_profile[w].value < profile[w].value ||
+							(partial_profile[w].value == profile[w].value && partial_profile[w].index < profile[w].index))
+						profile[w] = partial_profile[w];
+				}
+			}
+		}
+		if (rep >= p.n_warmup)
+			stop(&timer, 3);
+
+		if (rep >= p.n_warmup)
+			start(&timer, 4, rep - p.n_warmup);
+		matrix_profile_host(profile_length, window_length, exclusion_zone, profile_host);
+		if (rep >= p.n_warmup)
+			stop(&timer, 4);
+	}
+
+	// Print timing results
+	printf("CPU Version Time (ms): ");
+	print(&timer, 4, p.n_reps);
+	printf("CPU-DPU Time (ms): ");
+	print(&timer, 1, p.n_reps);
+	printf("DPU Kernel Time (ms): ");
+	print(&timer, 2, p.n_reps);
+	printf("DPU-CPU Time (ms): ");
+	print(&timer, 3, p.n_reps);
+
+	// The distances must match those of the host; a nearest match may differ on ties, so it is checked to be a
+	// window outside the exclusion zone at that distance
+	uint32_t motif = 0;
+	int status = 1;
+	for (uint32_t w = 0; w < profile_length; w++)
+	{
+		uint32_t match = profile[w].index;
+		uint32_t first = (w < match) ? w : match;
+		uint32_t diag  = (w < match) ? match - w : w - match;
+		if (profile[w].value != profile_host[w].value || match >= profile_length || diag <= exclusion_zone ||
+				window_distance(first, diag, window_length) != profile[w].value)
+			status = 0;
+		if (profile[w].value < profile[motif].value)
+			motif = w;
+	}
+	printf("Motif: windows %u and %u (distance %d)\n", motif, profile[motif].index, profile[motif].value);
+	if (status) {
+		printf("[" ANSI_COLOR_GREEN "OK" ANSI_COLOR_RESET "] results are equal\n");
+	} else {
+		printf("[" ANSI_COLOR_RED "ERROR" ANSI_COLOR_RESET "] results differ!\n");
+	}
+
+	free(partial_profiles);
+	free(profile);
+	free(profile_host);
+	return status;
+}
+
 // Main of the Host Application
 int main(int argc, char **argv) {
 
@@ -146,6 +527,15 @@ int main(int argc, char **argv) {
 
 	// Create an input file with arbitrary data
 	create_test_file(ts_size, query_length);
+
+	if (p.matrix_profile) {
+		bool status = matrix_profile(dpu_set, nr_of_dpus, p, ts_size, query_length);
+		DPU_ASSERT(dpu_free(dpu_set));
+#if ENERGY
+		DPU_ASSERT(dpu_probe_deinit(&probe));
+#endif
+		return status ? 0 : -1;
+	}
 	compute_ts_statistics(ts_size, ts_size - query_length, query_length);
 
 	DTYPE query_mean;
@@ -172,8 +562,27 @@ int main(int argc, char **argv) {
 
 	uint32_t slice_per_dpu = ts_size / nr_of_dpus;
 
-	unsigned int kernel = 0;
-	dpu_arguments_t input_arguments = {ts_size, query_length, query_mean, query_std, slice_per_dpu, 0, kernel};
+	// Sliding dot products (-k 1), with the first or second difference of the query, whichever has fewer terms. Dense
+	// differences are not worth it, and the dot products of every window are computed from scratch instead
+	unsigned int kernel = kernel1;
+	uint32_t query_order = 0;
+	uint32_t query_terms = 0;
+	if (p.sliding) {
+		uint32_t first_terms = difference_query(query_length, 1);
+		query_order = (difference_query(query_length, 2) < first_terms) ? 2 : 1;
+		query_terms = difference_query(query_length, query_order);
+		if (query_terms <= query_length / 4)
+			kernel = kernel3;
+	}
+	if (kernel == kernel3)
+		printf("Kernel: sliding dot products, %u terms of difference %u of the query\n", query_terms, query_order);
+	else
+		printf("Kernel: dot products from scratch\n");
+	dpu_arguments_t input_arguments = {.ts_length = ts_size, .query_length = query_length, .query_mean = query_mean,
+		.query_std = query_std, .slice_per_dpu = slice_per_dpu, .windows = slice_per_dpu, .kernel = kernel,
+		.query_order = query_order, .query_terms = query_terms};
+	// Windows searched by the host version
+	uint32_t profile_length = ts_size - query_length - 1;
 	uint32_t mem_offset;
 
 	dpu_result_t result;
@@ -190,6 +599,7 @@ int main(int argc, char **argv) {
 
 		DPU_FOREACH(dpu_set, dpu) {
 			input_arguments.exclusion_zone = 0;
+			input_arguments.windows = (profile_length - i * slice_per_dpu < slice_per_dpu) ? profile_length - i * slice_per_dpu : slice_per_dpu;
 
 			DPU_ASSERT(dpu_copy_to(dpu, "DPU_INPUT_ARGUMENTS", 0, (const void *) &input_arguments, sizeof(input_arguments)));
 			i++;
@@ -232,6 +642,11 @@ int main(int argc, char **argv) {
 
 		DPU_ASSERT(dpu_push_xfer(dpu_set, DPU_XFER_TO_DPU, DPU_MRAM_HEAP_POINTER_NAME, mem_offset, (slice_per_dpu + query_length)*sizeof(DTYPE), DPU_XFER_DEFAULT));
 
+		mem_offset += ((slice_per_dpu + query_length) * sizeof(DTYPE));
+
+		if (kernel == kernel3)
+			DPU_ASSERT(dpu_broadcast_to(dpu_set, DPU_MRAM_HEAP_POINTER_NAME, mem_offset, queryTerms, query_terms * sizeof(query_term_t), DPU_XFER_DEFAULT));
+
 		if (rep >= p.n_warmup)
 			stop(&timer, 1);
 
@@ -272,7 +687,7 @@ int main(int argc, char **argv) {
 		i = 0;
 		DPU_FOREACH(dpu_set, dpu, i) {
 			for (unsigned int each_tasklet = 0; each_tasklet < NR_TASKLETS; each_tasklet++) {
-				if(results_retrieve[i][each_tasklet].minValue < result.minValue && results_retrieve[i][each_tasklet].minValue > 0)
+				if(results_retrieve[i][each_tasklet].minValue < result.minValue)
 				{
 					result.minValue = results_retrieve[i][each_tasklet].minValue;
 					result.minIndex = (DTYPE)results_retrieve[i][each_tasklet].minIndex + (i * slice_per_dpu);
@@ -280,7 +695,6 @@ int main(int argc, char **argv) {
 
 			}
 			free(results_retrieve[i]);
-			i++;
 		}
 
 		if(rep >= p.n_warmup)
@@ -296,7 +710,7 @@ int main(int argc, char **argv) {
 
 		if (rep >= p.n_warmup)
 			start(&timer, 4, rep - p.n_warmup);
-		streamp(tSeries, AMean, ASigma, ts_size - query_length - 1, query, query_length, query_mean, query_std);
+		streamp(tSeries, AMean, ASigma, profile_length, query, query_length, query_mean, query_std);
 		if(rep >= p.n_warmup)
 			stop(&timer, 4);
 	}
@@ -332,6 +746,9 @@ int main(int argc, char **argv) {
 		printf("[" ANSI_COLOR_RED "ERROR" ANSI_COLOR_RESET "] results differ!\n");
 	}
 
+	if (p.chunk_size > 0)
+		stream_chunks(dpu_set, nr_of_dpus, p, ts_size, input_arguments, &result);
+
 	DPU_ASSERT(dpu_free(dpu_set));
 
 #if ENERGY
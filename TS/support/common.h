@@ -20,11 +20,18 @@ typedef struct  {
     DTYPE query_mean;
     DTYPE query_std;
     uint32_t slice_per_dpu;
+    uint32_t windows; // Windows of the slice whose subsequence is in the series
     int32_t exclusion_zone;
     enum kernels {
 		kernel1 = 0,
-		nr_kernels = 1,
+		kernel2 = 1, // Matrix profile (self-join of the series)
+		kernel3 = 2, // Sliding dot products
+		nr_kernels = 3,
 	} kernel;
+    uint32_t dpu_id;  // Matrix profile: diagonals are dealt to the tasklets of all DPUs
+    uint32_t nr_dpus;
+    uint32_t query_order; // Sliding dot products: order of the differenced query, and # of nonzero terms
+    uint32_t query_terms;
 }dpu_arguments_t;
 
 typedef struct  {
@@ -34,6 +41,25 @@ typedef struct  {
     uint32_t maxIndex;
 }dpu_result_t;
 
+// Matrix profile entry: distance to the nearest non-trivial match and its window
+typedef struct  {
+    DTYPE value;
+    uint32_t index;
+}mp_entry_t;
+
+// Sliding dot products: nonzero term of the differenced query, applied to the sample offset elements after the window
+typedef struct  {
+    uint32_t offset;
+    DTYPE value;
+}query_term_t;
+
+// Matrix profile and sliding dot products: windows per segment, and matrix profile MRAM lengths of the arrays, padded for the unaligned
+// segment reads past their end
+#define MP_SEGMENT (BLOCK_SIZE / sizeof(DTYPE))
+#define MP_PADDED_LENGTH(len) ((((len) + 2 * MP_SEGMENT + 2) / MP_SEGMENT) * MP_SEGMENT)
+
+#define DPU_CAPACITY (64 << 20) // A DPU's capacity is 64 MiB
+
 #ifndef ENERGY
 #define ENERGY 0
 #endif
@@ -7,6 +7,10 @@
 typedef struct Params {
   unsigned long  input_size_n;
   unsigned long  input_size_m;
+  unsigned long  chunk_size;
+  unsigned int   n_chunks;
+  unsigned int   matrix_profile;
+  unsigned int   sliding;
   int  n_warmup;
   int  n_reps;
 }Params;
@@ -23,6 +27,10 @@ void usage() {
     "\nBenchmark-specific options:"
     "\n    -n <n>    n (TS length. Default=64K elements)"
     "\n    -m <m>    m (Query length. Default=256 elements)"
+    "\n    -c <c>    streaming mode: samples appended per chunk (default=0, no streaming)"
+    "\n    -u <u>    streaming mode: # of appended chunks (default=16)"
+    "\n    -k <k>    sliding dot products: 0=never, 1=when the differenced query is sparse (default=0)"
+    "\n    -p        matrix profile mode: self-join of the series with windows of m elements"
     "\n");
   }
 
@@ -30,12 +38,16 @@ void usage() {
     struct Params p;
     p.input_size_n  = 1 << 16;
     p.input_size_m  = 1 << 8;
+    p.chunk_size    = 0;
+    p.n_chunks      = 16;
+    p.matrix_profile = 0;
+    p.sliding       = 0;
 
     p.n_warmup      = 1;
     p.n_reps        = 3;
 
     int opt;
-    while((opt = getopt(argc, argv, "hw:e:n:m:")) >= 0) {
+    while((opt = getopt(argc, argv, "hw:e:n:m:c:u:k:p")) >= 0) {
       switch(opt) {
         case 'h':
         usage();
@@ -45,6 +57,10 @@ void usage() {
         case 'e': p.n_reps        = atoi(optarg); break;
         case 'n': p.input_size_n  = atol(optarg); break;
         case 'm': p.input_size_m  = atol(optarg); break;
+        case 'c': p.chunk_size    = atol(optarg); break;
+        case 'u': p.n_chunks      = atoi(optarg); break;
+        case 'k': p.sliding       = atoi(optarg); break;
+        case 'p': p.matrix_profile = 1;           break;
         default:
         fprintf(stderr, "\nUnrecognized option!\n");
         usage();
@@ -0,0 +1,351 @@
+/*
+ * Graph loading and preprocessing shared by BFS, PR and TC: COO/CSR graphs read from text or binary COO files
+ * (see input.h), COO to CSR conversion, and the transformations the kernels need (transposition, symmetry check,
+ * relabeling by degree, orientation).
+ */
+
+#ifndef _GRAPH_H_
+#define _GRAPH_H_
+
+#include "input.h"
+
+struct COOGraph {
+    uint32_t numNodes; /* Padded to a multiple of 64 nodes */
+    uint32_t numInputNodes; /* Nodes of the input graph, the others are isolated padding nodes */
+    uint32_t numEdges;
+    uint32_t* nodeIdxs;
+    uint32_t* neighborIdxs;
+};
+
+struct CSRGraph {
+    uint32_t numNodes;
+    uint32_t numEdges;
+    uint32_t* nodePtrs;
+    uint32_t* neighborIdxs;
+};
+
+static inline struct COOGraph readCOOGraph(const char* fileName) {
+
+    struct COOGraph cooGraph;
+
+    // Map the file, then detect binary files by their magic number, otherwise parse the text format
+    size_t size;
+    const char* data = mapFile(fileName, &size);
+    const char* pos = data;
+    const char* end = data + size;
+    uint32_t binary = isBinaryCOO(data, size);
+
+    // Initialize fields
+    uint32_t numNodes, numCols;
+    if(binary) {
+        numNodes = ((const uint32_t*)data)[1];
+        numCols = ((const uint32_t*)data)[2];
+        cooGraph.numEdges = ((const uint32_t*)data)[3];
+        assert(size >= (4 + 2*(size_t)cooGraph.numEdges)*sizeof(uint32_t) && "Truncated binary file!");
+    } else {
+        numNodes = parseUint(&pos, end);
+        numCols = parseUint(&pos, end);
+        cooGraph.numEdges = parseUint(&pos, end);
+    }
+    if(numNodes == numCols) {
+        cooGraph.numNodes = numNodes;
+    } else {
+        PRINT_WARNING("    Adjacency matrix is not square. Padding matrix to be square.");
+        cooGraph.numNodes = (numNodes > numCols)? numNodes : numCols;
+    }
+    cooGraph.numInputNodes = cooGraph.numNodes;
+    if(cooGraph.numNodes%64 != 0) {
+        PRINT_WARNING("    Adjacency matrix dimension is %u which is not a multiple of 64 nodes.", cooGraph.numNodes);
+        cooGraph.numNodes += (64 - cooGraph.numNodes%64);
+        PRINT_WARNING("        Padding to %u which is a multiple of 64 nodes.", cooGraph.numNodes);
+    }
+    cooGraph.nodeIdxs = (uint32_t*) malloc(cooGraph.numEdges*sizeof(uint32_t));
+    cooGraph.neighborIdxs = (uint32_t*) malloc(cooGraph.numEdges*sizeof(uint32_t));
+
+    // Read the edges
+    if(binary) {
+        memcpy(cooGraph.nodeIdxs, (const uint32_t*)data + 4, cooGraph.numEdges*sizeof(uint32_t));
+        memcpy(cooGraph.neighborIdxs, (const uint32_t*)data + 4 + cooGraph.numEdges, cooGraph.numEdges*sizeof(uint32_t));
+    } else {
+        for(uint32_t edgeIdx = 0; edgeIdx < cooGraph.numEdges; ++edgeIdx) {
+            cooGraph.nodeIdxs[edgeIdx] = parseUint(&pos, end);
+            cooGraph.neighborIdxs[edgeIdx] = parseUint(&pos, end);
+        }
+    }
+    munmap((void*)data, (size > 0)?size:1);
+
+    return cooGraph;
+
+}
+
+static inline void freeCOOGraph(struct COOGraph cooGraph) {
+    free(cooGraph.nodeIdxs);
+    free(cooGraph.neighborIdxs);
+}
+
+static inline struct CSRGraph coo2csr(struct COOGraph cooGraph) {
+
+    struct CSRGraph csrGraph;
+
+    // Initialize fields
+    csrGraph.numNodes = cooGraph.numNodes;
+    csrGraph.numEdges = cooGraph.numEdges;
+    csrGraph.nodePtrs = (uint32_t*) calloc(ROUND_UP_TO_MULTIPLE_OF_2(csrGraph.numNodes + 1), sizeof(uint32_t));
+    csrGraph.neighborIdxs = (uint32_t*)malloc(ROUND_UP_TO_MULTIPLE_OF_8(csrGraph.numEdges*sizeof(uint32_t)));
+
+    // Histogram nodeIdxs in parallel, checking whether the edges are already sorted by node
+    uint32_t numUnsorted = 0;
+    #pragma omp parallel for reduction(+:numUnsorted)
+    for(uint32_t i = 0; i < cooGraph.numEdges; ++i) {
+        uint32_t nodeIdx = cooGraph.nodeIdxs[i];
+        __atomic_fetch_add(&csrGraph.nodePtrs[nodeIdx], 1, __ATOMIC_RELAXED);
+        numUnsorted += (i > 0 && cooGraph.nodeIdxs[i - 1] > nodeIdx);
+    }
+
+    // Prefix sum nodePtrs
+    uint32_t sumBeforeNextNode = 0;
+    for(uint32_t nodeIdx = 0; nodeIdx < csrGraph.numNodes; ++nodeIdx) {
+        uint32_t sumBeforeNode = sumBeforeNextNode;
+        sumBeforeNextNode += csrGraph.nodePtrs[nodeIdx];
+        csrGraph.nodePtrs[nodeIdx] = sumBeforeNode;
+    }
+    csrGraph.nodePtrs[csrGraph.numNodes] = sumBeforeNextNode;
+
+    // Edges sorted by node (as in most input files) are already binned, so copy them in parallel
+    if(numUnsorted == 0) {
+        #pragma omp parallel for
+        for(uint32_t i = 0; i < cooGraph.numEdges; ++i) {
+            csrGraph.neighborIdxs[i] = cooGraph.neighborIdxs[i];
+        }
+        return csrGraph;
+    }
+
+    // Bin the neighborIdxs
+    for(uint32_t i = 0; i < cooGraph.numEdges; ++i) {
+        uint32_t nodeIdx = cooGraph.nodeIdxs[i];
+        uint32_t neighborListIdx = csrGraph.nodePtrs[nodeIdx]++;
+        csrGraph.neighborIdxs[neighborListIdx] = cooGraph.neighborIdxs[i];
+    }
+
+    // Restore nodePtrs
+    for(uint32_t nodeIdx = csrGraph.numNodes - 1; nodeIdx > 0; --nodeIdx) {
+        csrGraph.nodePtrs[nodeIdx] = csrGraph.nodePtrs[nodeIdx - 1];
+    }
+    csrGraph.nodePtrs[0] = 0;
+
+    return csrGraph;
+
+}
+
+static inline void freeCSRGraph(struct CSRGraph csrGraph) {
+    free(csrGraph.nodePtrs);
+    free(csrGraph.neighborIdxs);
+}
+
+// Reverse every edge, so that the CSR graph built from the result lists the in-edges of each node (shares the arrays)
+static inline struct COOGraph transposeCOOGraph(struct COOGraph cooGraph) {
+    struct COOGraph transposedGraph = cooGraph;
+    transposedGraph.nodeIdxs = cooGraph.neighborIdxs;
+    transposedGraph.neighborIdxs = cooGraph.nodeIdxs;
+    return transposedGraph;
+}
+
+// 1/out-degree of every node, 0 for nodes without out-edges (dangling nodes)
+static inline float* computeInvOutDegrees(struct COOGraph cooGraph) {
+    uint32_t* outDegrees = (uint32_t*) calloc(cooGraph.numNodes, sizeof(uint32_t));
+    #pragma omp parallel for
+    for(uint32_t i = 0; i < cooGraph.numEdges; ++i) {
+        __atomic_fetch_add(&outDegrees[cooGraph.nodeIdxs[i]], 1, __ATOMIC_RELAXED);
+    }
+    float* invOutDegrees = (float*) malloc(ROUND_UP_TO_MULTIPLE_OF_8(cooGraph.numNodes*sizeof(float)));
+    #pragma omp parallel for
+    for(uint32_t nodeIdx = 0; nodeIdx < cooGraph.numNodes; ++nodeIdx) {
+        invOutDegrees[nodeIdx] = (outDegrees[nodeIdx] > 0)?1.0f/outDegrees[nodeIdx]:0.0f;
+    }
+    free(outDegrees);
+    return invOutDegrees;
+}
+
+static inline int compareNodeIdxs(const void* a, const void* b) {
+    uint32_t x = *(const uint32_t*)a;
+    uint32_t y = *(const uint32_t*)b;
+    return (x > y) - (x < y);
+}
+
+// Whether every edge u -> v has the reverse edge v -> u. Bottom-up levels find the parents of a node among its
+// out-neighbors, which are its in-neighbors only in a symmetric (undirected) graph
+static inline int isSymmetric(struct CSRGraph csrGraph) {
+    uint32_t* sortedNeighborIdxs = (uint32_t*) malloc(ROUND_UP_TO_MULTIPLE_OF_8(csrGraph.numEdges*sizeof(uint32_t)));
+    memcpy(sortedNeighborIdxs, csrGraph.neighborIdxs, csrGraph.numEdges*sizeof(uint32_t));
+    #pragma omp parallel for schedule(dynamic, 1024)
+    for(uint32_t u = 0; u < csrGraph.numNodes; ++u) {
+        qsort(&sortedNeighborIdxs[csrGraph.nodePtrs[u]], csrGraph.nodePtrs[u + 1] - csrGraph.nodePtrs[u], sizeof(uint32_t), compareNodeIdxs);
+    }
+    uint32_t numAsymmetric = 0;
+    #pragma omp parallel for schedule(dynamic, 1024) reduction(+:numAsymmetric)
+    for(uint32_t u = 0; u < csrGraph.numNodes; ++u) {
+        for(uint32_t i = csrGraph.nodePtrs[u]; i < csrGraph.nodePtrs[u + 1]; ++i) {
+            uint32_t v = sortedNeighborIdxs[i];
+            numAsymmetric += (bsearch(&u, &sortedNeighborIdxs[csrGraph.nodePtrs[v]], csrGraph.nodePtrs[v + 1] - csrGraph.nodePtrs[v], sizeof(uint32_t), compareNodeIdxs) == NULL);
+        }
+    }
+    free(sortedNeighborIdxs);
+    return numAsymmetric == 0;
+}
+
+static inline int compareDegreeKeys(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*)a;
+    uint64_t y = *(const uint64_t*)b;
+    return (x > y) - (x < y);
+}
+
+// Renumber the nodes by increasing degree (ties keep their original order), so that after
+// orientation every edge points to a node of equal or higher degree and no out-degree exceeds O(sqrt(E))
+static inline struct CSRGraph relabelByDegree(struct CSRGraph csrGraph) {
+
+    struct CSRGraph relabeledGraph;
+
+    // Sort the nodes by (degree, index)
+    uint32_t numNodes = csrGraph.numNodes;
+    uint64_t* degreeKeys = (uint64_t*) malloc(numNodes*sizeof(uint64_t));
+    for(uint32_t u = 0; u < numNodes; ++u) {
+        uint64_t degree = csrGraph.nodePtrs[u + 1] - csrGraph.nodePtrs[u];
+        degreeKeys[u] = (degree << 32) | u;
+    }
+    qsort(degreeKeys, numNodes, sizeof(uint64_t), compareDegreeKeys);
+    uint32_t* newIdxs = (uint32_t*) malloc(numNodes*sizeof(uint32_t));
+    for(uint32_t rank = 0; rank < numNodes; ++rank) {
+        newIdxs[(uint32_t)degreeKeys[rank]] = rank;
+    }
+
+    // Initialize fields
+    relabeledGraph.numNodes = numNodes;
+    relabeledGraph.numEdges = csrGraph.numEdges;
+    relabeledGraph.nodePtrs = (uint32_t*) calloc(ROUND_UP_TO_MULTIPLE_OF_2(numNodes + 1), sizeof(uint32_t));
+    relabeledGraph.neighborIdxs = (uint32_t*) malloc(ROUND_UP_TO_MULTIPLE_OF_8(csrGraph.numEdges*sizeof(uint32_t)));
+
+    // Copy the adjacency lists in the new order, renaming the neighbors
+    for(uint32_t rank = 0; rank < numNodes; ++rank) {
+        uint32_t u = (uint32_t)degreeKeys[rank];
+        uint32_t degree = csrGraph.nodePtrs[u + 1] - csrGraph.nodePtrs[u];
+        relabeledGraph.nodePtrs[rank + 1] = relabeledGraph.nodePtrs[rank] + degree;
+        for(uint32_t i = 0; i < degree; ++i) {
+            relabeledGraph.neighborIdxs[relabeledGraph.nodePtrs[rank] + i] = newIdxs[csrGraph.neighborIdxs[csrGraph.nodePtrs[u] + i]];
+        }
+    }
+
+    free(degreeKeys);
+    free(newIdxs);
+
+    return relabeledGraph;
+
+}
+
+// Keep only the edges u -> v with u < v, sort every adjacency list and drop duplicate edges, so that each
+// triangle u < v < w is found exactly once by merging the lists of u and v
+static inline struct CSRGraph orientCSRGraph(struct CSRGraph csrGraph) {
+
+    struct CSRGraph dagGraph;
+
+    // Initialize fields
+    dagGraph.numNodes = csrGraph.numNodes;
+    dagGraph.nodePtrs = (uint32_t*) calloc(ROUND_UP_TO_MULTIPLE_OF_2(dagGraph.numNodes + 1), sizeof(uint32_t));
+
+    // Count the higher-numbered neighbors of every node
+    for(uint32_t u = 0; u < csrGraph.numNodes; ++u) {
+        uint32_t degree = 0;
+        for(uint32_t i = csrGraph.nodePtrs[u]; i < csrGraph.nodePtrs[u + 1]; ++i) {
+            if(csrGraph.neighborIdxs[i] > u) {
+                ++degree;
+            }
+        }
+        dagGraph.nodePtrs[u + 1] = dagGraph.nodePtrs[u] + degree;
+    }
+    dagGraph.numEdges = dagGraph.nodePtrs[dagGraph.numNodes];
+
+    // Copy and sort the adjacency lists (padded so that 8B transfers never read past the end)
+    dagGraph.neighborIdxs = (uint32_t*) calloc(ROUND_UP_TO_MULTIPLE_OF_2(dagGraph.numEdges + 1), sizeof(uint32_t));
+    for(uint32_t u = 0; u < csrGraph.numNodes; ++u) {
+        uint32_t* dagNeighbors = &dagGraph.neighborIdxs[dagGraph.nodePtrs[u]];
+        uint32_t degree = 0;
+        for(uint32_t i = csrGraph.nodePtrs[u]; i < csrGraph.nodePtrs[u + 1]; ++i) {
+            if(csrGraph.neighborIdxs[i] > u) {
+                dagNeighbors[degree++] = csrGraph.neighborIdxs[i];
+            }
+        }
+        qsort(dagNeighbors, degree, sizeof(uint32_t), compareNodeIdxs);
+    }
+
+    // Compact the sorted lists in place, keeping the first copy of every neighbor
+    uint32_t numUniqueEdges = 0;
+    for(uint32_t u = 0; u < dagGraph.numNodes; ++u) {
+        uint32_t start = dagGraph.nodePtrs[u];
+        uint32_t end = dagGraph.nodePtrs[u + 1];
+        dagGraph.nodePtrs[u] = numUniqueEdges;
+        for(uint32_t i = start; i < end; ++i) {
+            if(i == start || dagGraph.neighborIdxs[i] != dagGraph.neighborIdxs[i - 1]) {
+                dagGraph.neighborIdxs[numUniqueEdges++] = dagGraph.neighborIdxs[i];
+            }
+        }
+    }
+    dagGraph.nodePtrs[dagGraph.numNodes] = numUniqueEdges;
+    memset(&dagGraph.neighborIdxs[numUniqueEdges], 0, (dagGraph.numEdges - numUniqueEdges)*sizeof(uint32_t));
+    dagGraph.numEdges = numUniqueEdges;
+
+    return dagGraph;
+
+}
+
+// Number of unsigned integers in the text [begin, end)
+static inline uint32_t countUints(const char* begin, const char* end) {
+    uint32_t count = 0;
+    for(const char* p = begin; p < end; ++p) {
+        count += (*p >= '0' && *p <= '9' && (p == begin || p[-1] < '0' || p[-1] > '9'));
+    }
+    return count;
+}
+
+// Read a graph in CSR text format, a line of node pointers followed by a line of neighbor indexes,
+// or a binary COO file, detected by its magic number
+static inline struct CSRGraph read_graph_data(const char *filename) {
+    struct CSRGraph csrGraph;
+
+    size_t size;
+    const char* data = mapFile(filename, &size);
+    if(isBinaryCOO(data, size)) {
+        munmap((void*)data, size);
+        struct COOGraph cooGraph = readCOOGraph(filename);
+        csrGraph = coo2csr(cooGraph);
+        freeCOOGraph(cooGraph);
+        return csrGraph;
+    }
+    const char* end = data + size;
+
+    // Read nodePtrs
+    const char* lineEnd = (const char*) memchr(data, '\n', size);
+    lineEnd = (lineEnd == NULL)?end:lineEnd;
+    uint32_t count = countUints(data, lineEnd);
+    csrGraph.nodePtrs = (uint32_t*) calloc(ROUND_UP_TO_MULTIPLE_OF_2(count), sizeof(uint32_t));
+    const char* pos = data;
+    for(uint32_t i = 0; i < count; ++i) {
+        csrGraph.nodePtrs[i] = parseUint(&pos, lineEnd);
+    }
+    csrGraph.numNodes = count - 1;
+
+    // Read neighborIdxs
+    const char* lineStart = lineEnd;
+    lineEnd = (lineStart < end)?(const char*) memchr(lineStart + 1, '\n', end - lineStart - 1):NULL;
+    lineEnd = (lineEnd == NULL)?end:lineEnd;
+    count = countUints(lineStart, lineEnd);
+    csrGraph.neighborIdxs = (uint32_t*) malloc(ROUND_UP_TO_MULTIPLE_OF_8(count*sizeof(uint32_t)));
+    pos = lineStart;
+    for(uint32_t i = 0; i < count; ++i) {
+        csrGraph.neighborIdxs[i] = parseUint(&pos, lineEnd);
+    }
+    csrGraph.numEdges = count;
+
+    munmap((void*)data, (size > 0)?size:1);
+    return csrGraph;
+}
+
+#endif
@@ -0,0 +1,67 @@
+/*
+ * Input file helpers shared by the graph and sparse matrix benchmarks (BFS, PR, SpMV, TC), found through -I../common.
+ * Like the other headers in this directory, it takes ROUND_UP_TO_MULTIPLE_OF_* and PRINT_* from the including
+ * benchmark's common.h and utils.h, and its functions are static inline so that each benchmark only builds what it uses.
+ */
+
+#ifndef _INPUT_H_
+#define _INPUT_H_
+
+#include <assert.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "common.h"
+#include "utils.h"
+
+/*
+ * Binary COO format written by SpMV/data/generate/synth (a matrix is read as the graph with an edge per nonzero):
+ *   uint32_t header[4] = { COO_BINARY_MAGIC, numRows, numCols, numNonzeros }
+ *   uint32_t rowIdxs[numNonzeros]
+ *   uint32_t colIdxs[numNonzeros]
+ * Indexes are 0-based and matrix nonzero values are all 1.0f.
+ */
+#define COO_BINARY_MAGIC 0x4F4F4350 /* "PCOO" */
+
+// Map a whole input file read-only, exiting if it cannot be opened
+static inline const char* mapFile(const char* fileName, size_t* size) {
+    int fd = open(fileName, O_RDONLY);
+    struct stat st;
+    if(fd < 0 || fstat(fd, &st) != 0) {
+        PRINT_ERROR("Cannot open file %s", fileName);
+        exit(EXIT_FAILURE);
+    }
+    *size = st.st_size;
+    const char* data = (const char*) mmap(NULL, (*size > 0)?*size:1, PROT_READ, MAP_PRIVATE, fd, 0);
+    assert(data != MAP_FAILED);
+    close(fd);
+    return data;
+}
+
+// Parse the next unsigned integer of a mapped text file, skipping the separators before it
+static inline uint32_t parseUint(const char** pos, const char* end) {
+    const char* p = *pos;
+    while(p < end && (*p < '0' || *p > '9')) {
+        ++p;
+    }
+    assert(p < end && "Unexpected end of file!");
+    uint32_t value = 0;
+    while(p < end && *p >= '0' && *p <= '9') {
+        value = value*10 + (*p++ - '0');
+    }
+    *pos = p;
+    return value;
+}
+
+// Whether a mapped file is in the binary COO format
+static inline int isBinaryCOO(const char* data, size_t size) {
+    return size >= 4*sizeof(uint32_t) && ((const uint32_t*)data)[0] == COO_BINARY_MAGIC;
+}
+
+#endif
@@ -0,0 +1,73 @@
+/*
+ * Partitioning of the nodes of a graph (or rows of a matrix) across DPUs and tasklets, shared by BFS, PR, SpMV and TC
+ */
+
+#ifndef _PARTITION_H_
+#define _PARTITION_H_
+
+#include <stdint.h>
+#include <stdlib.h>
+
+// Prefix sum of the work of the nodes (or rows) of a CSR structure when it is proportional to their edges (or nonzeros),
+// plus one step of per-node overhead
+static inline uint64_t* degreeWorkPrefix(const uint32_t* nodePtrs, uint32_t numNodes) {
+    uint64_t* workPrefix = (uint64_t*) malloc((numNodes + 1)*sizeof(uint64_t));
+    workPrefix[0] = 0;
+    for(uint32_t u = 0; u < numNodes; ++u) {
+        workPrefix[u + 1] = workPrefix[u] + 1 + (nodePtrs[u + 1] - nodePtrs[u]);
+    }
+    return workPrefix;
+}
+
+// Split nodes [start, end) into numParts contiguous ranges of about equal work, with range sizes a multiple of alignment
+// (except the last), writing the first node of each range to bounds[0..numParts-1] and end to bounds[numParts]
+static inline void partitionByWork(const uint64_t* workPrefix, uint32_t start, uint32_t end, uint32_t numParts, uint32_t alignment, uint32_t* bounds) {
+    uint64_t base = workPrefix[start];
+    uint64_t total = workPrefix[end] - base;
+    bounds[0] = start;
+    for(uint32_t k = 1; k < numParts; ++k) {
+        uint64_t target = base + (total/numParts)*k + (total%numParts)*k/numParts;
+        // Find the first node boundary at or past the target, then step back if that is closer
+        uint32_t lo = bounds[k - 1], hi = end;
+        while(lo < hi) {
+            uint32_t mid = lo + (hi - lo)/2;
+            if(workPrefix[mid] < target) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        if(lo > bounds[k - 1] && target - workPrefix[lo - 1] < workPrefix[lo] - target) {
+            --lo;
+        }
+        lo = start + ((lo - start + alignment/2)/alignment)*alignment;
+        bounds[k] = (lo < bounds[k - 1])?bounds[k - 1]:(lo > end)?end:lo;
+    }
+    bounds[numParts] = end;
+}
+
+// Split nodes [start, end) into numParts ranges with the same number of nodes, rounded up to a multiple of alignment
+static inline void partitionEvenly(uint32_t start, uint32_t end, uint32_t numParts, uint32_t alignment, uint32_t* bounds) {
+    uint32_t numNodes = end - start;
+    uint32_t numNodesPerPart = (numNodes == 0)?0:((numNodes - 1)/numParts + 1);
+    numNodesPerPart = ((numNodesPerPart + alignment - 1)/alignment)*alignment;
+    for(uint32_t k = 0; k <= numParts; ++k) {
+        uint64_t bound = start + (uint64_t)k*numNodesPerPart;
+        bounds[k] = (bound > end)?end:(uint32_t)bound;
+    }
+}
+
+// 2D partitioning into a grid of numRowParts x numColParts blocks: rows [0, numRows) are split as partitionByWork does
+// (evenly if workPrefix is NULL) and columns [0, numCols) evenly. Block k covers rows [rowBounds[k/numColParts],
+// rowBounds[k/numColParts + 1]) and columns [colBounds[k%numColParts], colBounds[k%numColParts + 1])
+static inline void partition2D(const uint64_t* workPrefix, uint32_t numRows, uint32_t numCols, uint32_t numRowParts, uint32_t numColParts,
+        uint32_t rowAlignment, uint32_t colAlignment, uint32_t* rowBounds, uint32_t* colBounds) {
+    if(workPrefix != NULL) {
+        partitionByWork(workPrefix, 0, numRows, numRowParts, rowAlignment, rowBounds);
+    } else {
+        partitionEvenly(0, numRows, numRowParts, rowAlignment, rowBounds);
+    }
+    partitionEvenly(0, numCols, numColParts, colAlignment, colBounds);
+}
+
+#endif
@@ -0,0 +1,65 @@
+/*
+ * Parallel transfers of per-DPU data, shared by BFS, PR, SpMV and TC. A parallel transfer moves the same number of bytes
+ * to or from the same MRAM heap offset of every DPU, so the benchmarks lay out MRAM at the same offsets on all DPUs
+ * (sized for the largest partition) and send each array to all DPUs with one transfer instead of one copy per DPU.
+ */
+
+#ifndef _STAGING_H_
+#define _STAGING_H_
+
+#include <dpu.h>
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "common.h"
+
+// Send every DPU d the sizes[d] bytes at slices[d] (NULL for none) at MRAM heap offset mramIdx, with one parallel transfer
+// of the largest size rounded up to 8B, and return that size. The transfer reads as many bytes of every slice, so slices
+// ending closer than that to arrayEnd, the end of the host array they are cut from, are first copied to padded buffers
+// (all shorter slices if arrayEnd is NULL, for slices in separate buffers).
+static inline uint64_t pushSlicesToDPUs(struct dpu_set_t dpuSet, uint32_t numDPUs, uint32_t mramIdx, uint8_t** slices, const uint64_t* sizes, const uint8_t* arrayEnd) {
+    uint64_t maxSize = 0;
+    for(uint32_t d = 0; d < numDPUs; ++d) {
+        maxSize = (slices[d] != NULL && sizes[d] > maxSize)?sizes[d]:maxSize;
+    }
+    maxSize = ROUND_UP_TO_MULTIPLE_OF_8(maxSize);
+    if(maxSize == 0) {
+        return 0;
+    }
+    uint8_t* zeros = (uint8_t*) calloc(maxSize, 1);
+    uint8_t** padded = (uint8_t**) calloc(numDPUs, sizeof(uint8_t*));
+    struct dpu_set_t dpu;
+    uint32_t d;
+    DPU_FOREACH (dpuSet, dpu, d) {
+        uint8_t* src = slices[d];
+        if(src == NULL) {
+            src = zeros;
+        } else if((arrayEnd == NULL)?(sizes[d] < maxSize):(src + maxSize > arrayEnd)) {
+            padded[d] = (uint8_t*) calloc(maxSize, 1);
+            memcpy(padded[d], slices[d], sizes[d]);
+            src = padded[d];
+        }
+        DPU_ASSERT(dpu_prepare_xfer(dpu, src));
+    }
+    DPU_ASSERT(dpu_push_xfer(dpuSet, DPU_XFER_TO_DPU, DPU_MRAM_HEAP_POINTER_NAME, mramIdx, maxSize, DPU_XFER_DEFAULT));
+    for(d = 0; d < numDPUs; ++d) {
+        free(padded[d]);
+    }
+    free(padded);
+    free(zeros);
+    return maxSize;
+}
+
+// Read size bytes (a multiple of 8) at MRAM heap offset mramIdx of every DPU d into buffer + d*size with one parallel transfer
+static inline void pullFromDPUs(struct dpu_set_t dpuSet, uint32_t mramIdx, uint8_t* buffer, uint64_t size) {
+    struct dpu_set_t dpu;
+    uint32_t d;
+    DPU_FOREACH (dpuSet, dpu, d) {
+        DPU_ASSERT(dpu_prepare_xfer(dpu, buffer + (uint64_t)d*size));
+    }
+    DPU_ASSERT(dpu_push_xfer(dpuSet, DPU_XFER_FROM_DPU, DPU_MRAM_HEAP_POINTER_NAME, mramIdx, size, DPU_XFER_DEFAULT));
+}
+
+#endif